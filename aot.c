@@ -0,0 +1,1005 @@
+/*
+ * This file is part of MiniJVM (https://github.com/muhammad23012009/minijvm)
+ * Copyright (c) 2025 Muhammad  <thevancedgamer@mentallysanemainliners.org>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <string.h>
+#include <dlfcn.h>
+#include <unistd.h>
+#include <sys/wait.h>
+
+#include "aot.h"
+#include "array.h"
+#include "bytecode.h"
+#include "hash.h"
+#include "hashtable.h"
+#include "object.h"
+#include "builtins/builtins.h"
+
+/* Bumped whenever the tables below or the shape of the generated code change */
+#define AOT_VERSION 1
+
+/* The VM's side of the generated code. Every call site resolves what it
+ * needs once and keeps it in a static of its own.
+ */
+typedef struct AotRuntime {
+    /* String and class name constants, ints and longs are inlined */
+    Variant (*ldc)(Method *method, uint16_t index);
+    /* Initializes the field's class first, like getstatic and putstatic */
+    Variant *(*static_field)(Method *method, uint16_t index);
+    Symbol *(*field_name)(Method *method, uint16_t index);
+    Variant *(*field)(Object *object, Symbol *name);
+    /* The target of invokevirtual, invokespecial or invokestatic */
+    Method *(*resolve)(Method *method, uint16_t index, bool initialize);
+    Variant (*call)(Method *method, Variant *args, bool has_this);
+    Variant (*invoke_interface)(Method *method, uint16_t index, Variant *args);
+    Variant (*invoke_dynamic)(Method *method, uint16_t index, Variant *args, int count);
+    Object *(*new_object)(Method *method, uint16_t index);
+    Array *(*new_array)(Method *method, uint16_t index, int count);
+    Variant (*array_load)(Array *array, int index);
+    void (*array_store)(Array *array, int index, Variant value);
+    int (*array_length)(Array *array);
+} AotRuntime;
+
+typedef struct AotMethod {
+    const char *name;
+    const char *descriptor;
+    compiled_method function;
+} AotMethod;
+
+typedef struct AotClass {
+    const char *name;
+    /* class_hash of the class the code was translated from */
+    uint32_t hash;
+    uint32_t methods_count;
+    const AotMethod *methods;
+} AotClass;
+
+/* The only symbol the library exports. The sizes are taken by the library's
+ * own compiler, so a library whose declarations don't match is caught.
+ */
+typedef struct AotLibrary {
+    uint32_t version;
+    uint32_t variant_size;
+    uint32_t runtime_size;
+    uint32_t classes_count;
+    const AotClass *classes;
+    void (*link)(const AotRuntime *runtime);
+} AotLibrary;
+
+/* Starts every generated file. It declares the types above again, since
+ * the library is built without the VM's headers.
+ */
+static const char aot_prelude[] =
+    "#include <stdbool.h>\n"
+    "#include <stddef.h>\n"
+    "#include <stdint.h>\n"
+    "\n"
+    "typedef struct Method Method;\n"
+    "typedef struct Object Object;\n"
+    "typedef struct Array Array;\n"
+    "typedef struct Symbol Symbol;\n"
+    "\n"
+    "typedef enum {\n"
+    "    VARIANT_TYPE_NONE,\n"
+    "    VARIANT_TYPE_OBJECT,\n"
+    "    VARIANT_TYPE_REF,\n"
+    "    VARIANT_TYPE_INT,\n"
+    "    VARIANT_TYPE_LONG,\n"
+    "} VariantType;\n"
+    "\n"
+    "typedef struct Variant {\n"
+    "    VariantType type;\n"
+    "    union {\n"
+    "        Object *object;\n"
+    "        void *ref;\n"
+    "        int int_val;\n"
+    "        int64_t long_val;\n"
+    "    } data;\n"
+    "} Variant;\n"
+    "\n"
+    "typedef Variant (*compiled_method)(Method *method, Variant *locals);\n"
+    "\n"
+    "typedef struct AotRuntime {\n"
+    "    Variant (*ldc)(Method *method, uint16_t index);\n"
+    "    Variant *(*static_field)(Method *method, uint16_t index);\n"
+    "    Symbol *(*field_name)(Method *method, uint16_t index);\n"
+    "    Variant *(*field)(Object *object, Symbol *name);\n"
+    "    Method *(*resolve)(Method *method, uint16_t index, bool initialize);\n"
+    "    Variant (*call)(Method *method, Variant *args, bool has_this);\n"
+    "    Variant (*invoke_interface)(Method *method, uint16_t index, Variant *args);\n"
+    "    Variant (*invoke_dynamic)(Method *method, uint16_t index, Variant *args, int count);\n"
+    "    Object *(*new_object)(Method *method, uint16_t index);\n"
+    "    Array *(*new_array)(Method *method, uint16_t index, int count);\n"
+    "    Variant (*array_load)(Array *array, int index);\n"
+    "    void (*array_store)(Array *array, int index, Variant value);\n"
+    "    int (*array_length)(Array *array);\n"
+    "} AotRuntime;\n"
+    "\n"
+    "typedef struct AotMethod {\n"
+    "    const char *name;\n"
+    "    const char *descriptor;\n"
+    "    compiled_method function;\n"
+    "} AotMethod;\n"
+    "\n"
+    "typedef struct AotClass {\n"
+    "    const char *name;\n"
+    "    uint32_t hash;\n"
+    "    uint32_t methods_count;\n"
+    "    const AotMethod *methods;\n"
+    "} AotClass;\n"
+    "\n"
+    "typedef struct AotLibrary {\n"
+    "    uint32_t version;\n"
+    "    uint32_t variant_size;\n"
+    "    uint32_t runtime_size;\n"
+    "    uint32_t classes_count;\n"
+    "    const AotClass *classes;\n"
+    "    void (*link)(const AotRuntime *runtime);\n"
+    "} AotLibrary;\n"
+    "\n"
+    "#define NONE        ((Variant) { .type = VARIANT_TYPE_NONE })\n"
+    "#define OBJECT(v)   ((Variant) { .type = VARIANT_TYPE_OBJECT, .data.object = (v) })\n"
+    "#define REF(v)      ((Variant) { .type = VARIANT_TYPE_REF, .data.ref = (v) })\n"
+    "#define INT(v)      ((Variant) { .type = VARIANT_TYPE_INT, .data.int_val = (v) })\n"
+    "#define LONG(v)     ((Variant) { .type = VARIANT_TYPE_LONG, .data.long_val = (v) })\n"
+    "\n"
+    "static const AotRuntime *R;\n"
+    "\n"
+    "static void aot_link(const AotRuntime *runtime)\n"
+    "{\n"
+    "    R = runtime;\n"
+    "}\n";
+
+/* Runtime */
+static Variant runtime_ldc(Method *method, uint16_t index)
+{
+    ConstantPool *pool = method->class->pool;
+
+    if (constant_pool_get_tag(pool, index) == CONSTANT_STRING) {
+        Object *string = constant_pool_resolve_string_object(pool, index, method->class->classes);
+        return (Variant) { .type = VARIANT_TYPE_OBJECT, .data.object = string };
+    }
+
+    return (Variant) { .type = VARIANT_TYPE_REF, .data.ref = constant_pool_resolve_string(pool, index) };
+}
+
+static Variant *runtime_static_field(Method *method, uint16_t index)
+{
+    ConstantPool *pool = method->class->pool;
+    Class *class = classes_get_class_from_index(method->class->classes, pool, index);
+    if (class->static_field_count && !class->static_initialized)
+        class_initialize_static(class);
+
+    char *field_name = constant_pool_resolve_field_name(pool, index);
+    return &class_get_static_field_by_symbol(class, symbol_of(field_name))->value;
+}
+
+static Symbol *runtime_field_name(Method *method, uint16_t index)
+{
+    return symbol_of(constant_pool_resolve_field_name(method->class->pool, index));
+}
+
+static Variant *runtime_field(Object *object, Symbol *name)
+{
+    return &object_get_field(object, name)->value;
+}
+
+static Method *runtime_resolve(Method *method, uint16_t index, bool initialize)
+{
+    ConstantPool *pool = method->class->pool;
+    Class *class = classes_get_class_from_index(method->class->classes, pool, index);
+    if (initialize && class->static_field_count && !class->static_initialized)
+        class_initialize_static(class);
+
+    Method *target = get_method(pool, class, index);
+    if (!target) {
+        fprintf(stderr, "Exception in thread \"main\" java.lang.NoSuchMethodError: %s.%s\n", class->name,
+                constant_pool_resolve_field_name(pool, index));
+        exit(1);
+    }
+
+    return target;
+}
+
+/* The receiver's class decides, as in the interpreter's invokeinterface */
+static Variant runtime_invoke_interface(Method *method, uint16_t index, Variant *args)
+{
+    InterfaceCall *call = interface_call(method->class->pool, index);
+    return method_call(interface_call_target(call, args[0].data.object), args, true);
+}
+
+static Variant runtime_invoke_dynamic(Method *method, uint16_t index, Variant *args, int count)
+{
+    ConstantPool *pool = method->class->pool;
+    ConcatRecipe *recipe = pool->resolved[index];
+    if (!recipe) {
+        recipe = string_concat_link(method->class, index);
+        if (!recipe) {
+            fprintf(stderr, "Unsupported invokedynamic call site in method %s\n", method->name);
+            exit(1);
+        }
+
+        pool->resolved[index] = recipe;
+    }
+
+    Frame *frame = frame_new(count, 0);
+    for (int i = 0; i < count; i++)
+        stack_push(frame->stack, args[i]);
+
+    string_concat_execute(recipe, frame);
+    Variant result = stack_pop(frame->stack);
+
+    frame_free(frame);
+    return result;
+}
+
+static Object *runtime_new_object(Method *method, uint16_t index)
+{
+    return object_new(classes_get_class_from_index(method->class->classes, method->class->pool, index));
+}
+
+static Array *runtime_new_array(Method *method, uint16_t index, int count)
+{
+    Class *class = classes_get_class_from_index(method->class->classes, method->class->pool, index);
+    printf("Creating new array of class %s\n", class->name);
+
+    return array_new(class, count);
+}
+
+static Variant runtime_array_load(Array *array, int index)
+{
+    if (!array_in_bounds(array, index))
+        array_throw_out_of_bounds(array, index);
+
+    return array->value[index];
+}
+
+static void runtime_array_store(Array *array, int index, Variant value)
+{
+    if (!array_in_bounds(array, index))
+        array_throw_out_of_bounds(array, index);
+
+    array_set_value(array, index, value);
+}
+
+static int runtime_array_length(Array *array)
+{
+    return array->count;
+}
+
+static const AotRuntime runtime = {
+    .ldc = runtime_ldc,
+    .static_field = runtime_static_field,
+    .field_name = runtime_field_name,
+    .field = runtime_field,
+    .resolve = runtime_resolve,
+    .call = method_call,
+    .invoke_interface = runtime_invoke_interface,
+    .invoke_dynamic = runtime_invoke_dynamic,
+    .new_object = runtime_new_object,
+    .new_array = runtime_new_array,
+    .array_load = runtime_array_load,
+    .array_store = runtime_array_store,
+    .array_length = runtime_array_length,
+};
+
+/* Covers everything the generated code took from the class: the constant
+ * pool (without its caches) and each method's prepared code.
+ */
+static uint32_t class_hash(Class *class)
+{
+    ConstantPool *pool = class->pool;
+    uint32_t hash = HASH_SEED;
+
+    for (int i = 1; i < pool->count; i++) {
+        hash = hash_update(hash, &pool->tags[i], 1);
+        if (pool->tags[i] == CONSTANT_UTF8) {
+            Symbol *symbol = pool->resolved[i];
+            hash = hash_update(hash, symbol->bytes, symbol->length);
+        } else {
+            /* Indexes and numbers, including the low word of a long */
+            hash = hash_update(hash, &pool->values[i], sizeof(pool->values[i]));
+        }
+    }
+
+    for (int i = 0; i < class->methods_count; i++) {
+        Method *method = &class->methods[i];
+        hash = hash_update(hash, method->name, strlen(method->name) + 1);
+        hash = hash_update(hash, method->descriptors->descriptor, strlen(method->descriptors->descriptor) + 1);
+        if (method->data)
+            hash = hash_update(hash, method->data, method->data_length);
+    }
+
+    return hash;
+}
+
+/* Translation */
+#define INSTRUCTION_START   0x01
+#define BRANCH_TARGET       0x02
+
+typedef struct Translator {
+    FILE *out;
+    Method *method;
+    ConstantPool *pool;
+    uint8_t *code;
+    uint32_t length;
+
+    uint8_t *flags;
+    /* Operand stack depth before each instruction, -1 if it's unreachable */
+    int *depths;
+    uint32_t *work;
+    uint32_t work_count;
+} Translator;
+
+static bool is_branch(uint8_t op)
+{
+    return (op >= OP_IFEQ && op <= OP_GOTO) || op == OP_IFNULL || op == OP_IFNONNULL;
+}
+
+static bool is_return(uint8_t op)
+{
+    return op >= OP_IRETURN && op <= OP_RETURN;
+}
+
+/* Descriptor of the Methodref, InterfaceMethodref or InvokeDynamic at `index` */
+static char *call_descriptor(ConstantPool *pool, uint16_t index)
+{
+    uint16_t name_and_type_index = constant_pool_get_name_and_type_index(pool, index);
+    return constant_pool_resolve_string(pool, constant_pool_second_index(pool, name_and_type_index));
+}
+
+static bool returns_value(char *descriptor)
+{
+    return strrchr(descriptor, ')')[1] != 'V';
+}
+
+/* The operands an instruction takes off the stack and puts back. Returns
+ * false for anything the interpreter can't run either.
+ */
+static bool instruction_effect(Translator *t, uint32_t pc, int *pops, int *pushes)
+{
+    uint8_t op = t->code[pc];
+    uint16_t index = pc + 2 < t->length ? code_u16(&t->code[pc + 1]) : 0;
+    *pops = 0;
+    *pushes = 0;
+
+    switch (op) {
+        case OP_ACONST_NULL:
+        case OP_ICONST_M1 ... OP_LCONST_1:
+        case OP_BIPUSH:
+        case OP_SIPUSH:
+        case OP_ILOAD:
+        case OP_LLOAD:
+        case OP_ALOAD:
+        case OP_ILOAD_0 ... OP_LLOAD_3:
+        case OP_ALOAD_0 ... OP_ALOAD_3:
+        case OP_DUP:
+        case OP_NEW:
+            *pushes = 1;
+            return true;
+        case OP_LDC: {
+            if (t->code[pc + 1] >= t->pool->count)
+                return false;
+
+            uint8_t tag = constant_pool_get_tag(t->pool, t->code[pc + 1]);
+            *pushes = 1;
+            return tag == CONSTANT_INT || tag == CONSTANT_STRING || tag == CONSTANT_UTF8;
+        }
+        case OP_LDC2_W:
+            *pushes = 1;
+            return index < t->pool->count && constant_pool_get_tag(t->pool, index) == CONSTANT_LONG;
+        case OP_AALOAD:
+        case OP_AALOAD_UNCHECKED:
+        case OP_IADD:
+        case OP_LADD:
+            *pops = 2;
+            *pushes = 1;
+            return true;
+        case OP_ISTORE:
+        case OP_LSTORE:
+        case OP_ASTORE:
+        case OP_ISTORE_0 ... OP_LSTORE_3:
+        case OP_ASTORE_0 ... OP_ASTORE_3:
+        case OP_POP:
+        case OP_IFEQ ... OP_IFLE:
+        case OP_IFNULL:
+        case OP_IFNONNULL:
+        case OP_PUTSTATIC:
+            *pops = 1;
+            return true;
+        case OP_AASTORE:
+        case OP_AASTORE_UNCHECKED:
+            *pops = 3;
+            return true;
+        case OP_IF_ICMPEQ ... OP_IF_ACMPNE:
+        case OP_PUTFIELD:
+            *pops = 2;
+            return true;
+        case OP_I2L:
+        case OP_L2I:
+        case OP_ANEWARRAY:
+        case OP_ARRAYLENGTH:
+        case OP_GETFIELD:
+            *pops = 1;
+            *pushes = 1;
+            return true;
+        case OP_IINC:
+        case OP_GOTO:
+        case OP_CHECKCAST:
+        case OP_RETURN:
+            return true;
+        case OP_IRETURN:
+        case OP_LRETURN:
+        case OP_ARETURN:
+            *pops = 1;
+            return true;
+        case OP_GETSTATIC:
+            *pushes = 1;
+            return true;
+        case OP_INVOKEVIRTUAL:
+        case OP_INVOKESPECIAL:
+        case OP_INVOKESTATIC:
+        case OP_INVOKEINTERFACE:
+        case OP_INVOKEDYNAMIC: {
+            if (index >= t->pool->count)
+                return false;
+
+            char *descriptor = call_descriptor(t->pool, index);
+            *pops = get_descriptor_count(descriptor) + (op != OP_INVOKESTATIC && op != OP_INVOKEDYNAMIC);
+            *pushes = returns_value(descriptor);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+static bool translator_flow(Translator *t, int64_t pc, int depth)
+{
+    if (pc < 0 || pc >= t->length || !(t->flags[pc] & INSTRUCTION_START))
+        return false;
+
+    if (t->depths[pc] >= 0)
+        return t->depths[pc] == depth;
+
+    t->depths[pc] = depth;
+    t->work[t->work_count++] = pc;
+    return true;
+}
+
+/* Finds the stack depth at every reachable instruction, which lets each
+ * stack slot become a plain C variable.
+ */
+static bool translator_analyze(Translator *t)
+{
+    for (uint32_t pc = 0; pc < t->length;) {
+        int length = bytecode_instruction_length(t->code, t->length, pc);
+        if (!length)
+            return false;
+
+        t->flags[pc] |= INSTRUCTION_START;
+        pc += length;
+    }
+
+    if (!translator_flow(t, 0, 0))
+        return false;
+
+    while (t->work_count) {
+        uint32_t pc = t->work[--t->work_count];
+        uint8_t op = t->code[pc];
+        int pops, pushes;
+
+        if (!instruction_effect(t, pc, &pops, &pushes) || pops > t->depths[pc])
+            return false;
+
+        int depth = t->depths[pc] - pops + pushes;
+        if (depth > t->method->max_stack)
+            return false;
+
+        if (is_branch(op)) {
+            int64_t target = (int64_t) pc + code_s16(&t->code[pc + 1]);
+            if (!translator_flow(t, target, depth))
+                return false;
+
+            t->flags[target] |= BRANCH_TARGET;
+        }
+
+        if (op != OP_GOTO && !is_return(op) && !translator_flow(t, pc + bytecode_instruction_length(t->code, t->length, pc), depth))
+            return false;
+    }
+
+    return true;
+}
+
+static void emit(Translator *t, const char *format, ...)
+{
+    va_list args;
+    va_start(args, format);
+    vfprintf(t->out, format, args);
+    va_end(args);
+}
+
+/* As a C string literal, escaping everything outside of printable ASCII */
+static void emit_string(FILE *out, const char *string)
+{
+    fputc('"', out);
+    for (const uint8_t *c = (const uint8_t*) string; *c; c++) {
+        if (*c >= 0x20 && *c < 0x7F && *c != '"' && *c != '\\' && *c != '?')
+            fputc(*c, out);
+        else
+            fprintf(out, "\\%03o", *c);
+    }
+    fputc('"', out);
+}
+
+static void emit_call(Translator *t, uint32_t pc, int depth)
+{
+    uint8_t op = t->code[pc];
+    uint16_t index = code_u16(&t->code[pc + 1]);
+    char *descriptor = call_descriptor(t->pool, index);
+    bool has_this = op != OP_INVOKESTATIC && op != OP_INVOKEDYNAMIC;
+    int count = get_descriptor_count(descriptor) + has_this;
+    int base = depth - count;
+    char result[32] = "";
+
+    if (returns_value(descriptor))
+        snprintf(result, sizeof(result), "s[%d] = ", base);
+
+    switch (op) {
+        case OP_INVOKEINTERFACE:
+            emit(t, "    %sR->invoke_interface(method, %u, &s[%d]);\n", result, index, base);
+            break;
+        case OP_INVOKEDYNAMIC:
+            emit(t, "    %sR->invoke_dynamic(method, %u, &s[%d], %d);\n", result, index, base, count);
+            break;
+        default:
+            emit(t, "    {\n"
+                    "        static Method *site;\n"
+                    "        if (!site)\n"
+                    "            site = R->resolve(method, %u, %s);\n"
+                    "        %sR->call(site, &s[%d], %s);\n"
+                    "    }\n",
+                 index, op == OP_INVOKESTATIC ? "true" : "false", result, base, has_this ? "true" : "false");
+            break;
+    }
+}
+
+static void emit_instruction(Translator *t, uint32_t pc)
+{
+    uint8_t *code = &t->code[pc];
+    uint8_t op = code[0];
+    int d = t->depths[pc];
+
+    if (t->flags[pc] & BRANCH_TARGET)
+        emit(t, "L%u:\n", pc);
+
+    switch (op) {
+        case OP_ACONST_NULL:
+            emit(t, "    s[%d] = OBJECT(NULL);\n", d);
+            break;
+        case OP_ICONST_M1 ... OP_ICONST_5:
+            emit(t, "    s[%d] = INT(%d);\n", d, op - OP_ICONST_0);
+            break;
+        case OP_LCONST_0:
+        case OP_LCONST_1:
+            emit(t, "    s[%d] = LONG(%d);\n", d, op - OP_LCONST_0);
+            break;
+        case OP_BIPUSH:
+            emit(t, "    s[%d] = INT(%d);\n", d, (int8_t) code[1]);
+            break;
+        case OP_SIPUSH:
+            emit(t, "    s[%d] = INT(%d);\n", d, code_s16(&code[1]));
+            break;
+        case OP_LDC:
+            if (constant_pool_get_tag(t->pool, code[1]) == CONSTANT_INT) {
+                int32_t value = constant_pool_resolve_int(t->pool, code[1]);
+                if (value == INT32_MIN)
+                    emit(t, "    s[%d] = INT(INT32_MIN);\n", d);
+                else
+                    emit(t, "    s[%d] = INT(%d);\n", d, value);
+            } else {
+                emit(t, "    {\n"
+                        "        static Variant constant;\n"
+                        "        if (constant.type == VARIANT_TYPE_NONE)\n"
+                        "            constant = R->ldc(method, %u);\n"
+                        "        s[%d] = constant;\n"
+                        "    }\n", code[1], d);
+            }
+            break;
+        case OP_LDC2_W: {
+            int64_t value = constant_pool_resolve_long(t->pool, code_u16(&code[1]));
+            if (value == INT64_MIN)
+                emit(t, "    s[%d] = LONG(INT64_MIN);\n", d);
+            else
+                emit(t, "    s[%d] = LONG(INT64_C(%lld));\n", d, (long long) value);
+            break;
+        }
+        case OP_ILOAD:
+        case OP_LLOAD:
+        case OP_ALOAD:
+            emit(t, "    s[%d] = l[%u];\n", d, code[1]);
+            break;
+        case OP_ILOAD_0 ... OP_ILOAD_3:
+            emit(t, "    s[%d] = l[%d];\n", d, op - OP_ILOAD_0);
+            break;
+        case OP_LLOAD_0 ... OP_LLOAD_3:
+            emit(t, "    s[%d] = l[%d];\n", d, op - OP_LLOAD_0);
+            break;
+        case OP_ALOAD_0 ... OP_ALOAD_3:
+            emit(t, "    s[%d] = l[%d];\n", d, op - OP_ALOAD_0);
+            break;
+        case OP_AALOAD:
+        case OP_AALOAD_UNCHECKED:
+            emit(t, "    s[%d] = R->array_load(s[%d].data.ref, s[%d].data.int_val);\n", d - 2, d - 2, d - 1);
+            break;
+        case OP_ISTORE:
+        case OP_LSTORE:
+        case OP_ASTORE:
+            emit(t, "    l[%u] = s[%d];\n", code[1], d - 1);
+            break;
+        case OP_ISTORE_0 ... OP_ISTORE_3:
+            emit(t, "    l[%d] = s[%d];\n", op - OP_ISTORE_0, d - 1);
+            break;
+        case OP_LSTORE_0 ... OP_LSTORE_3:
+            emit(t, "    l[%d] = s[%d];\n", op - OP_LSTORE_0, d - 1);
+            break;
+        case OP_ASTORE_0 ... OP_ASTORE_3:
+            emit(t, "    l[%d] = s[%d];\n", op - OP_ASTORE_0, d - 1);
+            break;
+        case OP_AASTORE:
+        case OP_AASTORE_UNCHECKED:
+            emit(t, "    R->array_store(s[%d].data.ref, s[%d].data.int_val, s[%d]);\n", d - 3, d - 2, d - 1);
+            break;
+        case OP_POP:
+        case OP_CHECKCAST:
+            break;
+        case OP_DUP:
+            emit(t, "    s[%d] = s[%d];\n", d, d - 1);
+            break;
+        /* Java arithmetic wraps around, which C only promises for unsigned types */
+        case OP_IADD:
+            emit(t, "    s[%d] = INT((int32_t) ((uint32_t) s[%d].data.int_val + (uint32_t) s[%d].data.int_val));\n",
+                 d - 2, d - 2, d - 1);
+            break;
+        case OP_LADD:
+            emit(t, "    s[%d] = LONG((int64_t) ((uint64_t) s[%d].data.long_val + (uint64_t) s[%d].data.long_val));\n",
+                 d - 2, d - 2, d - 1);
+            break;
+        case OP_IINC:
+            emit(t, "    l[%u].data.int_val = (int32_t) ((uint32_t) l[%u].data.int_val + %d);\n",
+                 code[1], code[1], (int8_t) code[2]);
+            break;
+        case OP_I2L:
+            emit(t, "    s[%d] = LONG(s[%d].data.int_val);\n", d - 1, d - 1);
+            break;
+        case OP_L2I:
+            emit(t, "    s[%d] = INT((int32_t) s[%d].data.long_val);\n", d - 1, d - 1);
+            break;
+        case OP_IFEQ ... OP_IFLE: {
+            static const char *conditions[] = { "==", "!=", "<", ">=", ">", "<=" };
+            emit(t, "    if (s[%d].data.int_val %s 0)\n        goto L%u;\n",
+                 d - 1, conditions[op - OP_IFEQ], pc + code_s16(&code[1]));
+            break;
+        }
+        case OP_IF_ICMPEQ ... OP_IF_ICMPLE: {
+            static const char *conditions[] = { "==", "!=", "<", ">=", ">", "<=" };
+            emit(t, "    if (s[%d].data.int_val %s s[%d].data.int_val)\n        goto L%u;\n",
+                 d - 2, conditions[op - OP_IF_ICMPEQ], d - 1, pc + code_s16(&code[1]));
+            break;
+        }
+        case OP_IF_ACMPEQ:
+        case OP_IF_ACMPNE:
+            emit(t, "    if (s[%d].data.ref %s s[%d].data.ref)\n        goto L%u;\n",
+                 d - 2, op == OP_IF_ACMPEQ ? "==" : "!=", d - 1, pc + code_s16(&code[1]));
+            break;
+        case OP_IFNULL:
+        case OP_IFNONNULL:
+            emit(t, "    if (s[%d].data.ref %s NULL)\n        goto L%u;\n",
+                 d - 1, op == OP_IFNULL ? "==" : "!=", pc + code_s16(&code[1]));
+            break;
+        case OP_GOTO:
+            emit(t, "    goto L%u;\n", pc + code_s16(&code[1]));
+            break;
+        case OP_IRETURN:
+        case OP_LRETURN:
+        case OP_ARETURN:
+            emit(t, "    return s[%d];\n", d - 1);
+            break;
+        case OP_RETURN:
+            emit(t, "    return NONE;\n");
+            break;
+        case OP_GETSTATIC:
+        case OP_PUTSTATIC:
+            emit(t, "    {\n"
+                    "        static Variant *field;\n"
+                    "        if (!field)\n"
+                    "            field = R->static_field(method, %u);\n", code_u16(&code[1]));
+            if (op == OP_GETSTATIC)
+                emit(t, "        s[%d] = *field;\n    }\n", d);
+            else
+                emit(t, "        *field = s[%d];\n    }\n", d - 1);
+            break;
+        case OP_GETFIELD:
+        case OP_PUTFIELD:
+            emit(t, "    {\n"
+                    "        static Symbol *name;\n"
+                    "        if (!name)\n"
+                    "            name = R->field_name(method, %u);\n", code_u16(&code[1]));
+            if (op == OP_GETFIELD)
+                emit(t, "        s[%d] = *R->field(s[%d].data.object, name);\n    }\n", d - 1, d - 1);
+            else
+                emit(t, "        *R->field(s[%d].data.object, name) = s[%d];\n    }\n", d - 2, d - 1);
+            break;
+        case OP_INVOKEVIRTUAL:
+        case OP_INVOKESPECIAL:
+        case OP_INVOKESTATIC:
+        case OP_INVOKEINTERFACE:
+        case OP_INVOKEDYNAMIC:
+            emit_call(t, pc, d);
+            break;
+        case OP_NEW:
+            emit(t, "    s[%d] = OBJECT(R->new_object(method, %u));\n", d, code_u16(&code[1]));
+            break;
+        case OP_ANEWARRAY:
+            emit(t, "    s[%d] = REF(R->new_array(method, %u, s[%d].data.int_val));\n", d - 1, code_u16(&code[1]), d - 1);
+            break;
+        case OP_ARRAYLENGTH:
+            emit(t, "    s[%d] = INT(R->array_length(s[%d].data.ref));\n", d - 1, d - 1);
+            break;
+    }
+}
+
+/* Writes the method as `m<class>_<method>`. Returns false, writing
+ * nothing, if it uses anything the translator doesn't know.
+ */
+static bool translate_method(FILE *out, Method *method, uint32_t class_index, int method_index)
+{
+    Translator t = {
+        .out = out,
+        .method = method,
+        .pool = method->class->pool,
+        .code = method->data,
+        .length = method->data_length,
+        .flags = calloc(method->data_length, sizeof(uint8_t)),
+        .depths = malloc(sizeof(int) * method->data_length),
+        .work = malloc(sizeof(uint32_t) * method->data_length),
+    };
+
+    for (uint32_t pc = 0; pc < t.length; pc++)
+        t.depths[pc] = -1;
+
+    bool translated = translator_analyze(&t);
+    if (translated) {
+        fprintf(out, "\n/* %s.%s%s */\n", method->class->name, method->name, method->descriptors->descriptor);
+        fprintf(out, "static Variant m%u_%d(Method *method, Variant *locals)\n{\n", class_index, method_index);
+        fprintf(out, "    Variant l[%d], s[%d];\n", method->max_local + 1, method->max_stack + 1);
+        fprintf(out, "    for (int i = 0; i < %d; i++)\n        l[i] = locals[i];\n\n", method->max_local);
+
+        for (uint32_t pc = 0; pc < t.length; pc++) {
+            if (t.depths[pc] >= 0)
+                emit_instruction(&t, pc);
+        }
+
+        fprintf(out, "}\n");
+    }
+
+    free(t.flags);
+    free(t.depths);
+    free(t.work);
+    return translated;
+}
+
+static bool build_library(const char *source, const char *library)
+{
+    const char *compiler = getenv("CC");
+    if (!compiler || !*compiler)
+        compiler = "cc";
+
+    /* Anything still buffered would be written twice otherwise */
+    fflush(stdout);
+    pid_t pid = fork();
+    if (pid == 0) {
+        execlp(compiler, compiler, "-O2", "-fPIC", "-shared", "-o", library, source, (char*) NULL);
+        _exit(127);
+    }
+
+    int status;
+    if (pid < 0 || waitpid(pid, &status, 0) < 0 || !WIFEXITED(status) || WEXITSTATUS(status)) {
+        fprintf(stderr, "miniJVM: %s failed to build %s\n", compiler, library);
+        return false;
+    }
+
+    return true;
+}
+
+bool aot_compile(Classes *classes, const char *path)
+{
+    char *source = malloc(strlen(path) + 3);
+    sprintf(source, "%s.c", path);
+
+    FILE *out = fopen(source, "w");
+    if (!out) {
+        fprintf(stderr, "miniJVM: cannot write %s\n", source);
+        free(source);
+        return false;
+    }
+
+    fputs(aot_prelude, out);
+
+    uint32_t methods_count = 0, compiled_count = 0, classes_count = 0;
+    uint32_t *compiled = calloc(classes->count, sizeof(uint32_t));
+
+    for (uint32_t i = 0; i < classes->count; i++) {
+        Class *class = classes->classes[i];
+        if (class->built_in)
+            continue;
+
+        bool translated[class->methods_count + 1];
+        for (int j = 0; j < class->methods_count; j++) {
+            Method *method = &class->methods[j];
+            translated[j] = false;
+            if (!method->data || !method->data_length)
+                continue;
+
+            methods_count++;
+            if ((translated[j] = translate_method(out, method, i, j)))
+                compiled[i]++;
+        }
+
+        if (!compiled[i])
+            continue;
+
+        fprintf(out, "\nstatic const AotMethod c%u_methods[] = {\n", i);
+        for (int j = 0; j < class->methods_count; j++) {
+            if (!translated[j])
+                continue;
+
+            fprintf(out, "    { ");
+            emit_string(out, class->methods[j].name);
+            fprintf(out, ", ");
+            emit_string(out, class->methods[j].descriptors->descriptor);
+            fprintf(out, ", m%u_%d },\n", i, j);
+        }
+        fprintf(out, "};\n");
+
+        compiled_count += compiled[i];
+        classes_count++;
+    }
+
+    /* The last entry keeps the array from being empty */
+    fprintf(out, "\nstatic const AotClass classes[] = {\n");
+    for (uint32_t i = 0; i < classes->count; i++) {
+        if (!compiled[i])
+            continue;
+
+        fprintf(out, "    { ");
+        emit_string(out, classes->classes[i]->name);
+        fprintf(out, ", 0x%08x, %u, c%u_methods },\n", class_hash(classes->classes[i]), compiled[i], i);
+    }
+    fprintf(out, "    { NULL, 0, 0, NULL },\n};\n");
+
+    fprintf(out, "\nconst AotLibrary aot_library = {\n"
+                 "    %d, sizeof(Variant), sizeof(AotRuntime), %u, classes, aot_link,\n"
+                 "};\n", AOT_VERSION, classes_count);
+
+    bool written = !ferror(out);
+    written &= !fclose(out);
+    free(compiled);
+
+    if (!written) {
+        fprintf(stderr, "miniJVM: cannot write %s\n", source);
+        free(source);
+        return false;
+    }
+
+    bool built = build_library(source, path);
+    if (built)
+        printf("miniJVM: compiled %u of %u methods in %u classes into %s\n", compiled_count, methods_count,
+               classes_count, path);
+
+    free(source);
+    return built;
+}
+
+/* Loading */
+static struct {
+    void *handle;
+    const AotLibrary *library;
+
+    /* Index of the library's classes by name, holding AotClass pointers */
+    HashTable index;
+} aot;
+
+static bool aot_class_match(const void *entry, const void *key)
+{
+    return !strcmp((*(const AotClass* const*) entry)->name, key);
+}
+
+bool aot_load(const char *path)
+{
+    /* Without a slash dlopen searches the library path instead */
+    char *relative = malloc(strlen(path) + 3);
+    sprintf(relative, strchr(path, '/') ? "%s" : "./%s", path);
+
+    void *handle = dlopen(relative, RTLD_NOW | RTLD_LOCAL);
+    free(relative);
+    if (!handle) {
+        fprintf(stderr, "miniJVM: cannot open compiled library %s: %s\n", path, dlerror());
+        return false;
+    }
+
+    const AotLibrary *library = dlsym(handle, "aot_library");
+    if (!library || library->version != AOT_VERSION || library->variant_size != sizeof(Variant) ||
+        library->runtime_size != sizeof(AotRuntime)) {
+        fprintf(stderr, "miniJVM: ignoring compiled library %s: it was built for another VM\n", path);
+        dlclose(handle);
+        return false;
+    }
+
+    aot.handle = handle;
+    aot.library = library;
+    hash_table_init(&aot.index, sizeof(AotClass*), library->classes_count);
+
+    for (uint32_t i = 0; i < library->classes_count; i++) {
+        const AotClass *class = &library->classes[i];
+        const AotClass **entry = hash_table_free_entry(&aot.index, sizeof(AotClass*), hash_bytes(class->name, strlen(class->name)));
+        *entry = class;
+        aot.index.count++;
+    }
+
+    library->link(&runtime);
+    printf("miniJVM: loaded %u compiled classes from %s\n", library->classes_count, path);
+    return true;
+}
+
+void aot_unload(void)
+{
+    if (aot.handle)
+        dlclose(aot.handle);
+
+    hash_table_free(&aot.index);
+    memset(&aot, 0, sizeof(aot));
+}
+
+void aot_bind(Class *class)
+{
+    if (!aot.handle || class->built_in)
+        return;
+
+    const AotClass **slot = hash_table_find(&aot.index, sizeof(AotClass*), hash_bytes(class->name, strlen(class->name)),
+                                            aot_class_match, class->name);
+    if (!slot)
+        return;
+
+    const AotClass *compiled = *slot;
+
+    if (compiled->hash != class_hash(class)) {
+        printf("Class %s changed since it was compiled, interpreting it.\n", class->name);
+        return;
+    }
+
+    for (uint32_t i = 0; i < compiled->methods_count; i++) {
+        const AotMethod *entry = &compiled->methods[i];
+        Method *method = class_get_method(class, (char*) entry->name, (char*) entry->descriptor);
+        if (method)
+            method->compiled = entry->function;
+    }
+
+    printf("Class %s bound to %u compiled methods.\n", class->name, compiled->methods_count);
+}
\ No newline at end of file
@@ -0,0 +1,50 @@
+/*
+ * This file is part of MiniJVM (https://github.com/muhammad23012009/minijvm)
+ * Copyright (c) 2025 Muhammad  <thevancedgamer@mentallysanemainliners.org>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef AOT_H
+#define AOT_H
+
+/* Ahead-of-time compilation. A compile run translates the bytecode of every
+ * class it loaded into C, one function per method, and builds that into a
+ * shared library with the system compiler. The generated code keeps the
+ * operand stack and locals in C variables and calls back into the VM
+ * through an AotRuntime for everything that needs classes, fields or
+ * methods.
+ *
+ * Later runs open the library, and class_read binds its functions to the
+ * methods of each class it loads. A class whose bytes changed since, or a
+ * method the translator couldn't handle, is interpreted as usual.
+ */
+
+#include <stdbool.h>
+#include "method.h"
+
+/* Writes the C source to <path>.c and builds it into <path>. The compiler
+ * is $CC, or cc if that isn't set.
+ */
+extern bool aot_compile(Classes *classes, const char *path);
+
+/* Returns false, leaving nothing bound, if the library can't be used with
+ * this build
+ */
+extern bool aot_load(const char *path);
+extern void aot_unload(void);
+
+/* Binds every compiled method of the class, if the library has it */
+extern void aot_bind(Class *class);
+
+#endif
\ No newline at end of file
@@ -0,0 +1,71 @@
+/*
+ * This file is part of MiniJVM (https://github.com/muhammad23012009/minijvm)
+ * Copyright (c) 2025 Muhammad  <thevancedgamer@mentallysanemainliners.org>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "arena.h"
+
+/* Big enough for a small class in one go */
+#define ARENA_CHUNK_SIZE    16384
+#define ARENA_ALIGN         _Alignof(max_align_t)
+
+struct ArenaChunk {
+    ArenaChunk *next;
+    size_t size;
+    size_t used;
+    _Alignas(max_align_t) unsigned char data[];
+};
+
+void *arena_alloc(Arena *arena, size_t size)
+{
+    size = (size + ARENA_ALIGN - 1) & ~(ARENA_ALIGN - 1);
+
+    ArenaChunk *chunk = arena->chunk;
+    if (!chunk || chunk->size - chunk->used < size) {
+        /* Anything bigger than a chunk gets one of its own */
+        size_t chunk_size = size > ARENA_CHUNK_SIZE ? size : ARENA_CHUNK_SIZE;
+        chunk = calloc(1, sizeof(ArenaChunk) + chunk_size);
+        chunk->size = chunk_size;
+        chunk->used = 0;
+
+        /* Keep allocating from the emptier chunk */
+        if (arena->chunk && size > ARENA_CHUNK_SIZE) {
+            chunk->next = arena->chunk->next;
+            arena->chunk->next = chunk;
+        } else {
+            chunk->next = arena->chunk;
+            arena->chunk = chunk;
+        }
+    }
+
+    void *memory = chunk->data + chunk->used;
+    chunk->used += size;
+    return memory;
+}
+
+void arena_free(Arena *arena)
+{
+    ArenaChunk *chunk = arena->chunk;
+    while (chunk) {
+        ArenaChunk *next = chunk->next;
+        free(chunk);
+        chunk = next;
+    }
+
+    arena->chunk = NULL;
+}
\ No newline at end of file
@@ -0,0 +1,40 @@
+/*
+ * This file is part of MiniJVM (https://github.com/muhammad23012009/minijvm)
+ * Copyright (c) 2025 Muhammad  <thevancedgamer@mentallysanemainliners.org>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef ARENA_H
+#define ARENA_H
+
+/* A bump allocator for everything a class owns. Memory comes from chunks
+ * that are only ever released together, by arena_free, so the many small
+ * pieces of a parsed class cost a pointer increment each and go away in
+ * one step when the class does.
+ */
+
+#include <stddef.h>
+
+typedef struct ArenaChunk ArenaChunk;
+
+typedef struct Arena {
+    /* The chunk being allocated from, earlier chunks are linked behind it */
+    ArenaChunk *chunk;
+} Arena;
+
+/* Returns `size` zeroed bytes, aligned for any type */
+extern void *arena_alloc(Arena *arena, size_t size);
+extern void arena_free(Arena *arena);
+
+#endif
\ No newline at end of file
@@ -17,4 +17,24 @@ Array *array_new(Class *c, int count)
 void array_set_value(Array *array, int index, Variant value)
 {
     array->value[index] = value;
+}
+
+/* New elements are zeroed, like those of a new array */
+void array_resize(Array *array, int count)
+{
+    array->value = realloc(array->value, sizeof(Variant) * count);
+    if (count > array->count)
+        memset(array->value + array->count, 0, sizeof(Variant) * (count - array->count));
+
+    array->count = count;
+}
+
+/* TODO: Throw a real java/lang/ArrayIndexOutOfBoundsException once exceptions
+ * are implemented. Until then, this terminates the VM like an uncaught one would.
+ */
+void array_throw_out_of_bounds(Array *array, int index)
+{
+    fprintf(stderr, "Exception in thread \"main\" java.lang.ArrayIndexOutOfBoundsException: "
+                    "Index %d out of bounds for length %d\n", index, array->count);
+    exit(1);
 }
\ No newline at end of file
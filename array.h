@@ -12,7 +12,15 @@ typedef struct Array {
     Variant *value;
 } Array;
 
+/* A single unsigned compare covers both negative and too large indices */
+static inline bool array_in_bounds(Array *array, int index)
+{
+    return (uint32_t) index < (uint32_t) array->count;
+}
+
 extern Array *array_new(Class *c, int count);
 extern void array_set_value(Array *array, int index, Variant value);
+extern void array_resize(Array *array, int count);
+extern void array_throw_out_of_bounds(Array *array, int index) __attribute__((noreturn));
 
 #endif
\ No newline at end of file
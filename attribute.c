@@ -17,40 +17,60 @@
 
 #include "attribute.h"
 
-AttributeInfo attributes_get_attribute(Attributes *attrs, char *name)
+AttributeInfo attributes_get_attribute(Attributes *attrs, Symbol *name)
 {
+    AttributeInfo *attr = attributes_find(attrs, name);
+    if (attr)
+        return *attr;
+
+    AttributeInfo empty;
+    memset(&empty, 0, sizeof(empty));
+    return empty;
+}
+
+/* Returns NULL if the attribute is not present */
+AttributeInfo *attributes_find(Attributes *attrs, Symbol *name)
+{
+    if (!attrs)
+        return NULL;
+
     for (int i = 0; i < attrs->count; i++) {
-        if (!strcmp(attrs->attributes[i].attribute_info.attribute, name)) {
-            return attrs->attributes[i];
+        if (attrs->attributes[i].attribute_info.attribute == name->bytes) {
+            return &attrs->attributes[i];
         }
     }
+
+    return NULL;
 }
 
-Attributes *attributes_new(Reader *reader, ConstantPool *pool)
+/* Everything is allocated from the class's arena and freed along with it */
+Attributes *attributes_new(Reader *reader, ConstantPool *pool, Arena *arena)
 {
-    Attributes *attributes = malloc(sizeof(Attributes));
-    attributes->count = reader_read_uint16_be(reader);
-    if (attributes->count <= 0) {
-        free(attributes);
+    uint16_t count = reader_read_uint16_be(reader);
+    if (count <= 0)
         return NULL;
-    }
 
-    attributes->attributes = malloc(sizeof(AttributeInfo) * attributes->count);
+    Attributes *attributes = arena_alloc(arena, sizeof(Attributes));
+    attributes->count = count;
+    attributes->attributes = arena_alloc(arena, sizeof(AttributeInfo) * attributes->count);
 
     for (int i = 0; i < attributes->count; i++) {
         AttributeInfo *attr = &attributes->attributes[i];
         attr->attribute_info.index = reader_read_uint16_be(reader);
         attr->attribute_info.attribute = constant_pool_resolve_string(pool, attr->attribute_info.index);
         attr->attribute_length = reader_read_uint32_be(reader);
+        int start = reader->offset;
 
-        if (!strcmp(attr->attribute_info.attribute, "ConstantValue")) {
+        /* Attribute names are symbols, so they can be matched by pointer */
+        char *name = attr->attribute_info.attribute;
+        if (name == vm_symbols.constant_value->bytes) {
             attr->constantvalue_index = reader_read_uint16_be(reader);
-        } else if (!strcmp(attr->attribute_info.attribute, "Code")) {
+        } else if (name == vm_symbols.code->bytes) {
             attr->CodeAttribute.max_stack = reader_read_uint16_be(reader);
             attr->CodeAttribute.max_locals = reader_read_uint16_be(reader);
             attr->CodeAttribute.code_length = reader_read_uint32_be(reader);
-            attr->CodeAttribute.code = malloc(attr->CodeAttribute.code_length);
-            reader_read_bytes(reader, attr->CodeAttribute.code, attr->CodeAttribute.code_length);
+            /* Points into the class file, only valid until class_add_method copies it */
+            attr->CodeAttribute.code = reader_get_bytes(reader, attr->CodeAttribute.code_length);
 
             uint16_t exception_table_length = reader_read_uint16_be(reader);
             /*
@@ -64,36 +84,48 @@ Attributes *attributes_new(Reader *reader, ConstantPool *pool)
             reader_skip(reader, 8 * exception_table_length);
 
             // TODO: Parse these once we handle the basic attributes
-            attr->CodeAttribute.attributes = attributes_new(reader, pool);
-        } else if (!strcmp(attr->attribute_info.attribute, "InnerClasses")) {
-        } else if (!strcmp(attr->attribute_info.attribute, "BootstrapMethods")) {
-            attr->BootstrapMethodsAttribute.num_bootstrap_methods = reader_read_uint8(reader);
-            attr->BootstrapMethodsAttribute.bootstrap_methods = malloc(sizeof(*attr->BootstrapMethodsAttribute.bootstrap_methods) * attr->BootstrapMethodsAttribute.num_bootstrap_methods);
+            attr->CodeAttribute.attributes = attributes_new(reader, pool, arena);
+        } else if (name == vm_symbols.inner_classes->bytes) {
+            /* Not used yet */
+            reader_skip(reader, attr->attribute_length);
+        } else if (name == vm_symbols.bootstrap_methods->bytes) {
+            attr->BootstrapMethodsAttribute.num_bootstrap_methods = reader_read_uint16_be(reader);
+            attr->BootstrapMethodsAttribute.bootstrap_methods = arena_alloc(arena, sizeof(*attr->BootstrapMethodsAttribute.bootstrap_methods) * attr->BootstrapMethodsAttribute.num_bootstrap_methods);
 
             for (int j = 0; j < attr->BootstrapMethodsAttribute.num_bootstrap_methods; j++) {
-                attr->BootstrapMethodsAttribute.bootstrap_methods[j].bootstrap_method_ref = reader_read_uint8(reader);
-                attr->BootstrapMethodsAttribute.bootstrap_methods[j].num_bootstrap_arguments = reader_read_uint8(reader);
-                attr->BootstrapMethodsAttribute.bootstrap_methods[j].bootstrap_arguments = malloc(sizeof(uint8_t) * attr->BootstrapMethodsAttribute.bootstrap_methods[j].num_bootstrap_arguments);
-                reader_read_bytes(reader, attr->BootstrapMethodsAttribute.bootstrap_methods[j].bootstrap_arguments, attr->BootstrapMethodsAttribute.bootstrap_methods[j].num_bootstrap_arguments);
+                struct BootstrapMethod *bootstrap = &attr->BootstrapMethodsAttribute.bootstrap_methods[j];
+                bootstrap->bootstrap_method_ref = reader_read_uint16_be(reader);
+                bootstrap->num_bootstrap_arguments = reader_read_uint16_be(reader);
+                bootstrap->bootstrap_arguments = arena_alloc(arena, sizeof(uint16_t) * bootstrap->num_bootstrap_arguments);
+
+                /* Each argument is an index into the constant pool */
+                bool valid = constant_pool_get_tag(pool, bootstrap->bootstrap_method_ref) == CONSTANT_METHODHANDLE;
+                for (int k = 0; k < bootstrap->num_bootstrap_arguments; k++) {
+                    bootstrap->bootstrap_arguments[k] = reader_read_uint16_be(reader);
+                    valid = valid && constant_pool_is_loadable(pool, bootstrap->bootstrap_arguments[k]);
+                }
+
+                /* Linking indexes the pool with these as they are, see string_concat_link */
+                if (!valid && !reader->overflow) {
+                    printf("Invalid reference in bootstrap method %d!\n", j);
+                    reader->overflow = true;
+                    return attributes;
+                }
             }
         } else {
             reader_skip(reader, attr->attribute_length);
         }
-    }
-
-    return attributes;
-}
 
-void attributes_free(Attributes *attributes)
-{
-    if (!attributes)
-        return;
-
-    for (int i = 0; i < attributes->count; i++) {
-        AttributeInfo info = attributes->attributes[i];
-        if (!strcmp(info.attribute_info.attribute, "Code")) {
-            attributes_free(info.CodeAttribute.attributes);
+        /* Anything else would read the next attribute from the middle of this one.
+         * The class is dropped like a truncated one.
+         */
+        if (!reader->overflow && (uint32_t) (reader->offset - start) != attr->attribute_length) {
+            printf("Attribute %s is %u bytes long, but its contents take %d!\n",
+                   name, attr->attribute_length, reader->offset - start);
+            reader->overflow = true;
+            break;
         }
     }
-    free(attributes);
+
+    return attributes;
 }
\ No newline at end of file
@@ -20,8 +20,10 @@
 
 #include <string.h>
 #include <stdint.h>
+#include "arena.h"
 #include "constantpool.h"
 #include "reader.h"
+#include "symbol.h"
 
 typedef struct ConstantPool ConstantPool;
 
@@ -43,11 +45,11 @@ typedef struct AttributeInfo {
         } CodeAttribute;
 
         struct {
-            uint8_t num_bootstrap_methods;
-            struct {
-                uint8_t bootstrap_method_ref;
-                uint8_t num_bootstrap_arguments;
-                uint8_t *bootstrap_arguments;
+            uint16_t num_bootstrap_methods;
+            struct BootstrapMethod {
+                uint16_t bootstrap_method_ref;
+                uint16_t num_bootstrap_arguments;
+                uint16_t *bootstrap_arguments;
             } *bootstrap_methods;
         } BootstrapMethodsAttribute;
 
@@ -61,9 +63,9 @@ typedef struct Attributes {
 } Attributes;
 
 /* Helper functions */
-extern AttributeInfo attributes_get_attribute(Attributes *attrs, char *name);
+extern AttributeInfo attributes_get_attribute(Attributes *attrs, Symbol *name);
+extern AttributeInfo *attributes_find(Attributes *attrs, Symbol *name);
 
-extern Attributes *attributes_new(Reader *reader, ConstantPool *pool);
-extern void attributes_free(Attributes *attributes);
+extern Attributes *attributes_new(Reader *reader, ConstantPool *pool, Arena *arena);
 
 #endif
\ No newline at end of file
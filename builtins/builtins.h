@@ -21,8 +21,11 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include "../method.h"
+#include "../object.h"
 #include "../variant.h"
 
+typedef struct Array Array;
+
 /* TODO: 
  * Add proper support for fields
  * Add flags for methods (static, etc)
@@ -66,10 +69,139 @@ extern builtins java_lang_System_builtins;
 
 extern builtins java_io_PrintStream_builtins;
 
+/* Gives stdout the large buffer System.out writes through */
+extern void printstream_init(void);
+/* Writes out everything buffered by System.out */
+extern void printstream_flush(void);
+
 extern builtins java_util_Objects_builtins;
 
+extern builtins java_util_Collection_builtins;
+
+extern builtins java_util_List_builtins;
+
+extern builtins java_util_ArrayList_builtins;
+
+extern builtins java_util_Map_builtins;
+
+extern builtins java_util_HashMap_builtins;
+
 extern builtins java_lang_invoke_StringConcatFactory_builtins;
 
 extern builtins java_lang_String_builtins;
 
+extern builtins java_lang_StringBuilder_builtins;
+
+extern builtins java_lang_Integer_builtins;
+
+/* Boxed Integers from -128 up to `max` (at least 127) are cached. Returns
+ * false if `max` is more than the cache can hold.
+ */
+extern bool integer_set_cache_max(int max);
+extern Object *integer_value_of(Class *integer_class, int value);
+/* Whether this is one of the shared boxes handed out by integer_value_of */
+extern bool integer_is_cached(Object *integer);
+
+/* Native representation of java/lang/String, kept in its `value` field.
+ * Strings whose chars all fit in Latin-1 store one byte per char, anything
+ * else falls back to UTF-16. A string is only UTF-16 if it has to be, so
+ * equal strings always have the same coder.
+ */
+#define STRING_LATIN1   0
+#define STRING_UTF16    1
+
+typedef struct StringData {
+    int32_t length;
+    uint8_t coder;
+    /* hashCode() is computed on first use and cached here */
+    bool hashed;
+    int32_t hash;
+    /* `length << coder` bytes */
+    uint8_t value[];
+} StringData;
+
+/* `value` is the only field of java/lang/String */
+static inline StringData *string_get_data(Object *string)
+{
+    return string->fields[0]->value.data.ref;
+}
+
+static inline uint16_t string_char_at(StringData *data, int index)
+{
+    if (data->coder == STRING_LATIN1)
+        return data->value[index];
+
+    return ((uint16_t*) data->value)[index];
+}
+
+/* String helpers, shared with the interpreter and other built-ins */
+extern StringData *string_data_new(int length, uint8_t coder);
+extern StringData *string_data_from_utf8(char *bytes, int length);
+extern StringData *string_data_from_utf16(uint16_t *chars, int length);
+extern int32_t string_data_hash(StringData *data);
+extern bool string_data_equals(StringData *a, StringData *b);
+extern int string_data_utf8_length(StringData *data);
+extern int string_data_to_utf8(StringData *data, char *dest);
+extern void string_data_copy(StringData *dest, int offset, StringData *src);
+extern void string_data_copy_ascii(StringData *dest, int offset, const char *src, int length);
+
+extern Object *string_new(Class *string_class, StringData *data);
+extern Object *string_new_utf8(Class *string_class, char *bytes, int length);
+extern Object *string_intern_utf8(Class *string_class, char *bytes, int length);
+extern Object *string_intern(Object *string);
+extern Object *string_value_of(Class *string_class, Object *object);
+/* Calls `visit` on every interned string */
+extern void string_intern_visit(void (*visit)(Object *string, void *context), void *context);
+
+/* Native state of java/lang/StringBuilder, kept in its `value` field.
+ * `data` has room for `capacity` chars in its coder, of which the first
+ * `length` are in use.
+ */
+typedef struct StringBuilderData {
+    int32_t length;
+    int32_t capacity;
+    /* Set once toString() has handed `data` over to a String. The next
+     * change copies it first, so the String never sees it change.
+     */
+    bool shared;
+    StringData *data;
+} StringBuilderData;
+
+/* Native state of java/util/ArrayList, `elements` is as long as the capacity */
+typedef struct ArrayListData {
+    int size;
+    Array *elements;
+} ArrayListData;
+
+/* Native state of java/util/HashMap, see java_util_HashMap.c */
+typedef struct HashMapEntry {
+    /* Distance from the home slot plus one, zero marks an empty slot */
+    uint32_t distance;
+    int32_t hash;
+    Object *key;
+    Variant value;
+} HashMapEntry;
+
+typedef struct HashMapData {
+    uint32_t count;
+    /* Always a power of two */
+    uint32_t capacity;
+    /* 32 - log2(capacity), see hashmap_home() */
+    uint8_t shift;
+    HashMapEntry *entries;
+
+    /* Classes with a native fast path. Integer may not be loaded. */
+    Class *string_class;
+    Class *integer_class;
+} HashMapData;
+
+extern void hashmap_rehash(HashMapData *map);
+
+/* A linked invokedynamic string concatenation, see StringConcatFactory */
+typedef struct ConcatRecipe ConcatRecipe;
+
+extern ConcatRecipe *string_concat_link(Class *class, uint16_t index);
+extern void string_concat_execute(ConcatRecipe *recipe, Frame *frame);
+extern void string_concat_free(ConcatRecipe *recipe);
+
 #endif
\ No newline at end of file
@@ -15,29 +15,234 @@
  * along with this program. If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <string.h>
+
 #include "builtins.h"
+#include "../number.h"
+
+/* System.out shares stdout's stdio buffer with the VM's own messages, so
+ * everything comes out in the order it was written. The buffer is large
+ * and stays fully buffered, so it still goes out in big write() calls,
+ * when it fills up, on flush() and at exit.
+ */
+#define PRINTSTREAM_BUFFER_SIZE (64 * 1024)
+
+static char output[PRINTSTREAM_BUFFER_SIZE];
+
+/* Has to run before anything is written to stdout */
+void printstream_init(void)
+{
+    setvbuf(stdout, output, _IOFBF, sizeof(output));
+}
+
+void printstream_flush(void)
+{
+    fflush(stdout);
+}
+
+/* Write errors are dropped, like Java's PrintStream does */
+static void printstream_write(const char *bytes, size_t length)
+{
+    fwrite(bytes, 1, length, stdout);
+}
+
+static void printstream_print_string_data(StringData *data, bool newline)
+{
+    size_t length = string_data_utf8_length(data);
+    char small[256];
+    char *buffer = length + 1 <= sizeof(small) ? small : malloc(length + 1);
+
+    string_data_to_utf8(data, buffer);
+    if (newline)
+        buffer[length] = '\n';
+    printstream_write(buffer, length + newline);
+
+    if (buffer != small)
+        free(buffer);
+}
+
+static void printstream_print_string(Object *string, bool newline)
+{
+    if (!string) {
+        printstream_write("null\n", 4 + newline);
+        return;
+    }
+
+    printstream_print_string_data(string_get_data(string), newline);
+}
+
+static void printstream_print_long(int64_t value, bool newline)
+{
+    /* 20 chars covers every long, including the sign */
+    char dest[21];
+    int length = number_format_long(value, dest);
+    if (newline)
+        dest[length++] = '\n';
+    printstream_write(dest, length);
+}
 
-/* Arguments: Any (parsed automatically)
+static void printstream_print_char(uint16_t c, bool newline)
+{
+    char dest[4];
+    int length = 0;
+
+    if (c < 0x80) {
+        dest[length++] = c;
+    } else if (c < 0x800) {
+        dest[length++] = 0xC0 | (c >> 6);
+        dest[length++] = 0x80 | (c & 0x3F);
+    } else {
+        dest[length++] = 0xE0 | (c >> 12);
+        dest[length++] = 0x80 | ((c >> 6) & 0x3F);
+        dest[length++] = 0x80 | (c & 0x3F);
+    }
+
+    if (newline)
+        dest[length++] = '\n';
+    printstream_write(dest, length);
+}
+
+static void printstream_print_boolean(bool value, bool newline)
+{
+    if (value)
+        printstream_write("true\n", 4 + newline);
+    else
+        printstream_write("false\n", 5 + newline);
+}
+
+static void printstream_print_object(Method *method, Object *object, bool newline)
+{
+    Class *string_class = classes_get_class(method->class->classes, "java/lang/String");
+    printstream_print_string(string_value_of(string_class, object), newline);
+}
+
+/* Arguments: None
  * Returns: Void
 */
+void java_io_PrintStream_println(Method *method, Frame *frame)
+{
+    printstream_write("\n", 1);
+}
 
+/* Arguments: Reference to java/lang/String
+ * Returns: Void
+*/
 void java_io_PrintStream_println_str(Method *method, Frame *frame)
 {
-    Object *printstream = frame->locals[0].data.object;
-    Object *str = frame->locals[1].data.object;
-    printf("%s\n", object_get_field(str, "value")->value.data.ref);
+    printstream_print_string(frame->locals[1].data.object, true);
+}
+
+/* Arguments: Reference to java/lang/String
+ * Returns: Void
+*/
+void java_io_PrintStream_print_str(Method *method, Frame *frame)
+{
+    printstream_print_string(frame->locals[1].data.object, false);
 }
 
+/* Arguments: Reference to java/lang/Object
+ * Returns: Void
+*/
+void java_io_PrintStream_println_object(Method *method, Frame *frame)
+{
+    printstream_print_object(method, frame->locals[1].data.object, true);
+}
+
+/* Arguments: Reference to java/lang/Object
+ * Returns: Void
+*/
+void java_io_PrintStream_print_object(Method *method, Frame *frame)
+{
+    printstream_print_object(method, frame->locals[1].data.object, false);
+}
+
+/* Arguments: Int
+ * Returns: Void
+*/
 void java_io_PrintStream_println_int(Method *method, Frame *frame)
 {
-    Object *printstream = frame->locals[0].data.object;
-    int32_t value = frame->locals[1].data.int_val;
-    printf("%d\n", value);
+    printstream_print_long(frame->locals[1].data.int_val, true);
+}
+
+/* Arguments: Int
+ * Returns: Void
+*/
+void java_io_PrintStream_print_int(Method *method, Frame *frame)
+{
+    printstream_print_long(frame->locals[1].data.int_val, false);
+}
+
+/* Arguments: Long
+ * Returns: Void
+*/
+void java_io_PrintStream_println_long(Method *method, Frame *frame)
+{
+    printstream_print_long(frame->locals[1].data.long_val, true);
+}
+
+/* Arguments: Long
+ * Returns: Void
+*/
+void java_io_PrintStream_print_long(Method *method, Frame *frame)
+{
+    printstream_print_long(frame->locals[1].data.long_val, false);
+}
+
+/* Arguments: Char
+ * Returns: Void
+*/
+void java_io_PrintStream_println_char(Method *method, Frame *frame)
+{
+    printstream_print_char(frame->locals[1].data.int_val, true);
+}
+
+/* Arguments: Char
+ * Returns: Void
+*/
+void java_io_PrintStream_print_char(Method *method, Frame *frame)
+{
+    printstream_print_char(frame->locals[1].data.int_val, false);
+}
+
+/* Arguments: Boolean
+ * Returns: Void
+*/
+void java_io_PrintStream_println_boolean(Method *method, Frame *frame)
+{
+    printstream_print_boolean(frame->locals[1].data.int_val, true);
+}
+
+/* Arguments: Boolean
+ * Returns: Void
+*/
+void java_io_PrintStream_print_boolean(Method *method, Frame *frame)
+{
+    printstream_print_boolean(frame->locals[1].data.int_val, false);
+}
+
+/* Arguments: None
+ * Returns: Void
+*/
+void java_io_PrintStream_flush(Method *method, Frame *frame)
+{
+    printstream_flush();
 }
 
 static builtin_methods methods[] = {
+    { "println", "()V", 0, &java_io_PrintStream_println },
     { "println", "(Ljava/lang/String;)V", 0, &java_io_PrintStream_println_str },
+    { "println", "(Ljava/lang/Object;)V", 0, &java_io_PrintStream_println_object },
     { "println", "(I)V", 0, &java_io_PrintStream_println_int },
+    { "println", "(J)V", 0, &java_io_PrintStream_println_long },
+    { "println", "(C)V", 0, &java_io_PrintStream_println_char },
+    { "println", "(Z)V", 0, &java_io_PrintStream_println_boolean },
+    { "print", "(Ljava/lang/String;)V", 0, &java_io_PrintStream_print_str },
+    { "print", "(Ljava/lang/Object;)V", 0, &java_io_PrintStream_print_object },
+    { "print", "(I)V", 0, &java_io_PrintStream_print_int },
+    { "print", "(J)V", 0, &java_io_PrintStream_print_long },
+    { "print", "(C)V", 0, &java_io_PrintStream_print_char },
+    { "print", "(Z)V", 0, &java_io_PrintStream_print_boolean },
+    { "flush", "()V", 0, &java_io_PrintStream_flush },
 };
 
 builtins java_io_PrintStream_builtins = {
@@ -0,0 +1,403 @@
+/*
+ * This file is part of MiniJVM (https://github.com/muhammad23012009/minijvm)
+ * Copyright (c) 2025 Muhammad  <thevancedgamer@mentallysanemainliners.org>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <string.h>
+#include "builtins.h"
+#include "../number.h"
+
+#define INTEGER_CACHE_LOW   -128
+/* Every cached box costs an Object, a Field and a pointer up front, which
+ * keeps the largest cache at a few megabytes
+ */
+#define INTEGER_CACHE_HIGH_MAX  ((1 << 16) - 1)
+
+/* Boxes for INTEGER_CACHE_LOW..high, built in one go on first use. They
+ * are pinned and shared, so boxing a cached value never allocates.
+ */
+static struct {
+    int high;
+    Object *boxes;
+} integer_cache = { .high = 127 };
+
+bool integer_set_cache_max(int max)
+{
+    if (max > INTEGER_CACHE_HIGH_MAX)
+        return false;
+
+    /* Like -XX:AutoBoxCacheMax, this can only grow the cache */
+    if (max > integer_cache.high)
+        integer_cache.high = max;
+
+    return true;
+}
+
+/* `value` is the only field of java/lang/Integer */
+static inline int integer_get_value(Object *integer)
+{
+    return integer->fields[0]->value.data.int_val;
+}
+
+static void integer_cache_init(Class *integer_class)
+{
+    int count = integer_cache.high - INTEGER_CACHE_LOW + 1;
+
+    /* Objects, their field tables and fields are each one allocation */
+    Object *boxes = malloc(sizeof(Object) * count);
+    Field **field_tables = malloc(sizeof(Field*) * count);
+    Field *fields = malloc(sizeof(Field) * count);
+
+    /* TODO: Throw a real java/lang/OutOfMemoryError once exceptions are
+     * implemented.
+     */
+    if (!boxes || !field_tables || !fields) {
+        fprintf(stderr, "Exception in thread \"main\" java.lang.OutOfMemoryError: "
+                        "Integer cache of %d boxes\n", count);
+        exit(1);
+    }
+
+    for (int i = 0; i < count; i++) {
+        fields[i].class = integer_class;
+        fields[i].name = integer_class->instance_field_names[0];
+        fields[i].value.type = VARIANT_TYPE_INT;
+        fields[i].value.data.int_val = INTEGER_CACHE_LOW + i;
+        field_tables[i] = &fields[i];
+
+        boxes[i].class = integer_class;
+        boxes[i].initialized = true;
+        boxes[i].pinned = true;
+        boxes[i].fields_count = 1;
+        boxes[i].fields = &field_tables[i];
+    }
+
+    integer_cache.boxes = boxes;
+}
+
+static Object *integer_new(Class *integer_class, int value)
+{
+    Object *integer = object_new(integer_class);
+    integer->fields[0]->value.type = VARIANT_TYPE_INT;
+    integer->fields[0]->value.data.int_val = value;
+    integer->initialized = true;
+
+    return integer;
+}
+
+Object *integer_value_of(Class *integer_class, int value)
+{
+    /* One unsigned compare checks both ends of the range */
+    if ((uint32_t) value - (uint32_t) INTEGER_CACHE_LOW <= (uint32_t) (integer_cache.high - INTEGER_CACHE_LOW)) {
+        if (!integer_cache.boxes)
+            integer_cache_init(integer_class);
+
+        return &integer_cache.boxes[value - INTEGER_CACHE_LOW];
+    }
+
+    return integer_new(integer_class, value);
+}
+
+bool integer_is_cached(Object *integer)
+{
+    return integer_cache.boxes && integer >= integer_cache.boxes &&
+           integer <= &integer_cache.boxes[integer_cache.high - INTEGER_CACHE_LOW];
+}
+
+/* TODO: Throw a real java/lang/NumberFormatException once exceptions are
+ * implemented.
+ */
+static void integer_throw_number_format(Object *string)
+{
+    fprintf(stderr, "Exception in thread \"main\" java.lang.NumberFormatException: ");
+
+    if (string) {
+        StringData *data = string_get_data(string);
+        char *utf8 = malloc(string_data_utf8_length(data) + 1);
+        int length = string_data_to_utf8(data, utf8);
+        fprintf(stderr, "For input string: \"%.*s\"\n", length, utf8);
+        free(utf8);
+    } else {
+        fprintf(stderr, "Cannot parse null string: null\n");
+    }
+
+    exit(1);
+}
+
+/* Radix 10 over Latin-1, the common case. Leading zeros are skipped, after
+ * which at most 10 digits fit in an int. Those are accumulated in 64 bits
+ * with the digit checks or'ed together, so the loop has no early exits,
+ * and the range is checked once at the end.
+ */
+static bool integer_parse_decimal(const uint8_t *chars, int length, int *result)
+{
+    int i = 0;
+    bool negative = false;
+
+    if (length && (chars[0] == '-' || chars[0] == '+')) {
+        negative = chars[0] == '-';
+        i++;
+    }
+
+    if (i == length)
+        return false;
+
+    while (i < length - 1 && chars[i] == '0')
+        i++;
+
+    if (length - i > 10)
+        return false;
+
+    uint64_t value = 0;
+    uint32_t invalid = 0;
+    for (; i < length; i++) {
+        uint32_t digit = (uint32_t) chars[i] - '0';
+        invalid |= digit > 9;
+        value = value * 10 + digit;
+    }
+
+    if (invalid || value > (uint64_t) INT32_MAX + negative)
+        return false;
+
+    *result = (int) (negative ? -(int64_t) value : (int64_t) value);
+    return true;
+}
+
+/* Any radix and coder, accumulating negatively like Java does so that
+ * MIN_VALUE doesn't overflow.
+ */
+static bool integer_parse_radix(StringData *data, int radix, int *result)
+{
+    int i = 0;
+    int length = data->length;
+    bool negative = false;
+    int limit = -INT32_MAX;
+
+    if (radix < 2 || radix > 36 || !length)
+        return false;
+
+    uint16_t first = string_char_at(data, 0);
+    if (first == '-' || first == '+') {
+        negative = first == '-';
+        if (negative)
+            limit = INT32_MIN;
+        if (++i == length)
+            return false;
+    }
+
+    int multiply_min = limit / radix;
+    int value = 0;
+    for (; i < length; i++) {
+        uint16_t c = string_char_at(data, i);
+        int digit = -1;
+        if (c >= '0' && c <= '9')
+            digit = c - '0';
+        else if (c >= 'a' && c <= 'z')
+            digit = c - 'a' + 10;
+        else if (c >= 'A' && c <= 'Z')
+            digit = c - 'A' + 10;
+
+        if (digit < 0 || digit >= radix || value < multiply_min)
+            return false;
+
+        value *= radix;
+        if (value < limit + digit)
+            return false;
+        value -= digit;
+    }
+
+    *result = negative ? value : -value;
+    return true;
+}
+
+static int integer_parse(Object *string, int radix)
+{
+    if (!string)
+        integer_throw_number_format(NULL);
+
+    StringData *data = string_get_data(string);
+    int value;
+    bool parsed;
+
+    if (radix == 10 && data->coder == STRING_LATIN1)
+        parsed = integer_parse_decimal(data->value, data->length, &value);
+    else
+        parsed = integer_parse_radix(data, radix, &value);
+
+    if (!parsed)
+        integer_throw_number_format(string);
+
+    return value;
+}
+
+static Object *integer_to_string(Method *method, int value)
+{
+    Class *string_class = classes_get_class(method->class->classes, "java/lang/String");
+    StringData *data = string_data_new(number_int_length(value), STRING_LATIN1);
+
+    number_format_int(value, (char*) data->value);
+    return string_new(string_class, data);
+}
+
+/* Arguments: Int
+ * Returns: Void
+*/
+void java_lang_Integer_init(Method *method, Frame *frame)
+{
+    Object *integer = frame->locals[0].data.object;
+    integer->fields[0]->value.type = VARIANT_TYPE_INT;
+    integer->fields[0]->value.data.int_val = frame->locals[1].data.int_val;
+    integer->initialized = true;
+}
+
+/* Static
+ * Arguments: Int
+ * Returns: Reference to java/lang/Integer
+*/
+void java_lang_Integer_valueOf(Method *method, Frame *frame)
+{
+    stack_push_object(frame->stack, integer_value_of(method->class, frame->locals[0].data.int_val));
+}
+
+/* Static
+ * Arguments: Reference to java/lang/String
+ * Returns: Reference to java/lang/Integer
+*/
+void java_lang_Integer_valueOf_string(Method *method, Frame *frame)
+{
+    int value = integer_parse(frame->locals[0].data.object, 10);
+    stack_push_object(frame->stack, integer_value_of(method->class, value));
+}
+
+/* Static
+ * Arguments: Reference to java/lang/String
+ * Returns: Int
+*/
+void java_lang_Integer_parseInt(Method *method, Frame *frame)
+{
+    stack_push_int(frame->stack, integer_parse(frame->locals[0].data.object, 10));
+}
+
+/* Static
+ * Arguments: Reference to java/lang/String, Int
+ * Returns: Int
+*/
+void java_lang_Integer_parseInt_radix(Method *method, Frame *frame)
+{
+    stack_push_int(frame->stack, integer_parse(frame->locals[0].data.object, frame->locals[1].data.int_val));
+}
+
+/* Static
+ * Arguments: Int
+ * Returns: Reference to java/lang/String
+*/
+void java_lang_Integer_toString_static(Method *method, Frame *frame)
+{
+    stack_push_object(frame->stack, integer_to_string(method, frame->locals[0].data.int_val));
+}
+
+/* Static
+ * Arguments: Int, Int
+ * Returns: Int
+*/
+void java_lang_Integer_compare(Method *method, Frame *frame)
+{
+    int x = frame->locals[0].data.int_val;
+    int y = frame->locals[1].data.int_val;
+    stack_push_int(frame->stack, (x > y) - (x < y));
+}
+
+/* Arguments: None
+ * Returns: Reference to java/lang/String
+*/
+void java_lang_Integer_toString(Method *method, Frame *frame)
+{
+    stack_push_object(frame->stack, integer_to_string(method, integer_get_value(frame->locals[0].data.object)));
+}
+
+/* Arguments: None
+ * Returns: Int
+*/
+void java_lang_Integer_intValue(Method *method, Frame *frame)
+{
+    stack_push_int(frame->stack, integer_get_value(frame->locals[0].data.object));
+}
+
+/* Arguments: None
+ * Returns: Long
+*/
+void java_lang_Integer_longValue(Method *method, Frame *frame)
+{
+    stack_push_long(frame->stack, integer_get_value(frame->locals[0].data.object));
+}
+
+/* Arguments: None
+ * Returns: Int
+*/
+void java_lang_Integer_hashCode(Method *method, Frame *frame)
+{
+    stack_push_int(frame->stack, integer_get_value(frame->locals[0].data.object));
+}
+
+/* Arguments: Reference to java/lang/Object
+ * Returns: Boolean
+*/
+void java_lang_Integer_equals(Method *method, Frame *frame)
+{
+    Object *integer = frame->locals[0].data.object;
+    Object *other = frame->locals[1].data.object;
+    bool equal = other && other->class == integer->class &&
+                 integer_get_value(integer) == integer_get_value(other);
+
+    stack_push_int(frame->stack, equal);
+}
+
+/* Arguments: Reference to java/lang/Integer
+ * Returns: Int
+*/
+void java_lang_Integer_compareTo(Method *method, Frame *frame)
+{
+    int x = integer_get_value(frame->locals[0].data.object);
+    int y = integer_get_value(frame->locals[1].data.object);
+    stack_push_int(frame->stack, (x > y) - (x < y));
+}
+
+static builtin_fields fields[] = {
+    { "value", 0x0000 }, // handle ACC_PRIVATE later
+};
+
+static builtin_methods methods[] = {
+    { "<init>", "(I)V", 0, &java_lang_Integer_init },
+    { "valueOf", "(I)Ljava/lang/Integer;", 1, &java_lang_Integer_valueOf },
+    { "valueOf", "(Ljava/lang/String;)Ljava/lang/Integer;", 1, &java_lang_Integer_valueOf_string },
+    { "parseInt", "(Ljava/lang/String;)I", 1, &java_lang_Integer_parseInt },
+    { "parseInt", "(Ljava/lang/String;I)I", 1, &java_lang_Integer_parseInt_radix },
+    { "toString", "(I)Ljava/lang/String;", 1, &java_lang_Integer_toString_static },
+    { "compare", "(II)I", 1, &java_lang_Integer_compare },
+    { "toString", "()Ljava/lang/String;", 1, &java_lang_Integer_toString },
+    { "intValue", "()I", 1, &java_lang_Integer_intValue },
+    { "longValue", "()J", 1, &java_lang_Integer_longValue },
+    { "hashCode", "()I", 1, &java_lang_Integer_hashCode },
+    { "equals", "(Ljava/lang/Object;)Z", 1, &java_lang_Integer_equals },
+    { "compareTo", "(Ljava/lang/Integer;)I", 1, &java_lang_Integer_compareTo },
+    { "compareTo", "(Ljava/lang/Object;)I", 1, &java_lang_Integer_compareTo },
+};
+
+builtins java_lang_Integer_builtins = {
+    .parent = "java/lang/Object",
+    .fields = fields,
+    .fields_length = ARRAY_SIZE(fields),
+    .methods = methods,
+    .methods_length = ARRAY_SIZE(methods),
+};
\ No newline at end of file
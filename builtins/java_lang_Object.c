@@ -27,8 +27,26 @@ void java_lang_Object_init(Method *method, Frame *frame)
     object->initialized = true;
 }
 
+/* Arguments: None
+ * Returns: Int
+*/
+void java_lang_Object_hashCode(Method *method, Frame *frame)
+{
+    stack_push_int(frame->stack, object_identity_hash(frame->locals[0].data.object));
+}
+
+/* Arguments: Reference to java/lang/Object
+ * Returns: Boolean
+*/
+void java_lang_Object_equals(Method *method, Frame *frame)
+{
+    stack_push_int(frame->stack, frame->locals[0].data.object == frame->locals[1].data.object);
+}
+
 static builtin_methods methods[] = {
     { "<init>", "()V", 0, &java_lang_Object_init },
+    { "hashCode", "()I", 1, &java_lang_Object_hashCode },
+    { "equals", "(Ljava/lang/Object;)Z", 1, &java_lang_Object_equals },
 };
 
 builtins java_lang_Object_builtins = {
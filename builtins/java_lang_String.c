@@ -1,12 +1,659 @@
+#include <pthread.h>
+
 #include "builtins.h"
+#include "../hash.h"
+#include "../hashtable.h"
+#include "../object.h"
+#include "../simd.h"
+
+typedef struct InternEntry {
+    int32_t hash;
+    Object *string;
+} InternEntry;
+
+/* Process-wide table of canonical String objects. It is shared by every
+ * class, so equal literals anywhere in the program are the same object.
+ */
+static struct {
+    pthread_mutex_t lock;
+    /* Holds InternEntry */
+    HashTable index;
+} intern_table = { .lock = PTHREAD_MUTEX_INITIALIZER };
+
+/* TODO: Throw a real java/lang/StringIndexOutOfBoundsException once
+ * exceptions are implemented.
+ */
+static void string_throw_out_of_bounds(int index, int length)
+{
+    fprintf(stderr, "Exception in thread \"main\" java.lang.StringIndexOutOfBoundsException: "
+                    "Index %d out of bounds for length %d\n", index, length);
+    exit(1);
+}
+
+StringData *string_data_new(int length, uint8_t coder)
+{
+    StringData *data = malloc(sizeof(StringData) + ((size_t) length << coder));
+    data->length = length;
+    data->coder = coder;
+    data->hashed = false;
+    data->hash = 0;
+
+    return data;
+}
+
+/* Compresses to Latin-1 whenever every char fits */
+StringData *string_data_from_utf16(uint16_t *chars, int length)
+{
+    StringData *data;
+
+    if (simd_utf16_is_latin1(chars, length)) {
+        data = string_data_new(length, STRING_LATIN1);
+        for (int i = 0; i < length; i++)
+            data->value[i] = chars[i];
+    } else {
+        data = string_data_new(length, STRING_UTF16);
+        memcpy(data->value, chars, length * sizeof(uint16_t));
+    }
+
+    return data;
+}
+
+/* Decodes the modified UTF-8 used by class files */
+StringData *string_data_from_utf8(char *bytes, int length)
+{
+    uint8_t *utf8 = (uint8_t*) bytes;
+
+    /* Most strings are plain ASCII, which is already valid Latin-1 */
+    if (simd_ascii_prefix(utf8, length) == (size_t) length) {
+        StringData *data = string_data_new(length, STRING_LATIN1);
+        memcpy(data->value, utf8, length);
+        return data;
+    }
+
+    /* There are never more chars than bytes */
+    uint16_t *chars = malloc(sizeof(uint16_t) * length);
+    int count = 0;
+
+    for (int i = 0; i < length;) {
+        uint8_t c = utf8[i];
+        if (c < 0x80) {
+            chars[count++] = c;
+            i += 1;
+        } else if ((c & 0xE0) == 0xC0 && i + 1 < length) {
+            chars[count++] = ((c & 0x1F) << 6) | (utf8[i + 1] & 0x3F);
+            i += 2;
+        } else if ((c & 0xF0) == 0xE0 && i + 2 < length) {
+            chars[count++] = ((c & 0x0F) << 12) | ((utf8[i + 1] & 0x3F) << 6) | (utf8[i + 2] & 0x3F);
+            i += 3;
+        } else {
+            /* Malformed sequence */
+            chars[count++] = 0xFFFD;
+            i += 1;
+        }
+    }
+
+    StringData *data = string_data_from_utf16(chars, count);
+    free(chars);
+    return data;
+}
+
+int32_t string_data_hash(StringData *data)
+{
+    if (!data->hashed) {
+        if (data->coder == STRING_LATIN1)
+            data->hash = simd_hash_u8(data->value, data->length, 0);
+        else
+            data->hash = simd_hash_u16((uint16_t*) data->value, data->length, 0);
+
+        data->hashed = true;
+    }
+
+    return data->hash;
+}
+
+bool string_data_equals(StringData *a, StringData *b)
+{
+    if (a == b)
+        return true;
+
+    if (a->length != b->length || a->coder != b->coder)
+        return false;
+
+    if (a->hashed && b->hashed && a->hash != b->hash)
+        return false;
+
+    size_t size = (size_t) a->length << a->coder;
+    return simd_mismatch(a->value, b->value, size) == size;
+}
+
+static int string_data_compare(StringData *a, StringData *b)
+{
+    int min_length = a->length < b->length ? a->length : b->length;
+    int index;
+
+    if (a->coder == b->coder) {
+        /* The first differing byte is within the first differing char */
+        index = simd_mismatch(a->value, b->value, (size_t) min_length << a->coder) >> a->coder;
+    } else {
+        for (index = 0; index < min_length; index++) {
+            if (string_char_at(a, index) != string_char_at(b, index))
+                break;
+        }
+    }
+
+    if (index < min_length)
+        return string_char_at(a, index) - string_char_at(b, index);
+
+    return a->length - b->length;
+}
+
+static int string_data_index_of_char(StringData *data, int ch, int from)
+{
+    if (from < 0)
+        from = 0;
+
+    if (from >= data->length)
+        return -1;
+
+    size_t remaining = data->length - from;
+    size_t found;
+
+    if (data->coder == STRING_LATIN1) {
+        if (ch < 0 || ch > 0xFF)
+            return -1;
+        found = simd_index_of_u8(&data->value[from], remaining, ch);
+    } else {
+        uint16_t *chars = (uint16_t*) data->value;
+        if (ch > 0xFFFF) {
+            /* Supplementary code points are stored as a surrogate pair */
+            uint16_t high = 0xD800 + ((ch - 0x10000) >> 10);
+            uint16_t low = 0xDC00 + ((ch - 0x10000) & 0x3FF);
+            for (int i = from; i + 1 < data->length; i++) {
+                if (chars[i] == high && chars[i + 1] == low)
+                    return i;
+            }
+            return -1;
+        }
+
+        if (ch < 0)
+            return -1;
+        found = simd_index_of_u16(&chars[from], remaining, ch);
+    }
+
+    return found == remaining ? -1 : from + (int) found;
+}
+
+static int string_data_index_of(StringData *data, StringData *needle, int from)
+{
+    if (from < 0)
+        from = 0;
+
+    if (needle->length == 0)
+        return from <= data->length ? from : data->length;
+
+    /* A UTF-16 needle has a char that cannot occur in a Latin-1 string */
+    if (needle->coder == STRING_UTF16 && data->coder == STRING_LATIN1)
+        return -1;
+
+    uint16_t first = string_char_at(needle, 0);
+    int last_start = data->length - needle->length;
+
+    for (int i = from; i <= last_start;) {
+        /* Scan for the first char, then compare the rest in one go */
+        i = string_data_index_of_char(data, first, i);
+        if (i < 0 || i > last_start)
+            return -1;
+
+        bool match = true;
+        if (data->coder == needle->coder) {
+            size_t size = (size_t) needle->length << needle->coder;
+            match = simd_mismatch(&data->value[(size_t) i << data->coder], needle->value, size) == size;
+        } else {
+            for (int j = 1; j < needle->length && match; j++)
+                match = string_char_at(data, i + j) == string_char_at(needle, j);
+        }
+
+        if (match)
+            return i;
+
+        i++;
+    }
+
+    return -1;
+}
+
+static StringData *string_data_substring(StringData *data, int begin, int end)
+{
+    if (begin < 0)
+        string_throw_out_of_bounds(begin, data->length);
+    if (end > data->length || begin > end)
+        string_throw_out_of_bounds(end, data->length);
+
+    if (data->coder == STRING_UTF16)
+        return string_data_from_utf16(&((uint16_t*) data->value)[begin], end - begin);
+
+    StringData *substring = string_data_new(end - begin, STRING_LATIN1);
+    memcpy(substring->value, &data->value[begin], end - begin);
+    return substring;
+}
+
+int string_data_utf8_length(StringData *data)
+{
+    int length = 0;
+
+    if (data->coder == STRING_LATIN1) {
+        length = simd_ascii_prefix(data->value, data->length);
+        for (int i = length; i < data->length; i++)
+            length += data->value[i] < 0x80 ? 1 : 2;
+        return length;
+    }
+
+    uint16_t *chars = (uint16_t*) data->value;
+    for (int i = 0; i < data->length; i++) {
+        uint16_t c = chars[i];
+        if (c < 0x80) {
+            length += 1;
+        } else if (c < 0x800) {
+            length += 2;
+        } else if (c >= 0xD800 && c <= 0xDBFF && i + 1 < data->length &&
+                   chars[i + 1] >= 0xDC00 && chars[i + 1] <= 0xDFFF) {
+            length += 4;
+            i++;
+        } else {
+            length += 3;
+        }
+    }
+
+    return length;
+}
+
+/* Encodes as standard UTF-8, for output. Returns the number of bytes written. */
+int string_data_to_utf8(StringData *data, char *dest)
+{
+    uint8_t *out = (uint8_t*) dest;
+
+    if (data->coder == STRING_LATIN1) {
+        size_t ascii = simd_ascii_prefix(data->value, data->length);
+        memcpy(out, data->value, ascii);
+        out += ascii;
+
+        for (int i = ascii; i < data->length; i++) {
+            uint8_t c = data->value[i];
+            if (c < 0x80) {
+                *out++ = c;
+            } else {
+                *out++ = 0xC0 | (c >> 6);
+                *out++ = 0x80 | (c & 0x3F);
+            }
+        }
+
+        return out - (uint8_t*) dest;
+    }
+
+    uint16_t *chars = (uint16_t*) data->value;
+    for (int i = 0; i < data->length; i++) {
+        uint32_t c = chars[i];
+        if (c >= 0xD800 && c <= 0xDBFF && i + 1 < data->length &&
+            chars[i + 1] >= 0xDC00 && chars[i + 1] <= 0xDFFF) {
+            c = 0x10000 + ((c - 0xD800) << 10) + (chars[++i] - 0xDC00);
+        }
+
+        if (c < 0x80) {
+            *out++ = c;
+        } else if (c < 0x800) {
+            *out++ = 0xC0 | (c >> 6);
+            *out++ = 0x80 | (c & 0x3F);
+        } else if (c < 0x10000) {
+            *out++ = 0xE0 | (c >> 12);
+            *out++ = 0x80 | ((c >> 6) & 0x3F);
+            *out++ = 0x80 | (c & 0x3F);
+        } else {
+            *out++ = 0xF0 | (c >> 18);
+            *out++ = 0x80 | ((c >> 12) & 0x3F);
+            *out++ = 0x80 | ((c >> 6) & 0x3F);
+            *out++ = 0x80 | (c & 0x3F);
+        }
+    }
+
+    return out - (uint8_t*) dest;
+}
+
+/* Copies all of `src` into `dest` at `offset`, widening Latin-1 chars if
+ * `dest` is UTF-16. `dest` must have room and can't be narrower than `src`.
+ */
+void string_data_copy(StringData *dest, int offset, StringData *src)
+{
+    if (dest->coder == src->coder) {
+        memcpy(dest->value + ((size_t) offset << dest->coder), src->value, (size_t) src->length << src->coder);
+        return;
+    }
+
+    uint16_t *chars = (uint16_t*) dest->value + offset;
+    for (int i = 0; i < src->length; i++)
+        chars[i] = src->value[i];
+}
+
+void string_data_copy_ascii(StringData *dest, int offset, const char *src, int length)
+{
+    if (dest->coder == STRING_LATIN1) {
+        memcpy(dest->value + offset, src, length);
+        return;
+    }
+
+    uint16_t *chars = (uint16_t*) dest->value + offset;
+    for (int i = 0; i < length; i++)
+        chars[i] = src[i];
+}
+
+/* Takes ownership of `data` */
+Object *string_new(Class *string_class, StringData *data)
+{
+    Object *string = object_new(string_class);
+    Field *value = string->fields[0];
+
+    value->value.type = VARIANT_TYPE_REF;
+    value->value.data.ref = data;
+
+    string->initialized = true;
+    return string;
+}
+
+Object *string_new_utf8(Class *string_class, char *bytes, int length)
+{
+    return string_new(string_class, string_data_from_utf8(bytes, length));
+}
+
+typedef struct InternKey {
+    int32_t hash;
+    StringData *data;
+} InternKey;
+
+static bool intern_entry_match(const void *entry, const void *key)
+{
+    const InternEntry *e = entry;
+    const InternKey *k = key;
+    return e->hash == k->hash && string_data_equals(string_get_data(e->string), k->data);
+}
+
+static uint32_t intern_entry_hash(const void *entry)
+{
+    return ((const InternEntry*) entry)->hash;
+}
+
+/* Returns the slot holding an equal string, or the empty slot it would go
+ * in. Must be called with the table locked.
+ */
+static InternEntry *intern_table_reserve(int32_t hash, StringData *data)
+{
+    hash_table_reserve(&intern_table.index, sizeof(InternEntry), 256, intern_entry_hash);
+
+    InternKey key = { hash, data };
+    return hash_table_probe(&intern_table.index, sizeof(InternEntry), hash, intern_entry_match, &key);
+}
+
+static Object *intern_table_insert(InternEntry *slot, int32_t hash, Object *string)
+{
+    slot->hash = hash;
+    slot->string = string;
+
+    string->pinned = true;
+    intern_table.index.count++;
+
+    return string;
+}
+
+Object *string_intern_utf8(Class *string_class, char *bytes, int length)
+{
+    StringData *data = string_data_from_utf8(bytes, length);
+    int32_t hash = string_data_hash(data);
+
+    pthread_mutex_lock(&intern_table.lock);
+
+    InternEntry *slot = intern_table_reserve(hash, data);
+    Object *string = slot->string;
+    if (!string)
+        string = intern_table_insert(slot, hash, string_new(string_class, data));
+    else
+        free(data);
+
+    pthread_mutex_unlock(&intern_table.lock);
+    return string;
+}
+
+Object *string_intern(Object *string)
+{
+    StringData *data = string_get_data(string);
+    int32_t hash = string_data_hash(data);
+
+    pthread_mutex_lock(&intern_table.lock);
+
+    InternEntry *slot = intern_table_reserve(hash, data);
+    Object *interned = slot->string;
+    if (!interned)
+        interned = intern_table_insert(slot, hash, string);
+
+    pthread_mutex_unlock(&intern_table.lock);
+    return interned;
+}
+
+void string_intern_visit(void (*visit)(Object *string, void *context), void *context)
+{
+    pthread_mutex_lock(&intern_table.lock);
+    InternEntry *entries = intern_table.index.entries;
+    for (uint32_t i = 0; entries && i <= intern_table.index.mask; i++) {
+        if (entries[i].string)
+            visit(entries[i].string, context);
+    }
+    pthread_mutex_unlock(&intern_table.lock);
+}
+
+/* Same as String.valueOf(Object): null becomes "null", and anything that
+ * isn't a string goes through its toString().
+ */
+Object *string_value_of(Class *string_class, Object *object)
+{
+    if (!object)
+        return string_intern_utf8(string_class, "null", 4);
+
+    if (object->class == string_class)
+        return object;
+
+    Method *to_string = class_find_method(object->class, "toString", "()Ljava/lang/String;");
+    if (to_string) {
+        Variant this = { .type = VARIANT_TYPE_OBJECT, .data.object = object };
+        Object *string = method_call(to_string, &this, true).data.object;
+        return string ? string : string_intern_utf8(string_class, "null", 4);
+    }
+
+    /* Same as the default Object.toString() */
+    char buffer[512];
+    int length = snprintf(buffer, sizeof(buffer), "%s@%x", object->class->name, (uint32_t) object_identity_hash(object));
+    if (length >= (int) sizeof(buffer))
+        length = sizeof(buffer) - 1;
+
+    for (int i = 0; i < length; i++) {
+        if (buffer[i] == '/')
+            buffer[i] = '.';
+    }
+
+    return string_new_utf8(string_class, buffer, length);
+}
+
+/* Arguments: None
+ * Returns: Int
+*/
+void java_lang_String_length(Method *method, Frame *frame)
+{
+    StringData *data = string_get_data(frame->locals[0].data.object);
+    stack_push_int(frame->stack, data->length);
+}
+
+/* Arguments: None
+ * Returns: Boolean
+*/
+void java_lang_String_isEmpty(Method *method, Frame *frame)
+{
+    StringData *data = string_get_data(frame->locals[0].data.object);
+    stack_push_int(frame->stack, data->length == 0);
+}
+
+/* Arguments: Int
+ * Returns: Char
+*/
+void java_lang_String_charAt(Method *method, Frame *frame)
+{
+    StringData *data = string_get_data(frame->locals[0].data.object);
+    int index = frame->locals[1].data.int_val;
+
+    if ((uint32_t) index >= (uint32_t) data->length)
+        string_throw_out_of_bounds(index, data->length);
+
+    stack_push_int(frame->stack, string_char_at(data, index));
+}
+
+/* Arguments: Reference to java/lang/Object
+ * Returns: Boolean
+*/
+void java_lang_String_equals(Method *method, Frame *frame)
+{
+    Object *string = frame->locals[0].data.object;
+    Object *other = frame->locals[1].data.object;
+    bool equal = false;
+
+    if (other && other->class == string->class)
+        equal = string_data_equals(string_get_data(string), string_get_data(other));
+
+    stack_push_int(frame->stack, equal);
+}
+
+/* Arguments: None
+ * Returns: Int
+*/
+void java_lang_String_hashCode(Method *method, Frame *frame)
+{
+    StringData *data = string_get_data(frame->locals[0].data.object);
+    stack_push_int(frame->stack, string_data_hash(data));
+}
+
+/* Arguments: Int (char)
+ * Returns: Int
+*/
+void java_lang_String_indexOf_char(Method *method, Frame *frame)
+{
+    StringData *data = string_get_data(frame->locals[0].data.object);
+    stack_push_int(frame->stack, string_data_index_of_char(data, frame->locals[1].data.int_val, 0));
+}
+
+/* Arguments: Int (char), Int
+ * Returns: Int
+*/
+void java_lang_String_indexOf_char_from(Method *method, Frame *frame)
+{
+    StringData *data = string_get_data(frame->locals[0].data.object);
+    int ch = frame->locals[1].data.int_val;
+    int from = frame->locals[2].data.int_val;
+
+    stack_push_int(frame->stack, string_data_index_of_char(data, ch, from));
+}
+
+/* Arguments: Reference to java/lang/String
+ * Returns: Int
+*/
+void java_lang_String_indexOf_string(Method *method, Frame *frame)
+{
+    StringData *data = string_get_data(frame->locals[0].data.object);
+    StringData *needle = string_get_data(frame->locals[1].data.object);
+
+    stack_push_int(frame->stack, string_data_index_of(data, needle, 0));
+}
+
+/* Arguments: Reference to java/lang/String
+ * Returns: Int
+*/
+void java_lang_String_compareTo(Method *method, Frame *frame)
+{
+    StringData *data = string_get_data(frame->locals[0].data.object);
+    StringData *other = string_get_data(frame->locals[1].data.object);
+
+    stack_push_int(frame->stack, string_data_compare(data, other));
+}
+
+static Object *string_substring(Object *string, int begin, int end)
+{
+    StringData *data = string_get_data(string);
+
+    /* Strings are immutable, so the whole string can be shared */
+    if (begin == 0 && end == data->length)
+        return string;
+
+    return string_new(string->class, string_data_substring(data, begin, end));
+}
+
+/* Arguments: Int, Int
+ * Returns: Reference to java/lang/String
+*/
+void java_lang_String_substring(Method *method, Frame *frame)
+{
+    Object *string = frame->locals[0].data.object;
+    int begin = frame->locals[1].data.int_val;
+    int end = frame->locals[2].data.int_val;
+
+    stack_push_object(frame->stack, string_substring(string, begin, end));
+}
+
+/* Arguments: Int
+ * Returns: Reference to java/lang/String
+*/
+void java_lang_String_substring_begin(Method *method, Frame *frame)
+{
+    Object *string = frame->locals[0].data.object;
+    int begin = frame->locals[1].data.int_val;
+
+    stack_push_object(frame->stack, string_substring(string, begin, string_get_data(string)->length));
+}
+
+/* Arguments: None
+ * Returns: Reference to java/lang/String
+*/
+void java_lang_String_toString(Method *method, Frame *frame)
+{
+    stack_push_object(frame->stack, frame->locals[0].data.object);
+}
+
+/* Arguments: None
+ * Returns: Reference to java/lang/String
+*/
+void java_lang_String_intern(Method *method, Frame *frame)
+{
+    Object *string = frame->locals[0].data.object;
+    stack_push_object(frame->stack, string_intern(string));
+}
 
 static builtin_fields fields[] = {
     { "value", 0x0000 }, // handle ACC_PRIVATE later
 };
 
+static builtin_methods methods[] = {
+    { "length", "()I", 1, &java_lang_String_length },
+    { "isEmpty", "()Z", 1, &java_lang_String_isEmpty },
+    { "charAt", "(I)C", 1, &java_lang_String_charAt },
+    { "equals", "(Ljava/lang/Object;)Z", 1, &java_lang_String_equals },
+    { "hashCode", "()I", 1, &java_lang_String_hashCode },
+    { "indexOf", "(I)I", 1, &java_lang_String_indexOf_char },
+    { "indexOf", "(II)I", 1, &java_lang_String_indexOf_char_from },
+    { "indexOf", "(Ljava/lang/String;)I", 1, &java_lang_String_indexOf_string },
+    { "compareTo", "(Ljava/lang/String;)I", 1, &java_lang_String_compareTo },
+    { "compareTo", "(Ljava/lang/Object;)I", 1, &java_lang_String_compareTo },
+    { "substring", "(I)Ljava/lang/String;", 1, &java_lang_String_substring_begin },
+    { "substring", "(II)Ljava/lang/String;", 1, &java_lang_String_substring },
+    { "toString", "()Ljava/lang/String;", 1, &java_lang_String_toString },
+    { "intern", "()Ljava/lang/String;", 1, &java_lang_String_intern },
+};
+
 builtins java_lang_String_builtins = {
     .parent = "java/lang/Object",
     .fields = fields,
     .fields_length = 1,
-    .methods = NULL,
+    .methods = methods,
+    .methods_length = ARRAY_SIZE(methods),
 };
\ No newline at end of file
@@ -0,0 +1,368 @@
+/*
+ * This file is part of MiniJVM (https://github.com/muhammad23012009/minijvm)
+ * Copyright (c) 2025 Muhammad  <thevancedgamer@mentallysanemainliners.org>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <string.h>
+#include "builtins.h"
+#include "../number.h"
+#include "../simd.h"
+
+#define STRING_BUILDER_DEFAULT_CAPACITY 16
+
+static inline StringBuilderData *string_builder_get_data(Object *builder)
+{
+    return builder->fields[0]->value.data.ref;
+}
+
+/* TODO: Throw a real java/lang/OutOfMemoryError once exceptions are
+ * implemented.
+ */
+static void string_builder_throw_overflow(void)
+{
+    fprintf(stderr, "Exception in thread \"main\" java.lang.OutOfMemoryError: "
+                    "Requested length exceeds VM limit\n");
+    exit(1);
+}
+
+static void string_builder_init(Object *builder, int capacity)
+{
+    StringBuilderData *data = malloc(sizeof(StringBuilderData));
+    data->length = 0;
+    data->capacity = capacity;
+    data->shared = false;
+    data->data = string_data_new(capacity, STRING_LATIN1);
+
+    Field *value = builder->fields[0];
+    value->value.type = VARIANT_TYPE_REF;
+    value->value.data.ref = data;
+
+    builder->initialized = true;
+}
+
+/* Makes room for `extra` more chars in at least `coder`. The buffer grows
+ * geometrically, so a run of appends only copies O(n) chars in total.
+ */
+static void string_builder_reserve(StringBuilderData *builder, int64_t extra, uint8_t coder)
+{
+    int64_t needed = builder->length + extra;
+    uint8_t new_coder = builder->data->coder | coder;
+
+    if (needed > INT32_MAX)
+        string_builder_throw_overflow();
+
+    if (!builder->shared && needed <= builder->capacity && new_coder == builder->data->coder)
+        return;
+
+    int64_t capacity = builder->capacity;
+    if (needed > capacity) {
+        capacity = capacity * 2 + 2;
+        if (capacity < needed)
+            capacity = needed;
+        if (capacity > INT32_MAX)
+            capacity = INT32_MAX;
+    }
+
+    if (!builder->shared && new_coder == builder->data->coder) {
+        /* realloc() can often extend the block without copying */
+        builder->data = realloc(builder->data, sizeof(StringData) + ((size_t) capacity << new_coder));
+    } else {
+        StringData *data = string_data_new(capacity, new_coder);
+        StringData *old = builder->data;
+
+        /* Only the chars in use are copied. A String sharing the buffer
+         * already has the right length.
+         */
+        if (!builder->shared)
+            old->length = builder->length;
+        string_data_copy(data, 0, old);
+
+        if (!builder->shared)
+            free(old);
+
+        builder->data = data;
+        builder->shared = false;
+    }
+
+    builder->capacity = capacity;
+}
+
+static void string_builder_append_data(StringBuilderData *builder, StringData *data)
+{
+    string_builder_reserve(builder, data->length, data->coder);
+    string_data_copy(builder->data, builder->length, data);
+    builder->length += data->length;
+}
+
+static void string_builder_append_ascii(StringBuilderData *builder, const char *chars, int length)
+{
+    string_builder_reserve(builder, length, STRING_LATIN1);
+    string_data_copy_ascii(builder->data, builder->length, chars, length);
+    builder->length += length;
+}
+
+/* Arguments: None
+ * Returns: Void
+*/
+void java_lang_StringBuilder_init(Method *method, Frame *frame)
+{
+    string_builder_init(frame->locals[0].data.object, STRING_BUILDER_DEFAULT_CAPACITY);
+}
+
+/* Arguments: Int
+ * Returns: Void
+*/
+void java_lang_StringBuilder_init_capacity(Method *method, Frame *frame)
+{
+    int capacity = frame->locals[1].data.int_val;
+    if (capacity < 0) {
+        fprintf(stderr, "Exception in thread \"main\" java.lang.NegativeArraySizeException: %d\n", capacity);
+        exit(1);
+    }
+
+    string_builder_init(frame->locals[0].data.object, capacity);
+}
+
+/* Arguments: Reference to java/lang/String
+ * Returns: Void
+*/
+void java_lang_StringBuilder_init_string(Method *method, Frame *frame)
+{
+    Object *builder = frame->locals[0].data.object;
+    Object *string = frame->locals[1].data.object;
+    if (!string) {
+        fprintf(stderr, "Exception in thread \"main\" java.lang.NullPointerException\n");
+        exit(1);
+    }
+
+    StringData *data = string_get_data(string);
+    string_builder_init(builder, data->length + STRING_BUILDER_DEFAULT_CAPACITY);
+    string_builder_append_data(string_builder_get_data(builder), data);
+}
+
+/* Arguments: Reference to java/lang/String
+ * Returns: Reference to java/lang/StringBuilder
+*/
+void java_lang_StringBuilder_append_string(Method *method, Frame *frame)
+{
+    Object *builder = frame->locals[0].data.object;
+    Object *string = frame->locals[1].data.object;
+
+    if (string)
+        string_builder_append_data(string_builder_get_data(builder), string_get_data(string));
+    else
+        string_builder_append_ascii(string_builder_get_data(builder), "null", 4);
+
+    stack_push_object(frame->stack, builder);
+}
+
+/* Arguments: Reference to java/lang/Object
+ * Returns: Reference to java/lang/StringBuilder
+*/
+void java_lang_StringBuilder_append_object(Method *method, Frame *frame)
+{
+    Object *builder = frame->locals[0].data.object;
+    Class *string_class = classes_get_class(builder->class->classes, "java/lang/String");
+    Object *string = string_value_of(string_class, frame->locals[1].data.object);
+
+    string_builder_append_data(string_builder_get_data(builder), string_get_data(string));
+    stack_push_object(frame->stack, builder);
+}
+
+/* Digits are written straight into the buffer, no temporary string needed */
+
+/* Arguments: Int
+ * Returns: Reference to java/lang/StringBuilder
+*/
+void java_lang_StringBuilder_append_int(Method *method, Frame *frame)
+{
+    Object *builder = frame->locals[0].data.object;
+    StringBuilderData *data = string_builder_get_data(builder);
+    int value = frame->locals[1].data.int_val;
+
+    if (data->data->coder == STRING_LATIN1) {
+        string_builder_reserve(data, number_int_length(value), STRING_LATIN1);
+        data->length += number_format_int(value, (char*) data->data->value + data->length);
+    } else {
+        char digits[12];
+        string_builder_append_ascii(data, digits, number_format_int(value, digits));
+    }
+
+    stack_push_object(frame->stack, builder);
+}
+
+/* Arguments: Long
+ * Returns: Reference to java/lang/StringBuilder
+*/
+void java_lang_StringBuilder_append_long(Method *method, Frame *frame)
+{
+    Object *builder = frame->locals[0].data.object;
+    StringBuilderData *data = string_builder_get_data(builder);
+    int64_t value = frame->locals[1].data.long_val;
+
+    if (data->data->coder == STRING_LATIN1) {
+        string_builder_reserve(data, number_long_length(value), STRING_LATIN1);
+        data->length += number_format_long(value, (char*) data->data->value + data->length);
+    } else {
+        char digits[20];
+        string_builder_append_ascii(data, digits, number_format_long(value, digits));
+    }
+
+    stack_push_object(frame->stack, builder);
+}
+
+/* Arguments: Char
+ * Returns: Reference to java/lang/StringBuilder
+*/
+void java_lang_StringBuilder_append_char(Method *method, Frame *frame)
+{
+    Object *builder = frame->locals[0].data.object;
+    StringBuilderData *data = string_builder_get_data(builder);
+    uint16_t c = frame->locals[1].data.int_val;
+
+    string_builder_reserve(data, 1, c > 0xFF ? STRING_UTF16 : STRING_LATIN1);
+    if (data->data->coder == STRING_LATIN1)
+        data->data->value[data->length++] = c;
+    else
+        ((uint16_t*) data->data->value)[data->length++] = c;
+
+    stack_push_object(frame->stack, builder);
+}
+
+/* Arguments: Boolean
+ * Returns: Reference to java/lang/StringBuilder
+*/
+void java_lang_StringBuilder_append_boolean(Method *method, Frame *frame)
+{
+    Object *builder = frame->locals[0].data.object;
+
+    if (frame->locals[1].data.int_val)
+        string_builder_append_ascii(string_builder_get_data(builder), "true", 4);
+    else
+        string_builder_append_ascii(string_builder_get_data(builder), "false", 5);
+
+    stack_push_object(frame->stack, builder);
+}
+
+/* Arguments: None
+ * Returns: Int
+*/
+void java_lang_StringBuilder_length(Method *method, Frame *frame)
+{
+    stack_push_int(frame->stack, string_builder_get_data(frame->locals[0].data.object)->length);
+}
+
+/* Arguments: Int
+ * Returns: Char
+*/
+void java_lang_StringBuilder_charAt(Method *method, Frame *frame)
+{
+    StringBuilderData *data = string_builder_get_data(frame->locals[0].data.object);
+    int index = frame->locals[1].data.int_val;
+
+    if ((uint32_t) index >= (uint32_t) data->length) {
+        fprintf(stderr, "Exception in thread \"main\" java.lang.StringIndexOutOfBoundsException: "
+                        "index %d,length %d\n", index, data->length);
+        exit(1);
+    }
+
+    stack_push_int(frame->stack, string_char_at(data->data, index));
+}
+
+/* Arguments: Int
+ * Returns: Void
+*/
+void java_lang_StringBuilder_setLength(Method *method, Frame *frame)
+{
+    StringBuilderData *data = string_builder_get_data(frame->locals[0].data.object);
+    int length = frame->locals[1].data.int_val;
+
+    if (length < 0) {
+        fprintf(stderr, "Exception in thread \"main\" java.lang.StringIndexOutOfBoundsException: "
+                        "String index out of range: %d\n", length);
+        exit(1);
+    }
+
+    /* Always reserve, a shared buffer must be copied even when shrinking */
+    string_builder_reserve(data, length > data->length ? length - data->length : 0, STRING_LATIN1);
+    if (length > data->length) {
+        memset(data->data->value + ((size_t) data->length << data->data->coder), 0,
+               (size_t) (length - data->length) << data->data->coder);
+    }
+
+    data->length = length;
+}
+
+/* The buffer is handed over to the new String instead of being copied.
+ * Any spare capacity is trimmed off first, which realloc() can usually do
+ * in place.
+ *
+ * Arguments: None
+ * Returns: Reference to java/lang/String
+*/
+void java_lang_StringBuilder_toString(Method *method, Frame *frame)
+{
+    Object *builder = frame->locals[0].data.object;
+    StringBuilderData *data = string_builder_get_data(builder);
+    Class *string_class = classes_get_class(builder->class->classes, "java/lang/String");
+
+    if (!data->shared) {
+        StringData *string = data->data;
+
+        /* Only the chars in use decide the coder of the String */
+        if (string->coder == STRING_UTF16 && simd_utf16_is_latin1((uint16_t*) string->value, data->length)) {
+            string = string_data_from_utf16((uint16_t*) string->value, data->length);
+            free(data->data);
+        } else {
+            string = realloc(string, sizeof(StringData) + ((size_t) data->length << string->coder));
+            string->length = data->length;
+            string->hashed = false;
+        }
+
+        data->data = string;
+        data->capacity = data->length;
+        data->shared = true;
+    }
+
+    stack_push_object(frame->stack, string_new(string_class, data->data));
+}
+
+static builtin_fields fields[] = {
+    { "value", 0x0000 }, // handle ACC_PRIVATE later
+};
+
+static builtin_methods methods[] = {
+    { "<init>", "()V", 0, &java_lang_StringBuilder_init },
+    { "<init>", "(I)V", 0, &java_lang_StringBuilder_init_capacity },
+    { "<init>", "(Ljava/lang/String;)V", 0, &java_lang_StringBuilder_init_string },
+    { "append", "(Ljava/lang/String;)Ljava/lang/StringBuilder;", 1, &java_lang_StringBuilder_append_string },
+    { "append", "(Ljava/lang/Object;)Ljava/lang/StringBuilder;", 1, &java_lang_StringBuilder_append_object },
+    { "append", "(I)Ljava/lang/StringBuilder;", 1, &java_lang_StringBuilder_append_int },
+    { "append", "(J)Ljava/lang/StringBuilder;", 1, &java_lang_StringBuilder_append_long },
+    { "append", "(C)Ljava/lang/StringBuilder;", 1, &java_lang_StringBuilder_append_char },
+    { "append", "(Z)Ljava/lang/StringBuilder;", 1, &java_lang_StringBuilder_append_boolean },
+    { "length", "()I", 1, &java_lang_StringBuilder_length },
+    { "charAt", "(I)C", 1, &java_lang_StringBuilder_charAt },
+    { "setLength", "(I)V", 0, &java_lang_StringBuilder_setLength },
+    { "toString", "()Ljava/lang/String;", 1, &java_lang_StringBuilder_toString },
+};
+
+builtins java_lang_StringBuilder_builtins = {
+    .parent = "java/lang/Object",
+    .fields = fields,
+    .fields_length = 1,
+    .methods = methods,
+    .methods_length = ARRAY_SIZE(methods),
+};
\ No newline at end of file
@@ -1,4 +1,417 @@
+/*
+ * This file is part of MiniJVM (https://github.com/muhammad23012009/minijvm)
+ * Copyright (c) 2025 Muhammad  <thevancedgamer@mentallysanemainliners.org>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <string.h>
 #include "builtins.h"
+#include "../array.h"
+#include "../attribute.h"
+#include "../number.h"
+
+/* Call sites bootstrapped by StringConcatFactory are linked once into a
+ * concat recipe: the recipe string is split into segments up front, so
+ * running the call site only has to size the result, allocate it once
+ * and copy every piece straight into place.
+ */
+
+typedef enum ConcatKind {
+    CONCAT_CONSTANT,
+    CONCAT_STRING,
+    CONCAT_OBJECT,
+    /* Arrays have no toString() of their own, see concat_array_string() */
+    CONCAT_ARRAY,
+    CONCAT_INT,
+    CONCAT_LONG,
+    CONCAT_CHAR,
+    CONCAT_BOOLEAN,
+} ConcatKind;
+
+typedef struct ConcatSegment {
+    ConcatKind kind;
+    /* Only set for CONCAT_CONSTANT */
+    StringData *constant;
+    /* Only set for CONCAT_ARRAY, the Java name of the array class */
+    char *array_name;
+} ConcatSegment;
+
+struct ConcatRecipe {
+    Class *string_class;
+    int arguments_count;
+    int segments_count;
+    ConcatSegment segments[];
+};
+
+/* Tags used by makeConcatWithConstants recipes */
+#define RECIPE_ARGUMENT     0x01
+#define RECIPE_CONSTANT     0x02
+
+/* Adjacent constants are merged so they are copied in one go */
+static void concat_add_constant(ConcatRecipe *recipe, StringData *constant)
+{
+    if (!constant->length) {
+        free(constant);
+        return;
+    }
+
+    ConcatSegment *last = recipe->segments_count ? &recipe->segments[recipe->segments_count - 1] : NULL;
+    if (last && last->kind == CONCAT_CONSTANT) {
+        StringData *merged = string_data_new(last->constant->length + constant->length,
+                                             last->constant->coder | constant->coder);
+        string_data_copy(merged, 0, last->constant);
+        string_data_copy(merged, last->constant->length, constant);
+
+        free(last->constant);
+        free(constant);
+        last->constant = merged;
+        return;
+    }
+
+    recipe->segments[recipe->segments_count++] = (ConcatSegment) { CONCAT_CONSTANT, constant, NULL };
+}
+
+/* Class.getName() of an array type, e.g. "[[I" or "[Ljava.lang.String;" */
+static char *concat_array_name(Descriptor *descriptor)
+{
+    static const char primitives[] = {
+        [DESCRIPTOR_INT] = 'I', [DESCRIPTOR_BOOLEAN] = 'Z', [DESCRIPTOR_BYTE] = 'B',
+        [DESCRIPTOR_CHAR] = 'C', [DESCRIPTOR_SHORT] = 'S', [DESCRIPTOR_LONG] = 'J',
+        [DESCRIPTOR_FLOAT] = 'F', [DESCRIPTOR_DOUBLE] = 'D',
+    };
+
+    int dimensions = descriptor->array_dimesions_count;
+    bool object = descriptor->type == DESCRIPTOR_OBJECT && descriptor->object_name;
+    size_t length = dimensions + (object ? strlen(descriptor->object_name) + 2 : 1);
+    char *name = malloc(length + 1);
+
+    memset(name, '[', dimensions);
+    if (object)
+        snprintf(name + dimensions, length + 1 - dimensions, "L%s;", descriptor->object_name);
+    else
+        snprintf(name + dimensions, length + 1 - dimensions, "%c", primitives[descriptor->type]);
+
+    for (char *c = name; *c; c++) {
+        if (*c == '/')
+            *c = '.';
+    }
+
+    return name;
+}
+
+static bool concat_add_argument(ConcatRecipe *recipe, Descriptor *descriptor)
+{
+    ConcatKind kind;
+    char *array_name = NULL;
+
+    if (descriptor->array_dimesions_count) {
+        if (descriptor->type == DESCRIPTOR_VOID || (descriptor->type == DESCRIPTOR_OBJECT && !descriptor->object_name))
+            return false;
+
+        kind = CONCAT_ARRAY;
+        array_name = concat_array_name(descriptor);
+    } else {
+        switch (descriptor->type) {
+            case DESCRIPTOR_OBJECT:
+                kind = !strcmp(descriptor->object_name, "java/lang/String") ? CONCAT_STRING : CONCAT_OBJECT;
+                break;
+            case DESCRIPTOR_INT:
+            case DESCRIPTOR_SHORT:
+            case DESCRIPTOR_BYTE:
+                kind = CONCAT_INT;
+                break;
+            case DESCRIPTOR_LONG:
+                kind = CONCAT_LONG;
+                break;
+            case DESCRIPTOR_CHAR:
+                kind = CONCAT_CHAR;
+                break;
+            case DESCRIPTOR_BOOLEAN:
+                kind = CONCAT_BOOLEAN;
+                break;
+            default:
+                return false;
+        }
+    }
+
+    recipe->segments[recipe->segments_count++] = (ConcatSegment) { kind, NULL, array_name };
+    return true;
+}
+
+static StringData *concat_constant_from_pool(ConstantPool *pool, uint16_t index)
+{
+    uint8_t tag = constant_pool_get_tag(pool, index);
+
+    if (tag == CONSTANT_STRING) {
+        Symbol *utf8 = constant_pool_resolve_symbol(pool, index);
+        return string_data_from_utf8(utf8->bytes, utf8->length);
+    }
+
+    if (tag == CONSTANT_INT) {
+        char digits[12];
+        int length = number_format_int(constant_pool_resolve_int(pool, index), digits);
+        return string_data_from_utf8(digits, length);
+    }
+
+    return NULL;
+}
+
+/* Returns NULL if the call site isn't a string concatenation we support */
+ConcatRecipe *string_concat_link(Class *class, uint16_t index)
+{
+    ConstantPool *pool = class->pool;
+    uint16_t bootstrap_index = constant_pool_first_index(pool, index);
+
+    if (bootstrap_index >= class->bootstrap_methods_count)
+        return NULL;
+
+    struct BootstrapMethod *bootstrap = &class->bootstrap_methods[bootstrap_index];
+    uint16_t reference = constant_pool_second_index(pool, bootstrap->bootstrap_method_ref);
+    if (strcmp(constant_pool_resolve_class_name(pool, reference), "java/lang/invoke/StringConcatFactory"))
+        return NULL;
+
+    char *bootstrap_name = constant_pool_resolve_field_name(pool, reference);
+    bool with_constants = !strcmp(bootstrap_name, "makeConcatWithConstants");
+    if (!with_constants && strcmp(bootstrap_name, "makeConcat"))
+        return NULL;
+
+    if (with_constants && (!bootstrap->num_bootstrap_arguments ||
+                           constant_pool_get_tag(pool, bootstrap->bootstrap_arguments[0]) != CONSTANT_STRING))
+        return NULL;
+
+    uint16_t name_and_type = constant_pool_second_index(pool, index);
+    Descriptors *descriptors = descriptors_intern(constant_pool_resolve_string(pool, constant_pool_second_index(pool, name_and_type)));
+
+    uint8_t *tags = NULL;
+    int tags_length = descriptors->arguments_count;
+    if (with_constants) {
+        Symbol *utf8 = constant_pool_resolve_symbol(pool, bootstrap->bootstrap_arguments[0]);
+        tags = (uint8_t*) utf8->bytes;
+        tags_length = utf8->length;
+    }
+
+    /* Every segment takes up at least one byte of the recipe */
+    ConcatRecipe *recipe = malloc(sizeof(ConcatRecipe) + sizeof(ConcatSegment) * (tags_length + 1));
+    recipe->string_class = classes_get_class(class->classes, "java/lang/String");
+    recipe->arguments_count = descriptors->arguments_count;
+    recipe->segments_count = 0;
+
+    int argument = 0;
+    int constant = 1;
+    bool linked = true;
+
+    if (!with_constants) {
+        while (linked && argument < descriptors->arguments_count)
+            linked = concat_add_argument(recipe, &descriptors->arguments[argument++]);
+    } else {
+        /* Multi-byte UTF-8 sequences never contain bytes below 0x80, so
+         * the tags can be found by scanning the raw bytes.
+         */
+        int start = 0;
+        for (int i = 0; linked && i <= tags_length; i++) {
+            if (i < tags_length && tags[i] != RECIPE_ARGUMENT && tags[i] != RECIPE_CONSTANT)
+                continue;
+
+            if (i > start)
+                concat_add_constant(recipe, string_data_from_utf8((char*) tags + start, i - start));
+            start = i + 1;
+
+            if (i == tags_length)
+                break;
+
+            if (tags[i] == RECIPE_ARGUMENT) {
+                linked = argument < descriptors->arguments_count &&
+                         concat_add_argument(recipe, &descriptors->arguments[argument++]);
+            } else {
+                StringData *data = NULL;
+                if (constant < bootstrap->num_bootstrap_arguments)
+                    data = concat_constant_from_pool(pool, bootstrap->bootstrap_arguments[constant++]);
+
+                linked = data != NULL;
+                if (linked)
+                    concat_add_constant(recipe, data);
+            }
+        }
+    }
+
+    if (argument != descriptors->arguments_count)
+        linked = false;
+
+    if (!linked) {
+        string_concat_free(recipe);
+        return NULL;
+    }
+
+    return recipe;
+}
+
+void string_concat_free(ConcatRecipe *recipe)
+{
+    if (!recipe)
+        return;
+
+    for (int i = 0; i < recipe->segments_count; i++) {
+        free(recipe->segments[i].constant);
+        free(recipe->segments[i].array_name);
+    }
+    free(recipe);
+}
+
+/* TODO: Throw a real java/lang/OutOfMemoryError once exceptions are
+ * implemented.
+ */
+static void concat_throw_overflow(void)
+{
+    fprintf(stderr, "Exception in thread \"main\" java.lang.OutOfMemoryError: "
+                    "Overflow: String length out of range\n");
+    exit(1);
+}
+
+/* Same as the default Object.toString() of an array. Arrays aren't Objects
+ * here, so this can't go through string_value_of().
+ */
+static Object *concat_array_string(Class *string_class, char *array_name, Array *array)
+{
+    if (!array)
+        return string_intern_utf8(string_class, "null", 4);
+
+    char buffer[512];
+    int length = snprintf(buffer, sizeof(buffer), "%s@%x", array_name, (uint32_t) object_identity_hash((Object*) array));
+    if (length >= (int) sizeof(buffer))
+        length = sizeof(buffer) - 1;
+
+    return string_new_utf8(string_class, buffer, length);
+}
+
+/* Pops the call site's arguments and pushes the concatenated string */
+void string_concat_execute(ConcatRecipe *recipe, Frame *frame)
+{
+    /* One extra slot keeps the arrays valid for zero arguments */
+    Variant arguments[recipe->arguments_count + 1];
+    StringData *strings[recipe->arguments_count + 1];
+
+    for (int i = recipe->arguments_count - 1; i >= 0; i--)
+        arguments[i] = stack_pop(frame->stack);
+
+    /* First pass: the exact length and coder of the result */
+    int64_t length = 0;
+    uint8_t coder = STRING_LATIN1;
+
+    for (int i = 0, argument = 0; i < recipe->segments_count; i++) {
+        ConcatSegment *segment = &recipe->segments[i];
+        Variant *value = &arguments[argument];
+
+        switch (segment->kind) {
+            case CONCAT_CONSTANT:
+                length += segment->constant->length;
+                coder |= segment->constant->coder;
+                continue;
+            case CONCAT_STRING:
+            case CONCAT_OBJECT:
+                strings[argument] = string_get_data(string_value_of(recipe->string_class, value->data.object));
+                length += strings[argument]->length;
+                coder |= strings[argument]->coder;
+                break;
+            case CONCAT_ARRAY:
+                strings[argument] = string_get_data(concat_array_string(recipe->string_class, segment->array_name,
+                                                                        (Array*) value->data.object));
+                length += strings[argument]->length;
+                break;
+            case CONCAT_INT:
+                length += number_int_length(value->data.int_val);
+                break;
+            case CONCAT_LONG:
+                length += number_long_length(value->data.long_val);
+                break;
+            case CONCAT_CHAR:
+                length += 1;
+                if ((uint16_t) value->data.int_val > 0xFF)
+                    coder = STRING_UTF16;
+                break;
+            case CONCAT_BOOLEAN:
+                length += value->data.int_val ? 4 : 5;
+                break;
+        }
+
+        argument++;
+    }
+
+    if (length > INT32_MAX)
+        concat_throw_overflow();
+
+    /* Second pass: copy every piece into place */
+    StringData *result = string_data_new(length, coder);
+    int offset = 0;
+
+    for (int i = 0, argument = 0; i < recipe->segments_count; i++) {
+        ConcatSegment *segment = &recipe->segments[i];
+        Variant *value = &arguments[argument];
+
+        switch (segment->kind) {
+            case CONCAT_CONSTANT:
+                string_data_copy(result, offset, segment->constant);
+                offset += segment->constant->length;
+                continue;
+            case CONCAT_STRING:
+            case CONCAT_OBJECT:
+            case CONCAT_ARRAY:
+                string_data_copy(result, offset, strings[argument]);
+                offset += strings[argument]->length;
+                break;
+            case CONCAT_INT:
+                if (coder == STRING_LATIN1) {
+                    offset += number_format_int(value->data.int_val, (char*) result->value + offset);
+                } else {
+                    char digits[12];
+                    int digits_length = number_format_int(value->data.int_val, digits);
+                    string_data_copy_ascii(result, offset, digits, digits_length);
+                    offset += digits_length;
+                }
+                break;
+            case CONCAT_LONG:
+                if (coder == STRING_LATIN1) {
+                    offset += number_format_long(value->data.long_val, (char*) result->value + offset);
+                } else {
+                    char digits[20];
+                    int digits_length = number_format_long(value->data.long_val, digits);
+                    string_data_copy_ascii(result, offset, digits, digits_length);
+                    offset += digits_length;
+                }
+                break;
+            case CONCAT_CHAR:
+                if (coder == STRING_LATIN1)
+                    result->value[offset] = value->data.int_val;
+                else
+                    ((uint16_t*) result->value)[offset] = value->data.int_val;
+                offset++;
+                break;
+            case CONCAT_BOOLEAN:
+                if (value->data.int_val) {
+                    string_data_copy_ascii(result, offset, "true", 4);
+                    offset += 4;
+                } else {
+                    string_data_copy_ascii(result, offset, "false", 5);
+                    offset += 5;
+                }
+                break;
+        }
+
+        argument++;
+    }
+
+    stack_push_object(frame->stack, string_new(recipe->string_class, result));
+}
 
 builtins java_lang_invoke_StringConcatFactory_builtins = {
     .parent = "java/lang/Object",
@@ -0,0 +1,272 @@
+/*
+ * This file is part of MiniJVM (https://github.com/muhammad23012009/minijvm)
+ * Copyright (c) 2025 Muhammad  <thevancedgamer@mentallysanemainliners.org>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <string.h>
+#include "builtins.h"
+#include "../array.h"
+
+/* java/util/ArrayList keeps its elements in an Array whose length is the
+ * capacity. The array grows by half each time it fills up, so adds are
+ * amortized O(1), and shifting or bulk copies are a single memmove.
+ */
+#define ARRAYLIST_DEFAULT_CAPACITY 10
+
+static inline ArrayListData *arraylist_get_data(Object *list)
+{
+    return list->fields[0]->value.data.ref;
+}
+
+/* TODO: Throw a real java/lang/IndexOutOfBoundsException once exceptions
+ * are implemented.
+ */
+static void arraylist_throw_out_of_bounds(int index, int size)
+{
+    fprintf(stderr, "Exception in thread \"main\" java.lang.IndexOutOfBoundsException: "
+                    "Index %d out of bounds for length %d\n", index, size);
+    exit(1);
+}
+
+static void arraylist_init(Object *list, int capacity)
+{
+    ArrayListData *data = malloc(sizeof(ArrayListData));
+    data->size = 0;
+    data->elements = array_new(classes_get_class(list->class->classes, "java/lang/Object"), capacity);
+
+    Field *value = list->fields[0];
+    value->value.type = VARIANT_TYPE_REF;
+    value->value.data.ref = data;
+
+    list->initialized = true;
+}
+
+static void arraylist_reserve(ArrayListData *list, int extra)
+{
+    int64_t needed = (int64_t) list->size + extra;
+    if (needed <= list->elements->count)
+        return;
+
+    if (needed > INT32_MAX) {
+        fprintf(stderr, "Exception in thread \"main\" java.lang.OutOfMemoryError: "
+                        "Requested array size exceeds VM limit\n");
+        exit(1);
+    }
+
+    int64_t capacity = list->elements->count + (list->elements->count >> 1);
+    if (capacity < needed)
+        capacity = needed;
+    if (capacity > INT32_MAX)
+        capacity = INT32_MAX;
+
+    array_resize(list->elements, capacity);
+}
+
+/* Arguments: None
+ * Returns: Void
+*/
+void java_util_ArrayList_init(Method *method, Frame *frame)
+{
+    arraylist_init(frame->locals[0].data.object, ARRAYLIST_DEFAULT_CAPACITY);
+}
+
+/* Arguments: Int
+ * Returns: Void
+*/
+void java_util_ArrayList_init_capacity(Method *method, Frame *frame)
+{
+    int capacity = frame->locals[1].data.int_val;
+    if (capacity < 0) {
+        fprintf(stderr, "Exception in thread \"main\" java.lang.IllegalArgumentException: "
+                        "Illegal Capacity: %d\n", capacity);
+        exit(1);
+    }
+
+    arraylist_init(frame->locals[0].data.object, capacity);
+}
+
+/* Arguments: Reference to java/lang/Object
+ * Returns: Boolean
+*/
+void java_util_ArrayList_add(Method *method, Frame *frame)
+{
+    ArrayListData *list = arraylist_get_data(frame->locals[0].data.object);
+
+    arraylist_reserve(list, 1);
+    list->elements->value[list->size++] = frame->locals[1];
+    stack_push_int(frame->stack, true);
+}
+
+/* Arguments: Int, Reference to java/lang/Object
+ * Returns: Void
+*/
+void java_util_ArrayList_add_at(Method *method, Frame *frame)
+{
+    ArrayListData *list = arraylist_get_data(frame->locals[0].data.object);
+    int index = frame->locals[1].data.int_val;
+
+    /* Adding at the very end is allowed */
+    if ((uint32_t) index > (uint32_t) list->size)
+        arraylist_throw_out_of_bounds(index, list->size);
+
+    arraylist_reserve(list, 1);
+
+    Variant *elements = list->elements->value;
+    memmove(elements + index + 1, elements + index, sizeof(Variant) * (list->size - index));
+    elements[index] = frame->locals[2];
+    list->size++;
+}
+
+/* Arguments: Int
+ * Returns: Reference to java/lang/Object
+*/
+void java_util_ArrayList_get(Method *method, Frame *frame)
+{
+    ArrayListData *list = arraylist_get_data(frame->locals[0].data.object);
+    int index = frame->locals[1].data.int_val;
+
+    if ((uint32_t) index >= (uint32_t) list->size)
+        arraylist_throw_out_of_bounds(index, list->size);
+
+    stack_push(frame->stack, list->elements->value[index]);
+}
+
+/* Arguments: Int, Reference to java/lang/Object
+ * Returns: Reference to java/lang/Object
+*/
+void java_util_ArrayList_set(Method *method, Frame *frame)
+{
+    ArrayListData *list = arraylist_get_data(frame->locals[0].data.object);
+    int index = frame->locals[1].data.int_val;
+
+    if ((uint32_t) index >= (uint32_t) list->size)
+        arraylist_throw_out_of_bounds(index, list->size);
+
+    stack_push(frame->stack, list->elements->value[index]);
+    list->elements->value[index] = frame->locals[2];
+}
+
+/* Arguments: Int
+ * Returns: Reference to java/lang/Object
+*/
+void java_util_ArrayList_remove(Method *method, Frame *frame)
+{
+    ArrayListData *list = arraylist_get_data(frame->locals[0].data.object);
+    int index = frame->locals[1].data.int_val;
+
+    if ((uint32_t) index >= (uint32_t) list->size)
+        arraylist_throw_out_of_bounds(index, list->size);
+
+    Variant *elements = list->elements->value;
+    stack_push(frame->stack, elements[index]);
+
+    list->size--;
+    memmove(elements + index, elements + index + 1, sizeof(Variant) * (list->size - index));
+    memset(elements + list->size, 0, sizeof(Variant));
+}
+
+/* Arguments: None
+ * Returns: Int
+*/
+void java_util_ArrayList_size(Method *method, Frame *frame)
+{
+    stack_push_int(frame->stack, arraylist_get_data(frame->locals[0].data.object)->size);
+}
+
+/* Arguments: None
+ * Returns: Boolean
+*/
+void java_util_ArrayList_isEmpty(Method *method, Frame *frame)
+{
+    stack_push_int(frame->stack, arraylist_get_data(frame->locals[0].data.object)->size == 0);
+}
+
+/* Arguments: None
+ * Returns: Void
+*/
+void java_util_ArrayList_clear(Method *method, Frame *frame)
+{
+    ArrayListData *list = arraylist_get_data(frame->locals[0].data.object);
+
+    memset(list->elements->value, 0, sizeof(Variant) * list->size);
+    list->size = 0;
+}
+
+/* Only other ArrayLists are supported, as they are the only collection.
+ *
+ * Arguments: Reference to java/util/Collection
+ * Returns: Boolean
+*/
+void java_util_ArrayList_addAll(Method *method, Frame *frame)
+{
+    Object *list_object = frame->locals[0].data.object;
+    Object *other_object = frame->locals[1].data.object;
+
+    if (!other_object || other_object->class != list_object->class) {
+        fprintf(stderr, "Exception in thread \"main\" java.lang.UnsupportedOperationException: "
+                        "addAll from %s\n", other_object ? other_object->class->name : "null");
+        exit(1);
+    }
+
+    ArrayListData *list = arraylist_get_data(list_object);
+    ArrayListData *other = arraylist_get_data(other_object);
+    int count = other->size;
+
+    /* Reserving first keeps this correct when adding a list to itself */
+    arraylist_reserve(list, count);
+    memcpy(list->elements->value + list->size, other->elements->value, sizeof(Variant) * count);
+    list->size += count;
+
+    stack_push_int(frame->stack, count != 0);
+}
+
+/* Arguments: None
+ * Returns: Array of java/lang/Object
+*/
+void java_util_ArrayList_toArray(Method *method, Frame *frame)
+{
+    ArrayListData *list = arraylist_get_data(frame->locals[0].data.object);
+    Array *array = array_new(list->elements->parent_class, list->size);
+
+    memcpy(array->value, list->elements->value, sizeof(Variant) * list->size);
+    stack_push_ref(frame->stack, array);
+}
+
+static builtin_fields fields[] = {
+    { "elementData", 0x0000 }, // handle ACC_PRIVATE later
+};
+
+static builtin_methods methods[] = {
+    { "<init>", "()V", 0, &java_util_ArrayList_init },
+    { "<init>", "(I)V", 0, &java_util_ArrayList_init_capacity },
+    { "add", "(Ljava/lang/Object;)Z", 1, &java_util_ArrayList_add },
+    { "add", "(ILjava/lang/Object;)V", 0, &java_util_ArrayList_add_at },
+    { "get", "(I)Ljava/lang/Object;", 1, &java_util_ArrayList_get },
+    { "set", "(ILjava/lang/Object;)Ljava/lang/Object;", 1, &java_util_ArrayList_set },
+    { "remove", "(I)Ljava/lang/Object;", 1, &java_util_ArrayList_remove },
+    { "size", "()I", 1, &java_util_ArrayList_size },
+    { "isEmpty", "()Z", 1, &java_util_ArrayList_isEmpty },
+    { "clear", "()V", 0, &java_util_ArrayList_clear },
+    { "addAll", "(Ljava/util/Collection;)Z", 1, &java_util_ArrayList_addAll },
+    { "toArray", "()[Ljava/lang/Object;", 1, &java_util_ArrayList_toArray },
+};
+
+builtins java_util_ArrayList_builtins = {
+    .parent = "java/lang/Object",
+    .fields = fields,
+    .fields_length = ARRAY_SIZE(fields),
+    .methods = methods,
+    .methods_length = ARRAY_SIZE(methods),
+};
\ No newline at end of file
@@ -0,0 +1,28 @@
+/*
+ * This file is part of MiniJVM (https://github.com/muhammad23012009/minijvm)
+ * Copyright (c) 2025 Muhammad  <thevancedgamer@mentallysanemainliners.org>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "builtins.h"
+
+/* Interfaces only need to exist, invokeinterface looks the method up on
+ * the receiver's class.
+ */
+builtins java_util_Collection_builtins = {
+    .parent = "java/lang/Object",
+    .fields = NULL,
+    .methods = NULL,
+    .methods_length = 0,
+};
\ No newline at end of file
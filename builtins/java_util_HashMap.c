@@ -0,0 +1,401 @@
+/*
+ * This file is part of MiniJVM (https://github.com/muhammad23012009/minijvm)
+ * Copyright (c) 2025 Muhammad  <thevancedgamer@mentallysanemainliners.org>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <string.h>
+#include "builtins.h"
+
+/* java/util/HashMap is an open addressing table using Robin Hood hashing:
+ * on insert, an entry that is further from its home slot takes the place
+ * of one that is closer. Probe runs stay short and sorted by distance, so
+ * a lookup can stop as soon as it passes where the key would have been.
+ *
+ * Every entry caches its key's hash. Growing the table never has to call
+ * hashCode() again, and most mismatches are rejected without calling
+ * equals(). String and Integer keys skip the Java calls entirely.
+ */
+
+#define HASHMAP_DEFAULT_CAPACITY 16
+
+/* At most 7/8 of the slots are in use */
+#define HASHMAP_MAX_LOAD(capacity) ((capacity) - (capacity) / 8)
+
+static inline HashMapData *hashmap_get_data(Object *map)
+{
+    return map->fields[0]->value.data.ref;
+}
+
+/* Fibonacci hashing spreads the bits, so weak hashCode()s such as small
+ * Integers don't pile up in neighbouring slots.
+ */
+static inline uint32_t hashmap_home(HashMapData *map, int32_t hash)
+{
+    return ((uint32_t) hash * 0x9E3779B9u) >> map->shift;
+}
+
+static void hashmap_allocate(HashMapData *map, uint32_t capacity)
+{
+    map->capacity = capacity;
+    map->shift = 32 - __builtin_ctz(capacity);
+    map->entries = calloc(capacity, sizeof(HashMapEntry));
+}
+
+static int32_t hashmap_hash(HashMapData *map, Object *key)
+{
+    if (!key)
+        return 0;
+
+    if (key->class == map->string_class)
+        return string_data_hash(string_get_data(key));
+
+    /* The boxed int is the only field of java/lang/Integer */
+    if (key->class == map->integer_class)
+        return key->fields[0]->value.data.int_val;
+
+    Method *hash_code = class_find_method(key->class, "hashCode", "()I");
+    Variant this = { .type = VARIANT_TYPE_OBJECT, .data.object = key };
+    return method_call(hash_code, &this, true).data.int_val;
+}
+
+/* Only called once the cached hashes match */
+static bool hashmap_keys_equal(HashMapData *map, Object *key, Object *other)
+{
+    if (key == other)
+        return true;
+
+    if (!key || !other)
+        return false;
+
+    if (key->class == map->string_class) {
+        return other->class == map->string_class &&
+               string_data_equals(string_get_data(key), string_get_data(other));
+    }
+
+    if (key->class == map->integer_class) {
+        return other->class == map->integer_class &&
+               key->fields[0]->value.data.int_val == other->fields[0]->value.data.int_val;
+    }
+
+    Method *equals = class_find_method(key->class, "equals", "(Ljava/lang/Object;)Z");
+    Variant args[] = {
+        { .type = VARIANT_TYPE_OBJECT, .data.object = key },
+        { .type = VARIANT_TYPE_OBJECT, .data.object = other },
+    };
+    return method_call(equals, args, true).data.int_val;
+}
+
+static HashMapEntry *hashmap_find(HashMapData *map, Object *key, int32_t hash)
+{
+    uint32_t mask = map->capacity - 1;
+    uint32_t index = hashmap_home(map, hash);
+
+    for (uint32_t distance = 1;; distance++, index = (index + 1) & mask) {
+        HashMapEntry *entry = &map->entries[index];
+
+        /* Also true for empty slots */
+        if (entry->distance < distance)
+            return NULL;
+
+        if (entry->hash == hash && hashmap_keys_equal(map, key, entry->key))
+            return entry;
+    }
+}
+
+/* The key must not be in the map yet, and there must be a free slot */
+static void hashmap_insert_new(HashMapData *map, int32_t hash, Object *key, Variant value)
+{
+    uint32_t mask = map->capacity - 1;
+    uint32_t index = hashmap_home(map, hash);
+    HashMapEntry entry = { 1, hash, key, value };
+
+    for (;; entry.distance++, index = (index + 1) & mask) {
+        HashMapEntry *slot = &map->entries[index];
+        if (!slot->distance) {
+            *slot = entry;
+            map->count++;
+            return;
+        }
+
+        if (slot->distance < entry.distance) {
+            HashMapEntry displaced = *slot;
+            *slot = entry;
+            entry = displaced;
+        }
+    }
+}
+
+/* Rehashing only needs the cached hashes */
+static void hashmap_grow(HashMapData *map)
+{
+    HashMapEntry *entries = map->entries;
+    uint32_t capacity = map->capacity;
+
+    hashmap_allocate(map, capacity * 2);
+    map->count = 0;
+
+    for (uint32_t i = 0; i < capacity; i++) {
+        if (entries[i].distance)
+            hashmap_insert_new(map, entries[i].hash, entries[i].key, entries[i].value);
+    }
+
+    free(entries);
+}
+
+/* Hashes every key again, for keys whose hashes may have changed since
+ * they were inserted, such as restored objects hashed by identity. Any
+ * slot with a nonzero distance counts as an entry.
+ */
+void hashmap_rehash(HashMapData *map)
+{
+    HashMapEntry *entries = map->entries;
+    uint32_t capacity = map->capacity;
+
+    hashmap_allocate(map, capacity);
+    map->count = 0;
+
+    for (uint32_t i = 0; i < capacity; i++) {
+        if (entries[i].distance)
+            hashmap_insert_new(map, hashmap_hash(map, entries[i].key), entries[i].key, entries[i].value);
+    }
+
+    free(entries);
+}
+
+/* Shifts the rest of the probe run back by one, so no tombstones are needed */
+static void hashmap_remove_entry(HashMapData *map, HashMapEntry *entry)
+{
+    uint32_t mask = map->capacity - 1;
+    uint32_t index = entry - map->entries;
+
+    for (;;) {
+        HashMapEntry *next = &map->entries[(index + 1) & mask];
+        if (next->distance <= 1)
+            break;
+
+        map->entries[index] = *next;
+        map->entries[index].distance--;
+        index = (index + 1) & mask;
+    }
+
+    memset(&map->entries[index], 0, sizeof(HashMapEntry));
+    map->count--;
+}
+
+static void hashmap_init(Object *object, uint32_t expected)
+{
+    HashMapData *map = malloc(sizeof(HashMapData));
+    Classes *classes = object->class->classes;
+
+    uint32_t capacity = HASHMAP_DEFAULT_CAPACITY;
+    while (HASHMAP_MAX_LOAD(capacity) < expected && capacity < (1u << 30))
+        capacity *= 2;
+
+    map->count = 0;
+    hashmap_allocate(map, capacity);
+    map->string_class = classes_get_class(classes, "java/lang/String");
+    map->integer_class = classes_get_class(classes, "java/lang/Integer");
+
+    Field *value = object->fields[0];
+    value->value.type = VARIANT_TYPE_REF;
+    value->value.data.ref = map;
+
+    object->initialized = true;
+}
+
+static void hashmap_push_value(Frame *frame, HashMapEntry *entry)
+{
+    if (entry) {
+        stack_push(frame->stack, entry->value);
+    } else {
+        Variant null = { .type = VARIANT_TYPE_OBJECT, .data.object = NULL };
+        stack_push(frame->stack, null);
+    }
+}
+
+/* Arguments: None
+ * Returns: Void
+*/
+void java_util_HashMap_init(Method *method, Frame *frame)
+{
+    hashmap_init(frame->locals[0].data.object, 0);
+}
+
+/* Arguments: Int
+ * Returns: Void
+*/
+void java_util_HashMap_init_capacity(Method *method, Frame *frame)
+{
+    int capacity = frame->locals[1].data.int_val;
+    if (capacity < 0) {
+        fprintf(stderr, "Exception in thread \"main\" java.lang.IllegalArgumentException: "
+                        "Illegal initial capacity: %d\n", capacity);
+        exit(1);
+    }
+
+    hashmap_init(frame->locals[0].data.object, capacity);
+}
+
+/* Arguments: Reference to java/lang/Object, Reference to java/lang/Object
+ * Returns: Reference to java/lang/Object
+*/
+void java_util_HashMap_put(Method *method, Frame *frame)
+{
+    HashMapData *map = hashmap_get_data(frame->locals[0].data.object);
+    Object *key = frame->locals[1].data.object;
+    Variant value = frame->locals[2];
+
+    int32_t hash = hashmap_hash(map, key);
+    HashMapEntry *entry = hashmap_find(map, key, hash);
+    if (entry) {
+        stack_push(frame->stack, entry->value);
+        entry->value = value;
+        return;
+    }
+
+    if (map->count + 1 > HASHMAP_MAX_LOAD(map->capacity))
+        hashmap_grow(map);
+
+    hashmap_insert_new(map, hash, key, value);
+    hashmap_push_value(frame, NULL);
+}
+
+/* Arguments: Reference to java/lang/Object, Reference to java/lang/Object
+ * Returns: Reference to java/lang/Object
+*/
+void java_util_HashMap_putIfAbsent(Method *method, Frame *frame)
+{
+    HashMapData *map = hashmap_get_data(frame->locals[0].data.object);
+    Object *key = frame->locals[1].data.object;
+    Variant value = frame->locals[2];
+
+    int32_t hash = hashmap_hash(map, key);
+    HashMapEntry *entry = hashmap_find(map, key, hash);
+    if (entry && entry->value.data.object) {
+        stack_push(frame->stack, entry->value);
+        return;
+    }
+
+    if (entry) {
+        entry->value = value;
+    } else {
+        if (map->count + 1 > HASHMAP_MAX_LOAD(map->capacity))
+            hashmap_grow(map);
+        hashmap_insert_new(map, hash, key, value);
+    }
+
+    hashmap_push_value(frame, NULL);
+}
+
+/* Arguments: Reference to java/lang/Object
+ * Returns: Reference to java/lang/Object
+*/
+void java_util_HashMap_get(Method *method, Frame *frame)
+{
+    HashMapData *map = hashmap_get_data(frame->locals[0].data.object);
+    Object *key = frame->locals[1].data.object;
+
+    hashmap_push_value(frame, hashmap_find(map, key, hashmap_hash(map, key)));
+}
+
+/* Arguments: Reference to java/lang/Object, Reference to java/lang/Object
+ * Returns: Reference to java/lang/Object
+*/
+void java_util_HashMap_getOrDefault(Method *method, Frame *frame)
+{
+    HashMapData *map = hashmap_get_data(frame->locals[0].data.object);
+    Object *key = frame->locals[1].data.object;
+
+    HashMapEntry *entry = hashmap_find(map, key, hashmap_hash(map, key));
+    stack_push(frame->stack, entry ? entry->value : frame->locals[2]);
+}
+
+/* Arguments: Reference to java/lang/Object
+ * Returns: Boolean
+*/
+void java_util_HashMap_containsKey(Method *method, Frame *frame)
+{
+    HashMapData *map = hashmap_get_data(frame->locals[0].data.object);
+    Object *key = frame->locals[1].data.object;
+
+    stack_push_int(frame->stack, hashmap_find(map, key, hashmap_hash(map, key)) != NULL);
+}
+
+/* Arguments: Reference to java/lang/Object
+ * Returns: Reference to java/lang/Object
+*/
+void java_util_HashMap_remove(Method *method, Frame *frame)
+{
+    HashMapData *map = hashmap_get_data(frame->locals[0].data.object);
+    Object *key = frame->locals[1].data.object;
+
+    HashMapEntry *entry = hashmap_find(map, key, hashmap_hash(map, key));
+    hashmap_push_value(frame, entry);
+    if (entry)
+        hashmap_remove_entry(map, entry);
+}
+
+/* Arguments: None
+ * Returns: Int
+*/
+void java_util_HashMap_size(Method *method, Frame *frame)
+{
+    stack_push_int(frame->stack, hashmap_get_data(frame->locals[0].data.object)->count);
+}
+
+/* Arguments: None
+ * Returns: Boolean
+*/
+void java_util_HashMap_isEmpty(Method *method, Frame *frame)
+{
+    stack_push_int(frame->stack, hashmap_get_data(frame->locals[0].data.object)->count == 0);
+}
+
+/* Arguments: None
+ * Returns: Void
+*/
+void java_util_HashMap_clear(Method *method, Frame *frame)
+{
+    HashMapData *map = hashmap_get_data(frame->locals[0].data.object);
+
+    memset(map->entries, 0, sizeof(HashMapEntry) * map->capacity);
+    map->count = 0;
+}
+
+static builtin_fields fields[] = {
+    { "table", 0x0000 }, // handle ACC_PRIVATE later
+};
+
+static builtin_methods methods[] = {
+    { "<init>", "()V", 0, &java_util_HashMap_init },
+    { "<init>", "(I)V", 0, &java_util_HashMap_init_capacity },
+    { "put", "(Ljava/lang/Object;Ljava/lang/Object;)Ljava/lang/Object;", 1, &java_util_HashMap_put },
+    { "putIfAbsent", "(Ljava/lang/Object;Ljava/lang/Object;)Ljava/lang/Object;", 1, &java_util_HashMap_putIfAbsent },
+    { "get", "(Ljava/lang/Object;)Ljava/lang/Object;", 1, &java_util_HashMap_get },
+    { "getOrDefault", "(Ljava/lang/Object;Ljava/lang/Object;)Ljava/lang/Object;", 1, &java_util_HashMap_getOrDefault },
+    { "containsKey", "(Ljava/lang/Object;)Z", 1, &java_util_HashMap_containsKey },
+    { "remove", "(Ljava/lang/Object;)Ljava/lang/Object;", 1, &java_util_HashMap_remove },
+    { "size", "()I", 1, &java_util_HashMap_size },
+    { "isEmpty", "()Z", 1, &java_util_HashMap_isEmpty },
+    { "clear", "()V", 0, &java_util_HashMap_clear },
+};
+
+builtins java_util_HashMap_builtins = {
+    .parent = "java/lang/Object",
+    .fields = fields,
+    .fields_length = ARRAY_SIZE(fields),
+    .methods = methods,
+    .methods_length = ARRAY_SIZE(methods),
+};
\ No newline at end of file
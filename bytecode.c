@@ -0,0 +1,393 @@
+/*
+ * This file is part of MiniJVM (https://github.com/muhammad23012009/minijvm)
+ * Copyright (c) 2025 Muhammad  <thevancedgamer@mentallysanemainliners.org>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "bytecode.h"
+
+/* Lengths of fixed-size instructions, including the opcode itself.
+ * Variable-length instructions (switches and wide) are left as 0. Each
+ * opcode is listed once, in order.
+ */
+static const uint8_t instruction_lengths[256] = {
+    [0x00 ... 0x0F] = 1,    /* nop, constants */
+    [OP_BIPUSH] = 2,
+    [OP_SIPUSH] = 3,
+    [OP_LDC] = 2,
+    [OP_LDC_W ... OP_LDC2_W] = 3,
+    [OP_ILOAD ... OP_ALOAD] = 2,
+    [0x1A ... 0x35] = 1,    /* <x>load_<n>, <x>aload */
+    [OP_ISTORE ... OP_ASTORE] = 2,
+    [0x3B ... 0x83] = 1,    /* <x>store_<n>, <x>astore, stack, arithmetic */
+    [OP_IINC] = 3,
+    [0x85 ... 0x98] = 1,    /* conversions, comparisons */
+    [0x99 ... 0xA8] = 3,    /* if<cond>, if_icmp<cond>, if_acmp<cond>, goto, jsr */
+    [0xA9] = 2,             /* ret */
+    [OP_IRETURN ... OP_RETURN] = 1,
+    [OP_GETSTATIC ... OP_INVOKESTATIC] = 3,
+    [OP_INVOKEINTERFACE ... OP_INVOKEDYNAMIC] = 5,
+    [OP_NEW] = 3,
+    [0xBC] = 2,             /* newarray */
+    [OP_ANEWARRAY] = 3,
+    [OP_ARRAYLENGTH ... 0xBF] = 1,  /* arraylength, athrow */
+    [OP_CHECKCAST ... OP_INSTANCEOF] = 3,
+    [0xC2 ... 0xC3] = 1,    /* monitorenter, monitorexit */
+    [OP_MULTIANEWARRAY] = 4,
+    [OP_IFNULL ... OP_IFNONNULL] = 3,
+    [OP_GOTO_W ... OP_JSR_W] = 5,
+    [OP_AALOAD_UNCHECKED] = 1,
+    [OP_AASTORE_UNCHECKED] = 1,
+};
+
+typedef struct Edge {
+    uint32_t from;
+    uint32_t to;
+} Edge;
+
+typedef struct Analysis {
+    uint8_t *code;
+    uint32_t length;
+
+    /* Length of the instruction starting at each pc, 0 if none does */
+    uint32_t *lengths;
+    /* Non-zero if any branch lands on this pc */
+    uint8_t *targets;
+
+    int edges_count;
+    int edges_capacity;
+    Edge *edges;
+} Analysis;
+
+static int16_t read_s16(uint8_t *ptr)
+{
+    return (int16_t) ((ptr[0] << 8) | ptr[1]);
+}
+
+static int32_t read_s32(uint8_t *ptr)
+{
+    return (int32_t) (((uint32_t) ptr[0] << 24) | (ptr[1] << 16) | (ptr[2] << 8) | ptr[3]);
+}
+
+int bytecode_instruction_length(uint8_t *code, uint32_t length, uint32_t pc)
+{
+    int64_t len = instruction_lengths[code[pc]];
+
+    switch (code[pc]) {
+        case OP_TABLESWITCH: {
+            /* Operands start at the next 4-byte aligned offset */
+            uint32_t base = (pc + 4) & ~3;
+            if (base + 12 > length)
+                return 0;
+
+            int32_t low = read_s32(&code[base + 4]);
+            int32_t high = read_s32(&code[base + 8]);
+            if (high < low)
+                return 0;
+
+            len = (base - pc) + 12 + ((int64_t) high - low + 1) * 4;
+            break;
+        }
+        case OP_LOOKUPSWITCH: {
+            uint32_t base = (pc + 4) & ~3;
+            if (base + 8 > length)
+                return 0;
+
+            int32_t npairs = read_s32(&code[base + 4]);
+            if (npairs < 0)
+                return 0;
+
+            len = (base - pc) + 8 + (int64_t) npairs * 8;
+            break;
+        }
+        case OP_WIDE:
+            if (pc + 1 >= length)
+                return 0;
+            len = code[pc + 1] == OP_IINC ? 6 : 4;
+            break;
+    }
+
+    if (len == 0 || pc + len > length)
+        return 0;
+
+    return len;
+}
+
+static bool analysis_add_edge(Analysis *a, uint32_t from, int64_t to)
+{
+    if (to < 0 || to >= a->length)
+        return false;
+
+    if (a->edges_count == a->edges_capacity) {
+        a->edges_capacity = a->edges_capacity ? a->edges_capacity * 2 : 16;
+        a->edges = realloc(a->edges, sizeof(Edge) * a->edges_capacity);
+    }
+
+    a->edges[a->edges_count++] = (Edge) { from, to };
+    a->targets[to] = 1;
+    return true;
+}
+
+/* Decodes every instruction and records all branch edges */
+static bool analysis_decode(Analysis *a)
+{
+    uint8_t *code = a->code;
+
+    for (uint32_t pc = 0; pc < a->length;) {
+        int len = bytecode_instruction_length(code, a->length, pc);
+        if (!len)
+            return false;
+
+        a->lengths[pc] = len;
+
+        uint8_t op = code[pc];
+        bool ok = true;
+        if ((op >= OP_IFEQ && op <= OP_JSR) || op == OP_IFNULL || op == OP_IFNONNULL) {
+            ok = analysis_add_edge(a, pc, (int64_t) pc + read_s16(&code[pc + 1]));
+        } else if (op == OP_GOTO_W || op == OP_JSR_W) {
+            ok = analysis_add_edge(a, pc, (int64_t) pc + read_s32(&code[pc + 1]));
+        } else if (op == OP_TABLESWITCH || op == OP_LOOKUPSWITCH) {
+            uint8_t *base = &code[(pc + 4) & ~3];
+            int count, stride;
+
+            if (op == OP_TABLESWITCH) {
+                count = read_s32(base + 8) - read_s32(base + 4) + 1;
+                base += 12;
+                stride = 4;
+            } else {
+                count = read_s32(base + 4);
+                /* Skip the match value of each pair */
+                base += 12;
+                stride = 8;
+            }
+
+            ok = analysis_add_edge(a, pc, (int64_t) pc + read_s32(&code[(pc + 4) & ~3]));
+            for (int i = 0; ok && i < count; i++)
+                ok = analysis_add_edge(a, pc, (int64_t) pc + read_s32(base + i * stride));
+        }
+
+        if (!ok)
+            return false;
+
+        pc += len;
+    }
+
+    return true;
+}
+
+/* Decodes `<op> n` and its `<op>_<n>` short forms, returning the local index or -1 */
+static int decode_local(uint8_t *code, uint32_t pc, uint8_t op, uint8_t short_op)
+{
+    if (code[pc] == op)
+        return code[pc + 1];
+
+    if (code[pc] >= short_op && code[pc] <= short_op + 3)
+        return code[pc] - short_op;
+
+    return -1;
+}
+
+static bool is_non_negative_constant(uint8_t *code, uint32_t pc)
+{
+    switch (code[pc]) {
+        case OP_ICONST_0 ... OP_ICONST_5:
+            return true;
+        case OP_BIPUSH:
+            return (int8_t) code[pc + 1] >= 0;
+        case OP_SIPUSH:
+            return read_s16(&code[pc + 1]) >= 0;
+        default:
+            return false;
+    }
+}
+
+/* A reference push that does not touch the operand stack otherwise */
+static bool is_simple_reference_push(uint8_t *code, uint32_t pc)
+{
+    return code[pc] == 0x01 /* aconst_null */ ||
+           code[pc] == 0x12 /* ldc */ ||
+           decode_local(code, pc, OP_ALOAD, OP_ALOAD_0) >= 0;
+}
+
+static int64_t previous_instruction(Analysis *a, uint32_t pc)
+{
+    while (pc > 0) {
+        pc--;
+        if (a->lengths[pc])
+            return pc;
+    }
+
+    return -1;
+}
+
+/* Walks the loop body. Returns false if anything in it can invalidate the
+ * loop condition. If `rewrite` is set, the provably safe accesses are
+ * replaced by their unchecked variants.
+ */
+static bool scan_loop_body(Analysis *a, uint32_t start, uint32_t end, int index_local, int array_local,
+                           bool rewrite, int *rewritten)
+{
+    uint8_t *code = a->code;
+    bool incremented = false;
+
+    for (uint32_t pc = start; pc < end; pc += a->lengths[pc]) {
+        uint8_t op = code[pc];
+
+        if (op == OP_WIDE || op == OP_JSR || op == OP_JSR_W)
+            return false;
+
+        if (decode_local(code, pc, OP_ISTORE, OP_ISTORE_0) == index_local ||
+            decode_local(code, pc, OP_ASTORE, OP_ASTORE_0) == array_local)
+            return false;
+
+        if (op == OP_IINC && code[pc + 1] == index_local) {
+            /* Only a unit step is guaranteed not to overflow past the length */
+            if ((int8_t) code[pc + 2] != 1)
+                return false;
+
+            /* Accesses after the increment may be one past the end */
+            incremented = true;
+            continue;
+        }
+
+        if (incremented || !rewrite)
+            continue;
+
+        /* Look for `aload A; iload I; aaload` and `aload A; iload I; <push>; aastore` */
+        if (decode_local(code, pc, OP_ALOAD, OP_ALOAD_0) != array_local)
+            continue;
+
+        uint32_t next = pc + a->lengths[pc];
+        if (next >= end || a->targets[next] || decode_local(code, next, OP_ILOAD, OP_ILOAD_0) != index_local)
+            continue;
+
+        next += a->lengths[next];
+        if (next >= end || a->targets[next])
+            continue;
+
+        if (code[next] == OP_AALOAD) {
+            code[next] = OP_AALOAD_UNCHECKED;
+            (*rewritten)++;
+        } else if (is_simple_reference_push(code, next)) {
+            next += a->lengths[next];
+            if (next < end && !a->targets[next] && code[next] == OP_AASTORE) {
+                code[next] = OP_AASTORE_UNCHECKED;
+                (*rewritten)++;
+            }
+        }
+    }
+
+    return true;
+}
+
+/* Checks whether the loop closed by the `goto` at `back_edge` is a counted
+ * loop of the shape javac emits for `for (i = 0; i < a.length; i++)`:
+ *
+ *     iconst_0; istore I
+ *   header:
+ *     iload I; aload A; arraylength; if_icmpge exit
+ *     ...body...
+ *     iinc I, 1
+ *     goto header
+ *   exit:
+ *
+ * Inside such a loop, 0 <= I < A.length holds until I is incremented.
+ */
+static int eliminate_in_loop(Analysis *a, uint32_t header, uint32_t back_edge)
+{
+    uint8_t *code = a->code;
+    uint32_t pc = header;
+    int index_local, array_local, rewritten = 0;
+
+    if ((index_local = decode_local(code, pc, OP_ILOAD, OP_ILOAD_0)) < 0)
+        return 0;
+    pc += a->lengths[pc];
+
+    if (pc >= back_edge || (array_local = decode_local(code, pc, OP_ALOAD, OP_ALOAD_0)) < 0)
+        return 0;
+    pc += a->lengths[pc];
+
+    if (pc >= back_edge || code[pc] != OP_ARRAYLENGTH)
+        return 0;
+    pc += a->lengths[pc];
+
+    if (pc >= back_edge || code[pc] != OP_IF_ICMPGE || pc + read_s16(&code[pc + 1]) != back_edge + 3)
+        return 0;
+    pc += a->lengths[pc];
+
+    /* The index must be initialized to a non-negative constant right before the loop */
+    int64_t store = previous_instruction(a, header);
+    if (store < 0 || a->targets[store] || decode_local(code, store, OP_ISTORE, OP_ISTORE_0) != index_local)
+        return 0;
+
+    int64_t init = previous_instruction(a, store);
+    if (init < 0 || !is_non_negative_constant(code, init))
+        return 0;
+
+    /* The loop can only be entered through its header, and only the back
+     * edge may jump back to it. Branches inside the body must go forward so
+     * that the increment is never followed by an access on any path.
+     */
+    for (int i = 0; i < a->edges_count; i++) {
+        Edge *e = &a->edges[i];
+        if (e->to < header || e->to > back_edge)
+            continue;
+
+        if (e->to == header) {
+            if (e->from != back_edge)
+                return 0;
+        } else if (e->from < header || e->from > back_edge || e->to <= e->from) {
+            return 0;
+        }
+    }
+
+    if (!scan_loop_body(a, pc, back_edge, index_local, array_local, false, &rewritten))
+        return 0;
+
+    scan_loop_body(a, pc, back_edge, index_local, array_local, true, &rewritten);
+    return rewritten;
+}
+
+int bytecode_eliminate_bounds_checks(uint8_t *code, uint32_t length)
+{
+    Analysis a;
+    int rewritten = 0;
+
+    if (!code || !length)
+        return 0;
+
+    memset(&a, 0, sizeof(a));
+    a.code = code;
+    a.length = length;
+    a.lengths = calloc(length, sizeof(uint32_t));
+    a.targets = calloc(length, sizeof(uint8_t));
+
+    if (analysis_decode(&a)) {
+        for (int i = 0; i < a.edges_count; i++) {
+            Edge *e = &a.edges[i];
+            /* Only backward unconditional jumps close a loop */
+            if (code[e->from] == OP_GOTO && e->to < e->from)
+                rewritten += eliminate_in_loop(&a, e->to, e->from);
+        }
+    }
+
+    free(a.lengths);
+    free(a.targets);
+    free(a.edges);
+
+    return rewritten;
+}
@@ -0,0 +1,129 @@
+/*
+ * This file is part of MiniJVM (https://github.com/muhammad23012009/minijvm)
+ * Copyright (c) 2025 Muhammad  <thevancedgamer@mentallysanemainliners.org>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef BYTECODE_H
+#define BYTECODE_H
+
+/* Static analysis and rewriting of method bytecode. This runs once per
+ * method when it is prepared, before it is ever executed.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Opcodes we need to recognize during analysis and translation */
+#define OP_ACONST_NULL  0x01
+#define OP_ICONST_M1    0x02
+#define OP_ICONST_0     0x03
+#define OP_ICONST_5     0x08
+#define OP_LCONST_0     0x09
+#define OP_LCONST_1     0x0A
+#define OP_BIPUSH       0x10
+#define OP_SIPUSH       0x11
+#define OP_LDC          0x12
+#define OP_LDC_W        0x13
+#define OP_LDC2_W       0x14
+#define OP_ILOAD        0x15
+#define OP_LLOAD        0x16
+#define OP_ALOAD        0x19
+#define OP_ILOAD_0      0x1A
+#define OP_ILOAD_3      0x1D
+#define OP_LLOAD_0      0x1E
+#define OP_LLOAD_3      0x21
+#define OP_ALOAD_0      0x2A
+#define OP_ALOAD_3      0x2D
+#define OP_AALOAD       0x32
+#define OP_ISTORE       0x36
+#define OP_LSTORE       0x37
+#define OP_ASTORE       0x3A
+#define OP_ISTORE_0     0x3B
+#define OP_ISTORE_3     0x3E
+#define OP_LSTORE_0     0x3F
+#define OP_LSTORE_3     0x42
+#define OP_ASTORE_0     0x4B
+#define OP_ASTORE_3     0x4E
+#define OP_AASTORE      0x53
+#define OP_POP          0x57
+#define OP_DUP          0x59
+#define OP_IADD         0x60
+#define OP_LADD         0x61
+#define OP_IINC         0x84
+#define OP_I2L          0x85
+#define OP_L2I          0x88
+#define OP_IFEQ         0x99
+#define OP_IFLE         0x9E
+#define OP_IF_ICMPEQ    0x9F
+#define OP_IF_ICMPGE    0xA2
+#define OP_IF_ICMPLE    0xA4
+#define OP_IF_ACMPEQ    0xA5
+#define OP_IF_ACMPNE    0xA6
+#define OP_GOTO         0xA7
+#define OP_JSR          0xA8
+#define OP_TABLESWITCH  0xAA
+#define OP_LOOKUPSWITCH 0xAB
+#define OP_IRETURN      0xAC
+#define OP_LRETURN      0xAD
+#define OP_ARETURN      0xB0
+#define OP_RETURN       0xB1
+#define OP_GETSTATIC    0xB2
+#define OP_PUTSTATIC    0xB3
+#define OP_GETFIELD     0xB4
+#define OP_PUTFIELD     0xB5
+#define OP_INVOKEVIRTUAL 0xB6
+#define OP_INVOKESPECIAL 0xB7
+#define OP_INVOKESTATIC 0xB8
+#define OP_INVOKEINTERFACE 0xB9
+#define OP_INVOKEDYNAMIC 0xBA
+#define OP_NEW          0xBB
+#define OP_ANEWARRAY    0xBD
+#define OP_ARRAYLENGTH  0xBE
+#define OP_CHECKCAST    0xC0
+#define OP_INSTANCEOF   0xC1
+#define OP_WIDE         0xC4
+#define OP_MULTIANEWARRAY 0xC5
+#define OP_IFNULL       0xC6
+#define OP_IFNONNULL    0xC7
+#define OP_GOTO_W       0xC8
+#define OP_JSR_W        0xC9
+
+/* Internal opcodes. These never appear in class files, the preparation
+ * step rewrites regular opcodes into them once it has proven something
+ * about the instruction.
+ */
+#define OP_AALOAD_UNCHECKED     0xCB
+#define OP_AASTORE_UNCHECKED    0xCC
+
+/* Big endian operands, `code` points at their first byte */
+static inline uint16_t code_u16(const uint8_t *code)
+{
+    return (code[0] << 8) | code[1];
+}
+
+static inline int16_t code_s16(const uint8_t *code)
+{
+    return (int16_t) code_u16(code);
+}
+
+/* Returns the length of the instruction at `pc`, or 0 if it is malformed */
+extern int bytecode_instruction_length(uint8_t *code, uint32_t length, uint32_t pc);
+
+/* Rewrites array accesses inside counted loops into unchecked variants.
+ * Returns the number of rewritten instructions.
+ */
+extern int bytecode_eliminate_bounds_checks(uint8_t *code, uint32_t length);
+
+#endif
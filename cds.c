@@ -0,0 +1,699 @@
+/*
+ * This file is part of MiniJVM (https://github.com/muhammad23012009/minijvm)
+ * Copyright (c) 2025 Muhammad  <thevancedgamer@mentallysanemainliners.org>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "cds.h"
+#include "attribute.h"
+#include "hash.h"
+#include "hashtable.h"
+
+#define ARCHIVE_MAGIC       0x41534A4D  /* "MJSA" */
+#define ARCHIVE_VERSION     7
+
+/* Regions are aligned to the largest page size we expect to run on */
+#define ARCHIVE_ALIGNMENT   0x10000
+
+/* Well away from the heap and shared libraries, and free in most processes */
+#define ARCHIVE_BASE        (sizeof(void*) == 8 ? (uint64_t) 0x800000000 : (uint64_t) 0x50000000)
+
+#ifndef MAP_FIXED_NOREPLACE
+#define MAP_FIXED_NOREPLACE 0
+#endif
+
+#define ALIGN_UP(value, alignment) (((value) + (alignment) - 1) & ~((size_t) (alignment) - 1))
+
+/* The header has no pointers. Offsets are from the start of the file,
+ * which is also the start of the mapping.
+ */
+typedef struct ArchiveHeader {
+    uint32_t magic;
+    uint32_t version;
+    /* Catches archives written by a build with different struct layouts */
+    uint32_t layout;
+    /* Catches archives dumped with a different class path */
+    uint32_t classpath_stamp;
+    uint64_t base;
+
+    uint64_t rw_offset, rw_size;
+    uint64_t ro_offset, ro_size;
+    /* One bit for every pointer-sized word of the image that holds a pointer */
+    uint64_t bitmap_offset, bitmap_size;
+
+    /* Open addressing array of Class pointers, by name */
+    uint64_t classes_offset;
+    uint32_t classes_capacity;
+    uint32_t classes_count;
+    /* classpath_class_stamp of each class when dumped, parallel to the classes */
+    uint64_t stamps_offset;
+    /* Array of every archived Symbol pointer */
+    uint64_t symbols_offset;
+    uint32_t symbols_count;
+} ArchiveHeader;
+
+/* Everything the VM may write to goes to the read-write region */
+typedef enum Region {
+    REGION_RW,
+    REGION_RO,
+    REGION_COUNT,
+} Region;
+
+typedef struct Buffer {
+    uint8_t *data;
+    size_t size;
+    size_t capacity;
+} Buffer;
+
+/* A pointer at `offset` into `region`, to `target` in `target_region` */
+typedef struct Fixup {
+    Region region;
+    Region target_region;
+    size_t offset;
+    size_t target;
+} Fixup;
+
+/* Open addressing map of symbols already copied to their offset, kept at
+ * most half full
+ */
+typedef struct CopiedSymbol {
+    Symbol *symbol;
+    size_t offset;
+} CopiedSymbol;
+
+
+typedef struct Builder {
+    Buffer regions[REGION_COUNT];
+
+    size_t fixups_count;
+    size_t fixups_capacity;
+    Fixup *fixups;
+
+    /* Both hold CopiedSymbol. Descriptors are interned, so each is copied
+     * once too, by its symbol
+     */
+    HashTable symbols;
+    HashTable descriptors;
+} Builder;
+
+static struct {
+    uint8_t *base;
+    size_t size;
+    /* Holds Class pointers, mapped with the rest of the archive */
+    HashTable classes;
+    uint32_t *stamps;
+} archive;
+
+static uint32_t archive_layout(void)
+{
+    uint64_t sizes[] = {
+        sizeof(void*), sizeof(Class), sizeof(Method), sizeof(Field), sizeof(struct BootstrapMethod),
+        sizeof(ConstantPool), sizeof(Descriptors), sizeof(Descriptor),
+        sizeof(Symbol), sizeof(MemberIndexEntry), HASH_SEED,
+    };
+
+    return hash_bytes(sizes, sizeof(sizes));
+}
+
+/* Returns the offset of `size` zeroed bytes. Earlier pointers into the
+ * region are invalid afterwards, so fields are written through builder_at.
+ */
+static size_t builder_alloc(Builder *builder, Region region, size_t size)
+{
+    Buffer *buffer = &builder->regions[region];
+    size_t offset = ALIGN_UP(buffer->size, sizeof(void*));
+
+    if (offset + size > buffer->capacity) {
+        size_t capacity = buffer->capacity ? buffer->capacity : 4096;
+        while (capacity < offset + size)
+            capacity *= 2;
+
+        buffer->data = realloc(buffer->data, capacity);
+        memset(buffer->data + buffer->capacity, 0, capacity - buffer->capacity);
+        buffer->capacity = capacity;
+    }
+
+    buffer->size = offset + size;
+    return offset;
+}
+
+static inline void *builder_at(Builder *builder, Region region, size_t offset)
+{
+    return builder->regions[region].data + offset;
+}
+
+/* Only for plain data, or structs whose pointers were cleared first */
+static size_t builder_copy(Builder *builder, Region region, const void *data, size_t size)
+{
+    size_t offset = builder_alloc(builder, region, size);
+    memcpy(builder_at(builder, region, offset), data, size);
+    return offset;
+}
+
+/* The pointer itself is written by archive_layout_image, once the regions'
+ * places in the file are known
+ */
+static void builder_pointer(Builder *builder, Region region, size_t offset, Region target_region, size_t target)
+{
+    if (builder->fixups_count == builder->fixups_capacity) {
+        builder->fixups_capacity = builder->fixups_capacity ? builder->fixups_capacity * 2 : 256;
+        builder->fixups = realloc(builder->fixups, sizeof(Fixup) * builder->fixups_capacity);
+    }
+
+    builder->fixups[builder->fixups_count++] = (Fixup) { region, target_region, offset, target };
+}
+
+static bool copied_symbol_match(const void *entry, const void *key)
+{
+    return ((const CopiedSymbol*) entry)->symbol == key;
+}
+
+static uint32_t copied_symbol_hash(const void *entry)
+{
+    return ((const CopiedSymbol*) entry)->symbol->hash;
+}
+
+/* Returns the slot for `symbol`, a free one if it wasn't copied yet */
+static CopiedSymbol *copied_map_find(HashTable *map, Symbol *symbol)
+{
+    hash_table_reserve(map, sizeof(CopiedSymbol), 1024, copied_symbol_hash);
+    return hash_table_probe(map, sizeof(CopiedSymbol), symbol->hash, copied_symbol_match, symbol);
+}
+
+/* Each symbol is copied once, so archived names still compare by pointer */
+static size_t builder_symbol(Builder *builder, Symbol *symbol)
+{
+    CopiedSymbol *slot = copied_map_find(&builder->symbols, symbol);
+    if (!slot->symbol) {
+        slot->symbol = symbol;
+        slot->offset = builder_copy(builder, REGION_RO, symbol, sizeof(Symbol) + symbol->length + 1);
+        builder->symbols.count++;
+    }
+
+    return slot->offset;
+}
+
+/* For `char*` names, which always point at symbol bytes */
+static void builder_name(Builder *builder, Region region, size_t offset, char *name)
+{
+    if (name)
+        builder_pointer(builder, region, offset, REGION_RO, builder_symbol(builder, symbol_of(name)) + offsetof(Symbol, bytes));
+}
+
+/* Copied once per signature, like the interned records themselves */
+static size_t builder_descriptors(Builder *builder, Descriptors *descriptors)
+{
+    CopiedSymbol *slot = copied_map_find(&builder->descriptors, symbol_of(descriptors->descriptor));
+    if (slot->symbol)
+        return slot->offset;
+
+    Descriptors copy = *descriptors;
+    copy.descriptor = NULL;
+    copy.arguments = NULL;
+    copy.return_descriptor.object_name = NULL;
+
+    size_t at = builder_copy(builder, REGION_RO, &copy, sizeof(copy));
+    builder_name(builder, REGION_RO, at + offsetof(Descriptors, descriptor), descriptors->descriptor);
+    builder_name(builder, REGION_RO, at + offsetof(Descriptors, return_descriptor.object_name),
+                 descriptors->return_descriptor.object_name);
+
+    if (descriptors->arguments_count) {
+        size_t arguments = builder_alloc(builder, REGION_RO, sizeof(Descriptor) * descriptors->arguments_count);
+        builder_pointer(builder, REGION_RO, at + offsetof(Descriptors, arguments), REGION_RO, arguments);
+
+        for (int i = 0; i < descriptors->arguments_count; i++) {
+            size_t argument = arguments + i * sizeof(Descriptor);
+            Descriptor *descriptor = builder_at(builder, REGION_RO, argument);
+            *descriptor = descriptors->arguments[i];
+            descriptor->object_name = NULL;
+            builder_name(builder, REGION_RO, argument + offsetof(Descriptor, object_name), descriptors->arguments[i].object_name);
+        }
+    }
+
+    slot->symbol = symbol_of(descriptors->descriptor);
+    slot->offset = at;
+    builder->descriptors.count++;
+    return at;
+}
+
+/* Tags and values never change, so they go with the read only data.
+ * Resolution caches are per run, so every entry starts out unresolved,
+ * except for Utf8 entries which point at their archived symbol.
+ */
+static size_t builder_pool(Builder *builder, ConstantPool *pool)
+{
+    size_t at = builder_alloc(builder, REGION_RW, sizeof(ConstantPool));
+    size_t tags = builder_copy(builder, REGION_RO, pool->tags, sizeof(uint8_t) * (pool->count + 1));
+    size_t values = builder_copy(builder, REGION_RO, pool->values, sizeof(uint32_t) * (pool->count + 1));
+    size_t resolved = builder_alloc(builder, REGION_RW, sizeof(void*) * (pool->count + 1));
+
+    ((ConstantPool*) builder_at(builder, REGION_RW, at))->count = pool->count;
+    builder_pointer(builder, REGION_RW, at + offsetof(ConstantPool, tags), REGION_RO, tags);
+    builder_pointer(builder, REGION_RW, at + offsetof(ConstantPool, values), REGION_RO, values);
+    builder_pointer(builder, REGION_RW, at + offsetof(ConstantPool, resolved), REGION_RW, resolved);
+
+    for (int i = 1; i < pool->count; i++) {
+        if (pool->tags[i] == CONSTANT_UTF8)
+            builder_pointer(builder, REGION_RW, resolved + i * sizeof(void*),
+                            REGION_RO, builder_symbol(builder, pool->resolved[i]));
+    }
+
+    return at;
+}
+
+static size_t builder_bootstrap_methods(Builder *builder, Class *class)
+{
+    uint16_t count = class->bootstrap_methods_count;
+    size_t at = builder_alloc(builder, REGION_RO, sizeof(struct BootstrapMethod) * count);
+
+    for (int i = 0; i < count; i++) {
+        struct BootstrapMethod *bootstrap = &class->bootstrap_methods[i];
+        size_t method = at + i * sizeof(struct BootstrapMethod);
+        size_t arguments = builder_copy(builder, REGION_RO, bootstrap->bootstrap_arguments,
+                                        sizeof(uint16_t) * bootstrap->num_bootstrap_arguments);
+
+        struct BootstrapMethod *copy = builder_at(builder, REGION_RO, method);
+        copy->bootstrap_method_ref = bootstrap->bootstrap_method_ref;
+        copy->num_bootstrap_arguments = bootstrap->num_bootstrap_arguments;
+        builder_pointer(builder, REGION_RO, method + offsetof(struct BootstrapMethod, bootstrap_arguments),
+                        REGION_RO, arguments);
+    }
+
+    return at;
+}
+
+static size_t builder_names(Builder *builder, char **names, int count)
+{
+    size_t at = builder_alloc(builder, REGION_RO, sizeof(char*) * count);
+    for (int i = 0; i < count; i++)
+        builder_name(builder, REGION_RO, at + i * sizeof(char*), names[i]);
+
+    return at;
+}
+
+static void builder_member_index(Builder *builder, size_t offset, MemberIndex *index)
+{
+    if (!index->entries)
+        return;
+
+    MemberIndex *copy = builder_at(builder, REGION_RW, offset);
+    copy->mask = index->mask;
+    copy->count = index->count;
+    builder_pointer(builder, REGION_RW, offset + offsetof(MemberIndex, entries), REGION_RO,
+                    builder_copy(builder, REGION_RO, index->entries, sizeof(MemberIndexEntry) * (index->mask + 1)));
+}
+
+/* The class itself and its static fields are written to at runtime. The
+ * superclass is resolved by class_parse from `parent_name` in every run.
+ */
+static size_t builder_class(Builder *builder, Class *class)
+{
+    size_t at = builder_alloc(builder, REGION_RW, sizeof(Class));
+
+    Class *copy = builder_at(builder, REGION_RW, at);
+    copy->flags = class->flags;
+    copy->shared = true;
+    copy->methods_count = class->methods_count;
+    copy->static_field_count = class->static_field_count;
+    copy->instance_field_count = class->instance_field_count;
+    copy->bootstrap_methods_count = class->bootstrap_methods_count;
+
+    builder_name(builder, REGION_RW, at + offsetof(Class, name), class->name);
+    builder_pointer(builder, REGION_RW, at + offsetof(Class, parent_name), REGION_RO, builder_symbol(builder, class->parent_name));
+    builder_pointer(builder, REGION_RW, at + offsetof(Class, pool), REGION_RW, builder_pool(builder, class->pool));
+    builder_member_index(builder, at + offsetof(Class, method_index), &class->method_index);
+    builder_member_index(builder, at + offsetof(Class, static_field_index), &class->static_field_index);
+
+    if (class->instance_field_count)
+        builder_pointer(builder, REGION_RW, at + offsetof(Class, instance_field_names), REGION_RO,
+                        builder_names(builder, class->instance_field_names, class->instance_field_count));
+    if (class->bootstrap_methods_count)
+        builder_pointer(builder, REGION_RW, at + offsetof(Class, bootstrap_methods), REGION_RO,
+                        builder_bootstrap_methods(builder, class));
+
+    /* Methods are written to when compiled code is bound to them */
+    if (class->methods_count) {
+        size_t methods = builder_alloc(builder, REGION_RW, sizeof(Method) * class->methods_count);
+        builder_pointer(builder, REGION_RW, at + offsetof(Class, methods), REGION_RW, methods);
+
+        for (int i = 0; i < class->methods_count; i++) {
+            Method *method = &class->methods[i];
+            size_t entry = methods + i * sizeof(Method);
+
+            Method *copy = builder_at(builder, REGION_RW, entry);
+            copy->flags = method->flags;
+            copy->data_length = method->data_length;
+            copy->max_stack = method->max_stack;
+            copy->max_local = method->max_local;
+
+            builder_pointer(builder, REGION_RW, entry + offsetof(Method, class), REGION_RW, at);
+            builder_name(builder, REGION_RW, entry + offsetof(Method, name), method->name);
+
+            /* Already rewritten by method_prepare */
+            if (method->data)
+                builder_pointer(builder, REGION_RW, entry + offsetof(Method, data), REGION_RO,
+                                builder_copy(builder, REGION_RO, method->data, method->data_length));
+            if (method->descriptors)
+                builder_pointer(builder, REGION_RW, entry + offsetof(Method, descriptors), REGION_RO,
+                                builder_descriptors(builder, method->descriptors));
+        }
+    }
+
+    if (class->static_field_count) {
+        size_t fields = builder_alloc(builder, REGION_RW, sizeof(Field) * class->static_field_count);
+        builder_pointer(builder, REGION_RW, at + offsetof(Class, static_fields), REGION_RW, fields);
+
+        for (int i = 0; i < class->static_field_count; i++) {
+            size_t entry = fields + i * sizeof(Field);
+            builder_pointer(builder, REGION_RW, entry + offsetof(Field, class), REGION_RW, at);
+            builder_name(builder, REGION_RW, entry + offsetof(Field, name), class->static_fields[i].name);
+        }
+    }
+
+    return at;
+}
+
+static void builder_free(Builder *builder)
+{
+    for (int i = 0; i < REGION_COUNT; i++)
+        free(builder->regions[i].data);
+
+    free(builder->fixups);
+    hash_table_free(&builder->symbols);
+    hash_table_free(&builder->descriptors);
+}
+
+/* Places the regions in the file, writes every pointer for the preferred
+ * base and marks it in the relocation bitmap. Returns the whole image.
+ */
+static uint8_t *archive_layout_image(Builder *builder, ArchiveHeader *header)
+{
+    size_t offsets[REGION_COUNT];
+
+    header->base = ARCHIVE_BASE;
+    header->rw_offset = offsets[REGION_RW] = ARCHIVE_ALIGNMENT;
+    header->rw_size = builder->regions[REGION_RW].size;
+    header->ro_offset = offsets[REGION_RO] = header->rw_offset + ALIGN_UP(header->rw_size, ARCHIVE_ALIGNMENT);
+    header->ro_size = builder->regions[REGION_RO].size;
+    header->bitmap_offset = ALIGN_UP(header->ro_offset + header->ro_size, sizeof(uint64_t));
+    header->bitmap_size = ALIGN_UP(header->bitmap_offset / sizeof(void*), 64) / 8;
+
+    uint8_t *image = calloc(1, header->bitmap_offset + header->bitmap_size);
+    memcpy(image + header->rw_offset, builder->regions[REGION_RW].data, header->rw_size);
+    memcpy(image + header->ro_offset, builder->regions[REGION_RO].data, header->ro_size);
+
+    uint64_t *bitmap = (uint64_t*) (image + header->bitmap_offset);
+    for (size_t i = 0; i < builder->fixups_count; i++) {
+        Fixup *fixup = &builder->fixups[i];
+        size_t offset = offsets[fixup->region] + fixup->offset;
+        uintptr_t address = header->base + offsets[fixup->target_region] + fixup->target;
+
+        memcpy(image + offset, &address, sizeof(address));
+        size_t word = offset / sizeof(void*);
+        bitmap[word / 64] |= (uint64_t) 1 << (word % 64);
+    }
+
+    return image;
+}
+
+static bool archive_write(const char *path, uint8_t *image, size_t size)
+{
+    /* Written aside and renamed over, since running VMs may have the old
+     * archive mapped and would fault on a truncated file
+     */
+    size_t length = strlen(path);
+    char *temporary = malloc(length + 5);
+    memcpy(temporary, path, length);
+    memcpy(temporary + length, ".tmp", 5);
+
+    bool written = false;
+    int fd = open(temporary, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd >= 0) {
+        size_t done = 0;
+        while (done < size) {
+            ssize_t count = write(fd, image + done, size - done);
+            if (count <= 0)
+                break;
+            done += count;
+        }
+
+        written = !close(fd) && done == size && !rename(temporary, path);
+        if (!written)
+            unlink(temporary);
+    }
+
+    free(temporary);
+    return written;
+}
+
+bool cds_dump(Classes *classes, const char *path)
+{
+    Builder builder;
+    memset(&builder, 0, sizeof(builder));
+
+    ArchiveHeader header;
+    memset(&header, 0, sizeof(header));
+    header.magic = ARCHIVE_MAGIC;
+    header.version = ARCHIVE_VERSION;
+    header.layout = archive_layout();
+    header.classpath_stamp = classpath_stamp();
+
+    int count = 0;
+    for (uint32_t i = 0; i < classes->count; i++)
+        count += !classes->classes[i]->built_in && !classes->classes[i]->shared;
+
+    size_t *offsets = malloc(sizeof(size_t) * count);
+    Class **archived = malloc(sizeof(Class*) * count);
+    for (uint32_t i = 0, j = 0; i < classes->count; i++) {
+        Class *class = classes->classes[i];
+        if (class->built_in || class->shared)
+            continue;
+
+        archived[j] = class;
+        offsets[j++] = builder_class(&builder, class);
+    }
+
+    /* Indexed like Classes, by the name symbol's hash */
+    HashTable slots;
+    hash_table_init(&slots, sizeof(Class*), count);
+
+    header.classes_count = count;
+    header.classes_capacity = slots.mask + 1;
+    header.classes_offset = builder_alloc(&builder, REGION_RO, sizeof(Class*) * header.classes_capacity);
+    header.stamps_offset = builder_alloc(&builder, REGION_RO, sizeof(uint32_t) * header.classes_capacity);
+    for (int i = 0; i < count; i++) {
+        Class **slot = hash_table_free_entry(&slots, sizeof(Class*), symbol_of(archived[i]->name)->hash);
+        size_t index = slot - (Class**) slots.entries;
+        *slot = archived[i];
+        builder_pointer(&builder, REGION_RO, header.classes_offset + index * sizeof(Class*), REGION_RW, offsets[i]);
+
+        /* A class whose file is gone by now is stamped 0 and never matches */
+        uint32_t *stamp = builder_at(&builder, REGION_RO, header.stamps_offset + index * sizeof(uint32_t));
+        if (!classpath_class_stamp(archived[i]->name, stamp))
+            *stamp = 0;
+    }
+
+    /* Nothing adds symbols past this point */
+    header.symbols_count = builder.symbols.count;
+    header.symbols_offset = builder_alloc(&builder, REGION_RO, sizeof(Symbol*) * builder.symbols.count);
+    CopiedSymbol *copied = builder.symbols.entries;
+    for (uint32_t i = 0, j = 0; copied && i <= builder.symbols.mask; i++) {
+        if (copied[i].symbol)
+            builder_pointer(&builder, REGION_RO, header.symbols_offset + j++ * sizeof(Symbol*), REGION_RO, copied[i].offset);
+    }
+
+    /* Both were relative to their region until now */
+    uint8_t *image = archive_layout_image(&builder, &header);
+    header.classes_offset += header.ro_offset;
+    header.stamps_offset += header.ro_offset;
+    header.symbols_offset += header.ro_offset;
+    memcpy(image, &header, sizeof(header));
+
+    size_t size = header.bitmap_offset + header.bitmap_size;
+    bool written = archive_write(path, image, size);
+    if (written)
+        printf("miniJVM: archived %d classes and %u symbols in %s (%zu bytes)\n", count, header.symbols_count, path, size);
+    else
+        fprintf(stderr, "miniJVM: failed to write shared archive %s\n", path);
+
+    free(image);
+    hash_table_free(&slots);
+    free(archived);
+    free(offsets);
+    builder_free(&builder);
+    return written;
+}
+
+/* Whether the aligned array at offset with the given size lies within
+ * start and end, without overflowing on hostile values
+ */
+static bool archive_range_valid(uint64_t offset, uint64_t size, uint64_t alignment, uint64_t start, uint64_t end)
+{
+    return offset % alignment == 0 && offset >= start && offset <= end && size <= end - offset;
+}
+
+static const char *archive_check(ArchiveHeader *header, size_t size)
+{
+    if (header->magic != ARCHIVE_MAGIC)
+        return "not a shared archive";
+    if (header->version != ARCHIVE_VERSION || header->layout != archive_layout())
+        return "written by a different build";
+    if (header->classpath_stamp != classpath_stamp())
+        return "the class path changed since it was dumped";
+    if (header->bitmap_offset > size || header->bitmap_size != size - header->bitmap_offset)
+        return "truncated";
+
+    /* The regions follow each other in the order archive_layout_image puts them */
+    if (!archive_range_valid(header->rw_offset, header->rw_size, ARCHIVE_ALIGNMENT, sizeof(ArchiveHeader), size) ||
+        !archive_range_valid(header->ro_offset, header->ro_size, ARCHIVE_ALIGNMENT,
+                             header->rw_offset + header->rw_size, size) ||
+        !archive_range_valid(header->bitmap_offset, header->bitmap_size, sizeof(uint64_t),
+                             header->ro_offset + header->ro_size, size) ||
+        header->bitmap_size != ALIGN_UP(header->bitmap_offset / sizeof(void*), 64) / 8)
+        return "malformed";
+
+    uint64_t ro_end = header->ro_offset + header->ro_size;
+    uint32_t capacity = header->classes_capacity;
+    if (!capacity || (capacity & (capacity - 1)) || header->classes_count > capacity ||
+        !archive_range_valid(header->classes_offset, (uint64_t) capacity * sizeof(Class*), sizeof(Class*),
+                             header->ro_offset, ro_end) ||
+        !archive_range_valid(header->stamps_offset, (uint64_t) capacity * sizeof(uint32_t), sizeof(uint32_t),
+                             header->ro_offset, ro_end) ||
+        !archive_range_valid(header->symbols_offset, (uint64_t) header->symbols_count * sizeof(Symbol*),
+                             sizeof(Symbol*), header->ro_offset, ro_end))
+        return "malformed";
+
+    return NULL;
+}
+
+/* Only reached when the preferred base was taken. This writes to pages of
+ * the read-only region, which then stop being shared with other VMs.
+ */
+static void archive_relocate(uint8_t *base, ArchiveHeader *header)
+{
+    uintptr_t delta = (uintptr_t) base - header->base;
+    uintptr_t *words = (uintptr_t*) base;
+    uint64_t *bitmap = (uint64_t*) (base + header->bitmap_offset);
+
+    mprotect(base, header->bitmap_offset, PROT_READ | PROT_WRITE);
+    /* The bitmap is rounded up to whole words, whose spare bits must not reach into it */
+    size_t words_count = header->bitmap_offset / sizeof(uintptr_t);
+    for (size_t i = 0; i < header->bitmap_size / sizeof(uint64_t); i++) {
+        for (uint64_t bits = bitmap[i]; bits; bits &= bits - 1) {
+            size_t word = i * 64 + __builtin_ctzll(bits);
+            if (word < words_count)
+                words[word] += delta;
+        }
+    }
+    mprotect(base, header->bitmap_offset, PROT_READ);
+}
+
+bool cds_map(const char *path)
+{
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        fprintf(stderr, "miniJVM: cannot open shared archive %s\n", path);
+        return false;
+    }
+
+    struct stat filestat;
+    ArchiveHeader header;
+    const char *error = "truncated";
+    if (!fstat(fd, &filestat) && pread(fd, &header, sizeof(header), 0) == sizeof(header))
+        error = archive_check(&header, filestat.st_size);
+
+    if (error) {
+        fprintf(stderr, "miniJVM: ignoring shared archive %s: %s\n", path, error);
+        close(fd);
+        return false;
+    }
+
+    /* Older kernels take MAP_FIXED_NOREPLACE as a plain hint */
+    size_t size = filestat.st_size;
+    uint8_t *base = mmap((void*) (uintptr_t) header.base, size, PROT_READ, MAP_PRIVATE | MAP_FIXED_NOREPLACE, fd, 0);
+    if (base != MAP_FAILED && (uintptr_t) base != header.base) {
+        munmap(base, size);
+        base = MAP_FAILED;
+    }
+
+    bool relocated = base == MAP_FAILED;
+    if (relocated)
+        base = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+    close(fd);
+    if (base == MAP_FAILED) {
+        fprintf(stderr, "miniJVM: failed to map shared archive %s\n", path);
+        return false;
+    }
+
+    if (relocated)
+        archive_relocate(base, &header);
+
+    mprotect(base + header.rw_offset, header.ro_offset - header.rw_offset, PROT_READ | PROT_WRITE);
+
+    archive.base = base;
+    archive.size = size;
+    archive.classes.mask = header.classes_capacity - 1;
+    archive.classes.count = header.classes_count;
+    archive.classes.entries = base + header.classes_offset;
+    archive.stamps = (uint32_t*) (base + header.stamps_offset);
+    symbol_table_share((Symbol**) (base + header.symbols_offset), header.symbols_count, base, base + size);
+
+    printf("miniJVM: mapped %u classes from shared archive %s%s\n", header.classes_count, path,
+           relocated ? " (relocated)" : "");
+    return true;
+}
+
+void cds_unmap(void)
+{
+    if (archive.base)
+        munmap(archive.base, archive.size);
+
+    memset(&archive, 0, sizeof(archive));
+}
+
+static bool archived_class_match(const void *entry, const void *key)
+{
+    return (*(Class* const*) entry)->name == key;
+}
+
+Class *cds_find_class(const char *name)
+{
+    if (!archive.base)
+        return NULL;
+
+    Symbol *symbol = symbol_find(name);
+    if (!symbol)
+        return NULL;
+
+    Class **class = hash_table_find(&archive.classes, sizeof(Class*), symbol->hash, archived_class_match, symbol->bytes);
+    if (!class)
+        return NULL;
+
+    /* A class file changed since the dump is parsed again instead */
+    uint32_t stamp;
+    uint32_t index = class - (Class**) archive.classes.entries;
+    if (!classpath_class_stamp(name, &stamp) || stamp != archive.stamps[index])
+        return NULL;
+
+    return *class;
+}
\ No newline at end of file
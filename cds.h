@@ -0,0 +1,53 @@
+/*
+ * This file is part of MiniJVM (https://github.com/muhammad23012009/minijvm)
+ * Copyright (c) 2025 Muhammad  <thevancedgamer@mentallysanemainliners.org>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef CDS_H
+#define CDS_H
+
+/* Class data sharing. A dump run writes the parsed and linked metadata of
+ * every class it loaded from the class path (constant pools, methods with
+ * their prepared code and descriptors, member indexes and every symbol they
+ * name) into an archive. Later runs map the archive and use those classes as
+ * they are, instead of finding and parsing their class files.
+ *
+ * The archive is laid out for a preferred base address. Mapped there, no
+ * pointer needs fixing up, so the read-only region stays a clean file
+ * mapping shared by every VM that maps the same archive, and only the pages
+ * of the read-write region the VM writes to (static fields, constant pool
+ * caches, methods bound to compiled code) get copied. If the address is taken, the pointers listed in the
+ * archive's relocation bitmap are adjusted instead, at the cost of sharing.
+ */
+
+#include <stdbool.h>
+#include "method.h"
+
+/* Writes every class in `classes` that was loaded from the class path */
+extern bool cds_dump(Classes *classes, const char *path);
+
+/* Has to run before symbol_table_init, so the archived symbols are the ones
+ * every later lookup finds. Returns false, leaving nothing mapped, if the
+ * archive can't be used with this build or class path.
+ */
+extern bool cds_map(const char *path);
+extern void cds_unmap(void);
+
+/* Returns the archived class, or NULL if there is none by that name or its
+ * class file changed since the dump
+ */
+extern Class *cds_find_class(const char *name);
+
+#endif
\ No newline at end of file
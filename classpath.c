@@ -0,0 +1,592 @@
+/*
+ * This file is part of MiniJVM (https://github.com/muhammad23012009/minijvm)
+ * Copyright (c) 2025 Muhammad  <thevancedgamer@mentallysanemainliners.org>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <pthread.h>
+#include <zlib.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "classpath.h"
+#include "hash.h"
+#include "hashtable.h"
+
+#define ZIP_END_SIGNATURE       0x06054b50
+#define ZIP_CENTRAL_SIGNATURE   0x02014b50
+#define ZIP_LOCAL_SIGNATURE     0x04034b50
+
+#define ZIP_END_SIZE            22
+#define ZIP_CENTRAL_SIZE        46
+#define ZIP_LOCAL_SIZE          30
+
+#define ZIP_STORED              0
+#define ZIP_DEFLATED            8
+
+typedef struct JarEntry {
+    uint32_t hash;
+    uint16_t name_length;
+    /* Points into the mapping, NULL marks a free slot */
+    const char *name;
+    uint16_t method;
+    uint32_t crc;
+    uint32_t compressed_size;
+    uint32_t size;
+    uint32_t local_offset;
+} JarEntry;
+
+typedef struct Jar {
+    uint8_t *data;
+    size_t size;
+    /* Index of the central directory, holding JarEntry */
+    HashTable entries;
+} Jar;
+
+/* A set of names, each with an optional value. Never shrinks */
+typedef struct NameTableEntry {
+    uint32_t hash;
+    char *name;
+    void *value;
+} NameTableEntry;
+
+typedef HashTable NameTable;
+
+/* Names in the tables here aren't NUL-terminated */
+typedef struct NameKey {
+    const char *name;
+    size_t length;
+    uint32_t hash;
+} NameKey;
+
+/* One package of a directory entry, listed on first use */
+typedef struct DirectoryPackage {
+    /* False if the package directory does not exist */
+    bool exists;
+    /* File names of the class files in it */
+    NameTable files;
+} DirectoryPackage;
+
+typedef struct Directory {
+    char *path;
+    /* Package path (e.g. java/lang, or empty for the root) to its listing */
+    NameTable packages;
+} Directory;
+
+typedef struct ClassPathEntry {
+    /* Exactly one of these is set */
+    Directory *directory;
+    Jar *jar;
+} ClassPathEntry;
+
+/* The lock covers the directory listings and the list of misses, which
+ * are filled in lazily while the loader may be running on several threads.
+ */
+static struct {
+    /* Set by classpath_init, even if none of the entries could be used */
+    bool initialized;
+    int count;
+    ClassPathEntry *entries;
+
+    pthread_mutex_t lock;
+    /* Class files that no entry has */
+    NameTable missing;
+
+    /* Hash of every entry's path */
+    uint32_t stamp;
+} classpath = { .lock = PTHREAD_MUTEX_INITIALIZER };
+
+static bool name_table_match(const void *entry, const void *key)
+{
+    const NameTableEntry *e = entry;
+    const NameKey *k = key;
+    return e->hash == k->hash && !strncmp(e->name, k->name, k->length) && !e->name[k->length];
+}
+
+static uint32_t name_table_hash(const void *entry)
+{
+    return ((const NameTableEntry*) entry)->hash;
+}
+
+static NameTableEntry *name_table_find(NameTable *table, const char *name, size_t length)
+{
+    NameKey key = { name, length, hash_bytes(name, length) };
+    return hash_table_find(table, sizeof(NameTableEntry), key.hash, name_table_match, &key);
+}
+
+/* Returns the entry for `name`, adding it with a NULL value if needed */
+static NameTableEntry *name_table_add(NameTable *table, const char *name, size_t length)
+{
+    hash_table_reserve(table, sizeof(NameTableEntry), 16, name_table_hash);
+
+    uint32_t hash = hash_bytes(name, length);
+    NameKey key = { name, length, hash };
+    NameTableEntry *entry = hash_table_probe(table, sizeof(NameTableEntry), hash, name_table_match, &key);
+    if (!entry->name) {
+        entry->hash = hash;
+        entry->name = strndup(name, length);
+        entry->value = NULL;
+        table->count++;
+    }
+
+    return entry;
+}
+
+static void name_table_free(NameTable *table, void (*free_value)(void*))
+{
+    NameTableEntry *entries = table->entries;
+    for (uint32_t i = 0; entries && i <= table->mask; i++) {
+        free(entries[i].name);
+        if (free_value && entries[i].value)
+            free_value(entries[i].value);
+    }
+
+    hash_table_free(table);
+}
+
+static inline uint16_t zip_u16(const uint8_t *p)
+{
+    return p[0] | (p[1] << 8);
+}
+
+static inline uint32_t zip_u32(const uint8_t *p)
+{
+    return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t) p[3] << 24);
+}
+
+/* Maps a file read-only, the parser copies whatever it keeps */
+static uint8_t *classpath_map(const char *path, size_t *size)
+{
+    struct stat filestat;
+    int fd = open(path, O_RDONLY);
+    if (fd < 0)
+        return NULL;
+
+    if (fstat(fd, &filestat) < 0 || !S_ISREG(filestat.st_mode) || !filestat.st_size) {
+        close(fd);
+        return NULL;
+    }
+
+    uint8_t *data = mmap(NULL, filestat.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED)
+        return NULL;
+
+    *size = filestat.st_size;
+    return data;
+}
+
+static bool jar_entry_match(const void *entry, const void *key)
+{
+    const JarEntry *e = entry;
+    const NameKey *k = key;
+    return e->hash == k->hash && e->name_length == k->length && !memcmp(e->name, k->name, k->length);
+}
+
+/* Only the central directory is read here, entries are located on use */
+static Jar *jar_open(const char *path)
+{
+    size_t size;
+    uint8_t *data = classpath_map(path, &size);
+    if (!data)
+        return NULL;
+
+    /* The end record sits after the central directory, followed by a comment of up to 64 KiB */
+    const uint8_t *end = NULL;
+    if (size >= ZIP_END_SIZE) {
+        size_t lowest = size > ZIP_END_SIZE + 0xFFFF ? size - ZIP_END_SIZE - 0xFFFF : 0;
+        for (size_t i = size - ZIP_END_SIZE + 1; i-- > lowest;) {
+            if (zip_u32(data + i) == ZIP_END_SIGNATURE) {
+                end = data + i;
+                break;
+            }
+        }
+    }
+
+    if (!end) {
+        munmap(data, size);
+        return NULL;
+    }
+
+    uint16_t count = zip_u16(end + 10);
+    uint32_t directory_size = zip_u32(end + 12);
+    uint32_t directory_offset = zip_u32(end + 16);
+    if ((size_t) directory_offset + directory_size > size) {
+        munmap(data, size);
+        return NULL;
+    }
+
+    Jar *jar = malloc(sizeof(Jar));
+    jar->data = data;
+    jar->size = size;
+
+    hash_table_init(&jar->entries, sizeof(JarEntry), count);
+
+    const uint8_t *record = data + directory_offset;
+    const uint8_t *directory_end = record + directory_size;
+    for (int i = 0; i < count; i++) {
+        if (record + ZIP_CENTRAL_SIZE > directory_end || zip_u32(record) != ZIP_CENTRAL_SIGNATURE)
+            break;
+
+        uint16_t name_length = zip_u16(record + 28);
+        size_t record_size = ZIP_CENTRAL_SIZE + name_length + zip_u16(record + 30) + zip_u16(record + 32);
+        if (record + record_size > directory_end)
+            break;
+
+        const char *name = (const char*) record + ZIP_CENTRAL_SIZE;
+        NameKey key = { name, name_length, hash_bytes(name, name_length) };
+        JarEntry *entry = hash_table_probe(&jar->entries, sizeof(JarEntry), key.hash, jar_entry_match, &key);
+        if (!entry->name) {
+            jar->entries.count++;
+            entry->hash = key.hash;
+            entry->name_length = name_length;
+            entry->name = name;
+            entry->method = zip_u16(record + 10);
+            entry->crc = zip_u32(record + 16);
+            entry->compressed_size = zip_u32(record + 20);
+            entry->size = zip_u32(record + 24);
+            entry->local_offset = zip_u32(record + 42);
+        }
+
+        record += record_size;
+    }
+
+    return jar;
+}
+
+static void jar_close(Jar *jar)
+{
+    munmap(jar->data, jar->size);
+    hash_table_free(&jar->entries);
+    free(jar);
+}
+
+/* One stream per thread, reset between entries instead of set up again.
+ * The key's destructor ends a thread's stream when the thread exits.
+ */
+static pthread_key_t inflater_key;
+static pthread_once_t inflater_once = PTHREAD_ONCE_INIT;
+
+static void inflater_free(void *data)
+{
+    inflateEnd(data);
+    free(data);
+}
+
+static void inflater_key_init(void)
+{
+    pthread_key_create(&inflater_key, inflater_free);
+}
+
+static bool jar_inflate(const uint8_t *source, uint32_t source_size, uint8_t *dest, uint32_t size)
+{
+    pthread_once(&inflater_once, inflater_key_init);
+
+    z_stream *inflater = pthread_getspecific(inflater_key);
+    if (!inflater) {
+        inflater = calloc(1, sizeof(z_stream));
+        /* Negative window bits: JAR entries are raw deflate without a zlib header */
+        if (inflateInit2(inflater, -MAX_WBITS) != Z_OK) {
+            free(inflater);
+            return false;
+        }
+        pthread_setspecific(inflater_key, inflater);
+    } else {
+        inflateReset(inflater);
+    }
+
+    inflater->next_in = (Bytef*) source;
+    inflater->avail_in = source_size;
+    inflater->next_out = dest;
+    inflater->avail_out = size;
+
+    return inflate(inflater, Z_FINISH) == Z_STREAM_END && inflater->total_out == size;
+}
+
+static bool jar_find(Jar *jar, const char *name, size_t length, ClassBytes *bytes)
+{
+    if (length > UINT16_MAX)
+        return false;
+
+    NameKey key = { name, length, hash_bytes(name, length) };
+    JarEntry *entry = hash_table_find(&jar->entries, sizeof(JarEntry), key.hash, jar_entry_match, &key);
+    if (!entry)
+        return false;
+
+    /* The local header repeats the name and has its own extra field */
+    const uint8_t *local = jar->data + entry->local_offset;
+    if ((size_t) entry->local_offset + ZIP_LOCAL_SIZE > jar->size || zip_u32(local) != ZIP_LOCAL_SIGNATURE)
+        return false;
+
+    size_t offset = (size_t) entry->local_offset + ZIP_LOCAL_SIZE + zip_u16(local + 26) + zip_u16(local + 28);
+    if (offset + entry->compressed_size > jar->size)
+        return false;
+
+    if (entry->method == ZIP_STORED && entry->compressed_size == entry->size) {
+        bytes->kind = CLASS_BYTES_BORROWED;
+        bytes->data = jar->data + offset;
+        bytes->size = entry->size;
+        return true;
+    }
+
+    if (entry->method != ZIP_DEFLATED || !entry->size)
+        return false;
+
+    uint8_t *data = malloc(entry->size);
+    if (!jar_inflate(jar->data + offset, entry->compressed_size, data, entry->size)) {
+        free(data);
+        return false;
+    }
+
+    bytes->kind = CLASS_BYTES_ALLOCATED;
+    bytes->data = data;
+    bytes->size = entry->size;
+    return true;
+}
+
+/* Lists the class files of one package directory */
+static DirectoryPackage *directory_scan(Directory *directory, const char *package, size_t length)
+{
+    DirectoryPackage *listing = calloc(1, sizeof(DirectoryPackage));
+
+    char path[4096];
+    snprintf(path, sizeof(path), "%s/%.*s", directory->path, (int) length, package);
+
+    DIR *dir = opendir(path);
+    if (!dir)
+        return listing;
+
+    listing->exists = true;
+    struct dirent *file;
+    while ((file = readdir(dir))) {
+        size_t name_length = strlen(file->d_name);
+        if (name_length > 6 && !strcmp(file->d_name + name_length - 6, ".class"))
+            name_table_add(&listing->files, file->d_name, name_length);
+    }
+
+    closedir(dir);
+    return listing;
+}
+
+static void directory_package_free(void *data)
+{
+    DirectoryPackage *listing = data;
+    name_table_free(&listing->files, NULL);
+    free(listing);
+}
+
+/* Whether the directory has `path`, scanning its package on first use.
+ * Called with the lock held.
+ */
+static bool directory_contains(Directory *directory, const char *path)
+{
+    const char *slash = strrchr(path, '/');
+    size_t package_length = slash ? (size_t) (slash - path) : 0;
+    const char *file = slash ? slash + 1 : path;
+
+    NameTableEntry *package = name_table_add(&directory->packages, path, package_length);
+    if (!package->value)
+        package->value = directory_scan(directory, path, package_length);
+
+    DirectoryPackage *listing = package->value;
+    return listing->exists && name_table_find(&listing->files, file, strlen(file));
+}
+
+static void directory_free(Directory *directory)
+{
+    name_table_free(&directory->packages, directory_package_free);
+    free(directory->path);
+    free(directory);
+}
+
+void classpath_init(char *path)
+{
+    classpath_free();
+
+    char *copy = strdup(path);
+    char *save = NULL;
+    classpath.initialized = true;
+    classpath.stamp = HASH_SEED;
+    for (char *part = strtok_r(copy, ":", &save); part; part = strtok_r(NULL, ":", &save)) {
+        ClassPathEntry entry = { NULL, NULL };
+        size_t length = strlen(part);
+
+        if (length > 4 && (!strcmp(part + length - 4, ".jar") || !strcmp(part + length - 4, ".zip"))) {
+            entry.jar = jar_open(part);
+            if (!entry.jar) {
+                fprintf(stderr, "miniJVM: ignoring unreadable archive %s on the class path\n", part);
+                continue;
+            }
+        } else {
+            entry.directory = calloc(1, sizeof(Directory));
+            entry.directory->path = strdup(part);
+        }
+
+        classpath.entries = realloc(classpath.entries, sizeof(ClassPathEntry) * (classpath.count + 1));
+        classpath.entries[classpath.count++] = entry;
+        classpath.stamp = hash_update(classpath.stamp, part, length + 1);
+    }
+
+    free(copy);
+}
+
+uint32_t classpath_stamp(void)
+{
+    return classpath.stamp;
+}
+
+bool classpath_class_stamp(const char *name, uint32_t *stamp)
+{
+    if (!classpath.initialized)
+        classpath_init(".");
+
+    char path[2048];
+    int length = snprintf(path, sizeof(path), "%s.class", name);
+    if (length >= (int) sizeof(path))
+        return false;
+
+    /* Looks in the same order as classpath_find, without reading the class */
+    for (int i = 0; i < classpath.count; i++) {
+        ClassPathEntry *entry = &classpath.entries[i];
+        uint32_t hash = hash_update(HASH_SEED, &i, sizeof(i));
+
+        if (entry->jar) {
+            NameKey key = { path, length, hash_bytes(path, length) };
+            JarEntry *found = hash_table_find(&entry->jar->entries, sizeof(JarEntry), key.hash, jar_entry_match, &key);
+            if (!found)
+                continue;
+
+            hash = hash_update(hash, &found->crc, sizeof(found->crc));
+            *stamp = hash_update(hash, &found->size, sizeof(found->size));
+            return true;
+        }
+
+        pthread_mutex_lock(&classpath.lock);
+        bool listed = directory_contains(entry->directory, path);
+        pthread_mutex_unlock(&classpath.lock);
+        if (!listed)
+            continue;
+
+        char file[4096];
+        snprintf(file, sizeof(file), "%s/%s", entry->directory->path, path);
+
+        struct stat filestat;
+        if (stat(file, &filestat) < 0)
+            continue;
+
+        hash = hash_update(hash, &filestat.st_size, sizeof(filestat.st_size));
+        hash = hash_update(hash, &filestat.st_mtim.tv_sec, sizeof(filestat.st_mtim.tv_sec));
+        *stamp = hash_update(hash, &filestat.st_mtim.tv_nsec, sizeof(filestat.st_mtim.tv_nsec));
+        return true;
+    }
+
+    return false;
+}
+
+void classpath_free(void)
+{
+    for (int i = 0; i < classpath.count; i++) {
+        ClassPathEntry *entry = &classpath.entries[i];
+        if (entry->jar)
+            jar_close(entry->jar);
+        else
+            directory_free(entry->directory);
+    }
+
+    free(classpath.entries);
+    classpath.entries = NULL;
+    classpath.count = 0;
+    classpath.initialized = false;
+    name_table_free(&classpath.missing, NULL);
+}
+
+bool classpath_find(char *name, ClassBytes *bytes)
+{
+    /* An explicit class path stays empty if none of its entries are usable */
+    if (!classpath.initialized)
+        classpath_init(".");
+
+    char path[2048];
+    int length = snprintf(path, sizeof(path), "%s.class", name);
+    if (length >= (int) sizeof(path))
+        return false;
+
+    /* Directories are listed once, so files added while running are not seen */
+    pthread_mutex_lock(&classpath.lock);
+    bool missing = name_table_find(&classpath.missing, path, length);
+    pthread_mutex_unlock(&classpath.lock);
+    if (missing)
+        return false;
+
+    /* Earlier entries win, like the reference implementation */
+    for (int i = 0; i < classpath.count; i++) {
+        ClassPathEntry *entry = &classpath.entries[i];
+        if (entry->jar) {
+            if (jar_find(entry->jar, path, length, bytes))
+                return true;
+            continue;
+        }
+
+        pthread_mutex_lock(&classpath.lock);
+        bool listed = directory_contains(entry->directory, path);
+        pthread_mutex_unlock(&classpath.lock);
+        if (!listed)
+            continue;
+
+        char file[4096];
+        snprintf(file, sizeof(file), "%s/%s", entry->directory->path, path);
+
+        size_t size;
+        uint8_t *data = classpath_map(file, &size);
+        if (data) {
+            /* Parsing reads the file front to back exactly once */
+            madvise(data, size, MADV_SEQUENTIAL);
+            madvise(data, size, MADV_WILLNEED);
+
+            bytes->kind = CLASS_BYTES_MAPPED;
+            bytes->data = data;
+            bytes->size = size;
+            return true;
+        }
+    }
+
+    pthread_mutex_lock(&classpath.lock);
+    name_table_add(&classpath.missing, path, length);
+    pthread_mutex_unlock(&classpath.lock);
+
+    return false;
+}
+
+void classpath_release(ClassBytes *bytes)
+{
+    switch (bytes->kind) {
+        case CLASS_BYTES_MAPPED:
+            munmap(bytes->data, bytes->size);
+            break;
+        case CLASS_BYTES_ALLOCATED:
+            free(bytes->data);
+            break;
+        case CLASS_BYTES_BORROWED:
+            break;
+    }
+
+    bytes->data = NULL;
+    bytes->size = 0;
+}
\ No newline at end of file
@@ -0,0 +1,69 @@
+/*
+ * This file is part of MiniJVM (https://github.com/muhammad23012009/minijvm)
+ * Copyright (c) 2025 Muhammad  <thevancedgamer@mentallysanemainliners.org>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef CLASSPATH_H
+#define CLASSPATH_H
+
+/* Finds class files on the class path, a colon separated list of
+ * directories and JAR files. Each package directory is listed once on first
+ * use and class files are mapped straight from disk. JARs are mapped once
+ * and their central directory is indexed by entry name, so stored entries
+ * are served from the mapping without a copy and deflated ones are inflated
+ * in one go. Names found nowhere are remembered, so looking them up again
+ * costs no system calls.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+typedef enum ClassBytesKind {
+    /* A read-only mapping of a loose class file, unmapped on release */
+    CLASS_BYTES_MAPPED,
+    /* An inflated JAR entry, freed on release */
+    CLASS_BYTES_ALLOCATED,
+    /* A stored JAR entry inside the archive's mapping, which outlives it */
+    CLASS_BYTES_BORROWED,
+} ClassBytesKind;
+
+/* The bytes are read-only. Code is copied to the class's arena before
+ * method_prepare rewrites it
+ */
+typedef struct ClassBytes {
+    ClassBytesKind kind;
+    uint8_t *data;
+    size_t size;
+} ClassBytes;
+
+/* Defaults to the current directory if never called */
+extern void classpath_init(char *path);
+extern void classpath_free(void);
+
+/* Changes with the class path's entries, not with what is in them */
+extern uint32_t classpath_stamp(void);
+
+/* Changes with the file classpath_find would read `name` from: which entry
+ * it is in, and its size and modification time, or for a JAR entry its
+ * size and CRC. Returns false if no entry has the class.
+ */
+extern bool classpath_class_stamp(const char *name, uint32_t *stamp);
+
+/* `name` is a binary class name such as java/lang/Object */
+extern bool classpath_find(char *name, ClassBytes *bytes);
+extern void classpath_release(ClassBytes *bytes);
+
+#endif
\ No newline at end of file
@@ -16,182 +16,302 @@
  */
 
 #include "constantpool.h"
+#include "descriptor.h"
 #include "reader.h"
+#include "simd.h"
+#include "builtins/builtins.h"
 
+/* Indexes read from the class file are only checked here, out of range ones
+ * have no tag
+ */
 uint8_t constant_pool_get_tag(ConstantPool *pool, uint16_t index)
 {
-    return pool->pool[index].tag;
+    return index < pool->count ? pool->tags[index] : 0;
 }
 
-char *constant_pool_resolve_string(ConstantPool *pool, uint16_t index)
+/* Whether `index` can be loaded by ldc or passed to a bootstrap method */
+bool constant_pool_is_loadable(ConstantPool *pool, uint16_t index)
 {
-    ConstantPoolInfo info = pool->pool[index];
-    if (info.tag == CONSTANT_CLASS) {
-        // Resolve to the actual tag
-        info = pool->pool[info.class_index];
+    switch (constant_pool_get_tag(pool, index)) {
+        case CONSTANT_INT:
+        case CONSTANT_FLOAT:
+        case CONSTANT_LONG:
+        case CONSTANT_DOUBLE:
+        case CONSTANT_CLASS:
+        case CONSTANT_STRING:
+        case CONSTANT_METHODHANDLE:
+        case CONSTANT_METHODTYPE:
+        case CONSTANT_DYNAMIC_INFO:
+            return true;
+        default:
+            return false;
     }
+}
 
-    if (info.tag == CONSTANT_STRING) {
-        info = pool->pool[info.string_index];
+/* Follows Class and String entries to their name. Anything else resolves to
+ * the empty symbol, so the result is always safe to use as a symbol.
+ */
+Symbol *constant_pool_resolve_symbol(ConstantPool *pool, uint16_t index)
+{
+    uint8_t tag = constant_pool_get_tag(pool, index);
+    if (tag == CONSTANT_CLASS || tag == CONSTANT_STRING) {
+        // Resolve to the actual tag
+        index = constant_pool_first_index(pool, index);
+        tag = pool->tags[index];
     }
 
-    if (info.tag == CONSTANT_UTF8) {
-        return (char*) info.byte_ref.bytes;
+    if (tag == CONSTANT_UTF8) {
+        return pool->resolved[index];
     }
 
-    return "";
+    return vm_symbols.empty;
 }
 
-/* Used by both methods and fields */
-char *constant_pool_resolve_class_name(ConstantPool *pool, uint16_t index)
+char *constant_pool_resolve_string(ConstantPool *pool, uint16_t index)
 {
-    ConstantPoolInfo info = pool->pool[index];
-    if (info.tag == CONSTANT_METHODREF) {
-        info = pool->pool[info.method_ref.class_index];
-    }
+    return constant_pool_resolve_symbol(pool, index)->bytes;
+}
 
-    if (info.tag == CONSTANT_FIELDREF) {
-        info = pool->pool[info.field_ref.class_index];
+/* Returns the CONSTANT_Class entry for a class, field or method reference */
+uint16_t constant_pool_get_class_index(ConstantPool *pool, uint16_t index)
+{
+    uint8_t tag = constant_pool_get_tag(pool, index);
+    if (tag == CONSTANT_FIELDREF || tag == CONSTANT_METHODREF || tag == CONSTANT_INTERFACE_METHODREF) {
+        index = constant_pool_first_index(pool, index);
     }
 
-    return constant_pool_resolve_string(pool, info.class_index);
+    return index;
 }
 
-char *constant_pool_resolve_field_name(ConstantPool *pool, uint16_t index)
+/* Returns the CONSTANT_NameAndType entry for a field, method or dynamic reference */
+uint16_t constant_pool_get_name_and_type_index(ConstantPool *pool, uint16_t index)
 {
-    ConstantPoolInfo info = pool->pool[index];
-    if (info.tag == CONSTANT_METHODREF) {
-        info = pool->pool[info.method_ref.name_and_type_index];
+    uint8_t tag = constant_pool_get_tag(pool, index);
+    if (tag == CONSTANT_FIELDREF || tag == CONSTANT_METHODREF || tag == CONSTANT_INTERFACE_METHODREF ||
+        tag == CONSTANT_DYNAMIC_INFO || tag == CONSTANT_INVOKEDYNAMIC) {
+        index = constant_pool_second_index(pool, index);
     }
 
-    if (info.tag == CONSTANT_FIELDREF) {
-        info = pool->pool[info.field_ref.name_and_type_index];
-    }
+    return index;
+}
 
-    return constant_pool_resolve_string(pool, info.name_and_type_info.name_index);
+/* Used by both methods and fields */
+char *constant_pool_resolve_class_name(ConstantPool *pool, uint16_t index)
+{
+    return constant_pool_resolve_string(pool, constant_pool_get_class_index(pool, index));
+}
+
+char *constant_pool_resolve_field_name(ConstantPool *pool, uint16_t index)
+{
+    uint16_t name_and_type = constant_pool_get_name_and_type_index(pool, index);
+    return constant_pool_resolve_string(pool, constant_pool_first_index(pool, name_and_type));
 }
 
 int constant_pool_resolve_int(ConstantPool *pool, uint16_t index)
 {
-    ConstantPoolInfo info = pool->pool[index];
-    if (info.tag == CONSTANT_INT) {
-        return info.int_val;
+    if (constant_pool_get_tag(pool, index) == CONSTANT_INT) {
+        return pool->values[index];
     }
 
     return -1;
 }
 
-/* I am not proud of this code... Need to find a better way to resolve classes */
-bool constant_pool_resolve_unknowns(ConstantPool *pool, Classes *classes, Class *parent)
+int64_t constant_pool_resolve_long(ConstantPool *pool, uint16_t index)
 {
-    for (int i = 1; i < pool->count; i++) {
-        ConstantPoolInfo *info = &pool->pool[i];
-        switch (info->tag) {
-            case CONSTANT_CLASS: {
-                int length;
-                char class_path[2048];
-                char *class_name = constant_pool_resolve_string(pool, info->class_index);
-                if (!strcmp(class_name, parent->name))
-                    continue;
-
-                if (*class_name == '[') {
-                    /* Java array. Skip this character */
-                    class_name++;
-                }
+    if (constant_pool_get_tag(pool, index) == CONSTANT_LONG) {
+        return (int64_t) (((uint64_t) pool->values[index] << 32) | pool->values[index + 1]);
+    }
 
-                if (*class_name == 'L' && *(class_name + strlen(class_name) - 1) == ';') {
-                    /* Java object */
-                    printf("Got a Java object!\n");
-                    class_name++;
-                    class_name[strlen(class_name) - 1] = '\0';
-                }
+    return 0;
+}
+
+/* Resolves a CONSTANT_String entry to its interned String object. This only
+ * happens once per entry, every later `ldc` reuses the cached object.
+ */
+Object *constant_pool_resolve_string_object(ConstantPool *pool, uint16_t index, Classes *classes)
+{
+    if (!pool->resolved[index]) {
+        Symbol *utf8 = constant_pool_resolve_symbol(pool, index);
+        Class *string_class = classes_get_class(classes, "java/lang/String");
+        pool->resolved[index] = string_intern_utf8(string_class, utf8->bytes, utf8->length);
+    }
+
+    return pool->resolved[index];
+}
 
-                if (classes_get_class(classes, class_name))
-                    continue;
+static bool constant_pool_is(ConstantPool *pool, uint16_t index, uint8_t tag)
+{
+    return index > 0 && constant_pool_get_tag(pool, index) == tag;
+}
 
-                printf("Found unknown class %s, will try to resolve.\n", class_name);
+/* Whether `index` is a Utf8 entry holding a well-formed method descriptor */
+static bool constant_pool_is_method_descriptor(ConstantPool *pool, uint16_t index)
+{
+    return constant_pool_is(pool, index, CONSTANT_UTF8) &&
+           descriptor_is_valid_method(((Symbol*) pool->resolved[index])->bytes);
+}
 
-                snprintf(class_path, 2048, "%s%s", class_name, ".class");
+/* Whether `index` is a NameAndType entry of a method */
+static bool constant_pool_is_method(ConstantPool *pool, uint16_t index)
+{
+    return constant_pool_is(pool, index, CONSTANT_NAMEANDTYPE) &&
+           constant_pool_is_method_descriptor(pool, constant_pool_second_index(pool, index));
+}
 
-                if (!classes_add_class(classes, class_parse_file(classes, class_path))) {
-                    fprintf(stderr, "Failed to resolve dependencies!\n");
-                    return false;
-                }
-            }
+/* Checks that every entry refers to entries of the right kind, so resolving
+ * never has to. The second entry of a long is tagged 0 and never matches.
+ */
+static bool constant_pool_verify(ConstantPool *pool)
+{
+    for (int i = 1; i < pool->count; i++) {
+        uint16_t first = constant_pool_first_index(pool, i);
+        uint16_t second = constant_pool_second_index(pool, i);
+        bool valid = true;
+        switch (pool->tags[i]) {
+            case CONSTANT_CLASS:
+            case CONSTANT_STRING:
+                valid = constant_pool_is(pool, first, CONSTANT_UTF8);
+                break;
+            case CONSTANT_METHODTYPE:
+                valid = constant_pool_is_method_descriptor(pool, first);
+                break;
+            case CONSTANT_NAMEANDTYPE:
+                valid = constant_pool_is(pool, first, CONSTANT_UTF8) && constant_pool_is(pool, second, CONSTANT_UTF8);
+                break;
+            case CONSTANT_FIELDREF:
+                valid = constant_pool_is(pool, first, CONSTANT_CLASS) && constant_pool_is(pool, second, CONSTANT_NAMEANDTYPE);
+                break;
+            /* Calls parse their descriptor, so it has to be well-formed */
+            case CONSTANT_METHODREF:
+            case CONSTANT_INTERFACE_METHODREF:
+                valid = constant_pool_is(pool, first, CONSTANT_CLASS) && constant_pool_is_method(pool, second);
+                break;
+            case CONSTANT_DYNAMIC_INFO:
+                valid = constant_pool_is(pool, second, CONSTANT_NAMEANDTYPE);
+                break;
+            case CONSTANT_INVOKEDYNAMIC:
+                valid = constant_pool_is_method(pool, second);
+                break;
+            case CONSTANT_METHODHANDLE:
+                /* REF_getField to REF_putStatic point at fields, the rest at methods */
+                if (first >= 1 && first <= 4)
+                    valid = constant_pool_is(pool, second, CONSTANT_FIELDREF);
+                else if (first >= 5 && first <= 9)
+                    valid = constant_pool_is(pool, second, CONSTANT_METHODREF) ||
+                            constant_pool_is(pool, second, CONSTANT_INTERFACE_METHODREF);
+                else
+                    valid = false;
+                break;
+            default:
+                break;
+        }
+
+        if (!valid) {
+            printf("Invalid reference in constant pool entry %d!\n", i);
+            return false;
         }
     }
 
     return true;
 }
 
-/* Creates the constant pool array from a data reader */
-ConstantPool *constant_pool_new(Reader *reader)
+/* Creates the constant pool arrays from a data reader, in the class's arena.
+ * Returns NULL if the pool is truncated or malformed.
+ */
+ConstantPool *constant_pool_new(Reader *reader, Arena *arena)
 {
-    ConstantPool *cpool = malloc(sizeof(ConstantPool));
+    ConstantPool *cpool = arena_alloc(arena, sizeof(ConstantPool));
     cpool->count = reader_read_uint16_be(reader);
-    cpool->pool = malloc(sizeof(ConstantPoolInfo) * (cpool->count + 1));
+    /* One spare entry, so a trailing long still has room for its low word */
+    cpool->tags = arena_alloc(arena, sizeof(uint8_t) * (cpool->count + 1));
+    cpool->values = arena_alloc(arena, sizeof(uint32_t) * (cpool->count + 1));
+    cpool->resolved = arena_alloc(arena, sizeof(void*) * (cpool->count + 1));
 
     for (int i = 1; i < cpool->count; i++) {
-        ConstantPoolInfo *cp_info = &cpool->pool[i];
-        cp_info->tag = reader_read_uint8(reader);
-        switch (cp_info->tag) {
-            case CONSTANT_UTF8:
-                cp_info->byte_ref.length = reader_read_uint16_be(reader);
-                cp_info->byte_ref.bytes = malloc(cp_info->byte_ref.length);
-                reader_read_bytes(reader, cp_info->byte_ref.bytes, cp_info->byte_ref.length);
+        uint8_t tag = reader_read_uint8(reader);
+        cpool->tags[i] = tag;
+        switch (tag) {
+            case CONSTANT_UTF8: {
+                uint16_t length = reader_read_uint16_be(reader);
+                uint8_t *bytes = reader_get_bytes(reader, length);
+                if (!bytes)
+                    break;
+
+                /* Symbols are NUL-terminated, a NUL inside one would cut it short */
+                if (!simd_modified_utf8_valid(bytes, length)) {
+                    printf("Malformed UTF-8 in constant pool entry %d!\n", i);
+                    return NULL;
+                }
+
+                cpool->resolved[i] = symbol_intern((const char*) bytes, length);
                 break;
+            }
             case CONSTANT_INT:
-                cp_info->int_val = reader_read_uint32_be(reader);
+            case CONSTANT_FLOAT:
+                cpool->values[i] = reader_read_uint32_be(reader);
                 break;
-            case CONSTANT_CLASS:
-                cp_info->class_index = reader_read_uint16_be(reader);
+            case CONSTANT_LONG:
+            case CONSTANT_DOUBLE:
+                /* 8-byte constants take up two entries, the second is unusable
+                 * and keeps the low word
+                 */
+                if (i + 1 == cpool->count) {
+                    printf("8-byte constant in the last constant pool entry!\n");
+                    return NULL;
+                }
+
+                cpool->values[i] = reader_read_uint32_be(reader);
+                cpool->values[++i] = reader_read_uint32_be(reader);
                 break;
+            case CONSTANT_CLASS:
             case CONSTANT_STRING:
-                cp_info->string_index = reader_read_uint16_be(reader);
+            case CONSTANT_METHODTYPE:
+                cpool->values[i] = (uint32_t) reader_read_uint16_be(reader) << 16;
                 break;
-            case CONSTANT_FIELDREF:
-                cp_info->field_ref.class_index = reader_read_uint16_be(reader);
-                cp_info->field_ref.name_and_type_index = reader_read_uint16_be(reader);
+            case CONSTANT_METHODHANDLE:
+                cpool->values[i] = (uint32_t) reader_read_uint8(reader) << 16;
+                cpool->values[i] |= reader_read_uint16_be(reader);
                 break;
+            case CONSTANT_FIELDREF:
             case CONSTANT_METHODREF:
-                cp_info->method_ref.class_index = reader_read_uint16_be(reader);
-                cp_info->method_ref.name_and_type_index = reader_read_uint16_be(reader);
-                break;
+            case CONSTANT_INTERFACE_METHODREF:
             case CONSTANT_NAMEANDTYPE:
-                cp_info->name_and_type_info.name_index = reader_read_uint16_be(reader);
-                cp_info->name_and_type_info.descriptor_index = reader_read_uint16_be(reader);
-                break;
             case CONSTANT_DYNAMIC_INFO:
             case CONSTANT_INVOKEDYNAMIC:
-                uint16_t bootstrap_index = reader_read_uint16_be(reader);
-                uint16_t name_and_type_info = reader_read_uint16_be(reader);
-                printf("testing!, bootstrap index: %d, name-and-type: %d\n", bootstrap_index, name_and_type_info);
-                break;
-            case 0xF:
-                uint8_t ref_kind = reader_read_uint8(reader);
-                uint16_t ref_index = reader_read_uint16_be(reader);
-                printf("got method handle! kind is %d, index is %d\n", ref_kind, ref_index);
+                cpool->values[i] = (uint32_t) reader_read_uint16_be(reader) << 16;
+                cpool->values[i] |= reader_read_uint16_be(reader);
                 break;
             default:
-                printf("Unknown constant pool type 0x%x!\n", cp_info->tag);
+                if (!reader->overflow) {
+                    printf("Unknown constant pool type 0x%x!\n", tag);
+                    return NULL;
+                }
+        }
+
+        if (reader->overflow) {
+            printf("Truncated constant pool!\n");
+            return NULL;
         }
     }
 
-    return cpool;
+    return constant_pool_verify(cpool) ? cpool : NULL;
 }
 
+/* The pool itself goes with the class's arena, this only frees what was
+ * linked at run time
+ */
 void constant_pool_free(ConstantPool *pool)
 {
-    for (int i = 0; i < pool->count; i++) {
-        ConstantPoolInfo info = pool->pool[i];
-        switch (info.tag) {
-            case CONSTANT_UTF8:
-                free(info.byte_ref.bytes);
+    for (int i = 1; i < pool->count; i++) {
+        switch (pool->tags[i]) {
+            case CONSTANT_INVOKEDYNAMIC:
+                string_concat_free(pool->resolved[i]);
+                break;
+            case CONSTANT_INTERFACE_METHODREF:
+                free(pool->resolved[i]);
+                break;
             default:
                 break;
         }
     }
-
-    free(pool->pool);
-    free(pool);
-}
+}
\ No newline at end of file
@@ -19,8 +19,10 @@
 #define CONSTANTPOOL_H
 
 #include <stdint.h>
+#include "arena.h"
 #include "method.h"
 #include "reader.h"
+#include "symbol.h"
 
 /* Constant pool tags */
 #define CONSTANT_UTF8       0x01
@@ -32,57 +34,55 @@
 #define CONSTANT_STRING     0x08
 #define CONSTANT_FIELDREF   0x09
 #define CONSTANT_METHODREF  0x0A
+#define CONSTANT_INTERFACE_METHODREF    0x0B
 #define CONSTANT_NAMEANDTYPE    0x0C
+#define CONSTANT_METHODHANDLE   0x0F
+#define CONSTANT_METHODTYPE     0x10
 #define CONSTANT_DYNAMIC_INFO   0x11
 #define CONSTANT_INVOKEDYNAMIC  0x12
 
 typedef struct Classes Classes;
 typedef struct Class Class;
 typedef struct Variant Variant;
+typedef struct Object Object;
 
-typedef struct ConstantPoolInfo {
-    uint8_t tag;
-    union {
-        uint32_t int_val;
-        uint32_t float_val;
-        uint16_t string_index;
-        uint16_t name_index;
-
-        uint16_t class_index;
-
-        struct {
-            uint32_t high_bytes;
-            uint32_t low_bytes;
-        } long_val;
-
-        struct {
-            uint16_t class_index;
-            uint16_t name_and_type_index;
-        } field_ref;
-
-        struct {
-            uint16_t class_index;
-            uint16_t name_and_type_index;
-        } method_ref;
-
-        struct {
-            uint16_t length;
-            uint8_t *bytes;
-        } byte_ref;
-
-        struct {
-            uint16_t name_index;
-            uint16_t descriptor_index;
-        } name_and_type_info;
-    };
-} ConstantPoolInfo;
-
+/* The pool is kept as parallel arrays, so walking tags or following index
+ * chains during resolution touches a byte and a word per entry.
+ *
+ * values holds each entry's operands: Integer and Float bits, the high word
+ * of a Long or Double (the low word is in the unusable entry after it), and
+ * indexes. An entry with one index keeps it in the upper 16 bits, the second
+ * of two indexes (or a MethodHandle's reference) goes in the lower 16 bits.
+ *
+ * resolved holds the pointers: the Symbol of a Utf8 entry, the Class of a
+ * Class entry and the String object of a String entry, both loaded on first
+ * resolution, the call site of an InvokeDynamic entry, linked on first
+ * execution, and the InterfaceCall of an InterfaceMethodref, resolved on
+ * the first invokeinterface through it.
+ */
 typedef struct ConstantPool {
     uint16_t count;
-    /* Array of pool items */
-    ConstantPoolInfo *pool;
+    uint8_t *tags;
+    uint32_t *values;
+    void **resolved;
 } ConstantPool;
 
+/* Name of a Class, String, NameAndType or MethodType entry, the class of a
+ * field or method reference, or the bootstrap method of an InvokeDynamic
+ */
+static inline uint16_t constant_pool_first_index(ConstantPool *pool, uint16_t index)
+{
+    return pool->values[index] >> 16;
+}
+
+/* NameAndType of a field, method or InvokeDynamic reference, descriptor of
+ * a NameAndType, or the reference of a MethodHandle
+ */
+static inline uint16_t constant_pool_second_index(ConstantPool *pool, uint16_t index)
+{
+    return pool->values[index] & 0xFFFF;
+}
+
 typedef struct Interface {
     uint16_t index;
     char *interface;
@@ -90,14 +90,19 @@ typedef struct Interface {
 
 /* Helper functions */
 extern uint8_t constant_pool_get_tag(ConstantPool *pool, uint16_t index);
+extern bool constant_pool_is_loadable(ConstantPool *pool, uint16_t index);
 extern char *constant_pool_resolve_string(ConstantPool *pool, uint16_t index);
+extern Symbol *constant_pool_resolve_symbol(ConstantPool *pool, uint16_t index);
 
 extern char *constant_pool_resolve_class_name(ConstantPool *pool, uint16_t index);
 extern char *constant_pool_resolve_field_name(ConstantPool *pool, uint16_t index);
 extern int constant_pool_resolve_int(ConstantPool *pool, uint16_t index);
-extern bool constant_pool_resolve_unknowns(ConstantPool *pool, Classes *classes, Class *parent);
+extern int64_t constant_pool_resolve_long(ConstantPool *pool, uint16_t index);
+extern uint16_t constant_pool_get_class_index(ConstantPool *pool, uint16_t index);
+extern uint16_t constant_pool_get_name_and_type_index(ConstantPool *pool, uint16_t index);
+extern Object *constant_pool_resolve_string_object(ConstantPool *pool, uint16_t index, Classes *classes);
 
-extern ConstantPool *constant_pool_new(Reader *reader);
+extern ConstantPool *constant_pool_new(Reader *reader, Arena *arena);
 extern void constant_pool_free(ConstantPool *pool);
 
 #endif
\ No newline at end of file
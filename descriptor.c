@@ -1,5 +1,19 @@
 #include "descriptor.h"
 #include <stdio.h>
+#include <pthread.h>
+#include "arena.h"
+#include "hashtable.h"
+#include "symbol.h"
+
+/* Keyed by descriptor symbol. Records come from the arena and live until
+ * descriptor_table_free.
+ */
+static struct {
+    HashTable index;
+    Arena arena;
+} table;
+
+static pthread_mutex_t table_lock = PTHREAD_MUTEX_INITIALIZER;
 
 char *get_argument_end(char *argument_start)
 {
@@ -23,8 +37,11 @@ int get_descriptor_count(char *descriptor)
         while (*descriptor == '[')
             descriptor++;
 
+        /* A class name without its ';' ends the count */
         if (*descriptor == 'L') {
             descriptor = strchr(descriptor, ';');
+            if (!descriptor)
+                break;
         }
 
         descriptor++;
@@ -38,6 +55,7 @@ Descriptor parse_descriptor(char **string, char *end)
 {
     Descriptor descriptor;
     descriptor.array_dimesions_count = 0;
+    descriptor.object_name = NULL;
 
     if (**string == '(')
         *string = *string + 1;
@@ -63,32 +81,127 @@ Descriptor parse_descriptor(char **string, char *end)
             descriptor.type = DESCRIPTOR_INT;
             break;
         }
+        case 'Z': {
+            descriptor.type = DESCRIPTOR_BOOLEAN;
+            break;
+        }
+        case 'B': {
+            descriptor.type = DESCRIPTOR_BYTE;
+            break;
+        }
+        case 'C': {
+            descriptor.type = DESCRIPTOR_CHAR;
+            break;
+        }
+        case 'S': {
+            descriptor.type = DESCRIPTOR_SHORT;
+            break;
+        }
+        case 'J': {
+            descriptor.type = DESCRIPTOR_LONG;
+            break;
+        }
+        case 'F': {
+            descriptor.type = DESCRIPTOR_FLOAT;
+            break;
+        }
+        case 'D': {
+            descriptor.type = DESCRIPTOR_DOUBLE;
+            break;
+        }
         case 'L': {
             /* Object type */
+            char *name_end = strchr(*string, ';');
             descriptor.type = DESCRIPTOR_OBJECT;
-            descriptor.object_name = strndup(++*string, end - *string - 1);
-            /* Skip the entire string */
-            if (!(*string = strchr(*string, ';'))) {
-                *string = NULL;
-            }
-            *string++;
+            if (!name_end)
+                return descriptor;
+
+            descriptor.object_name = symbol_intern(*string + 1, name_end - *string - 1)->bytes;
+            /* Skip the entire name, the ';' is skipped below */
+            *string = name_end;
             break;
         }
         default: {
             /* No arguments. */
             descriptor.type = DESCRIPTOR_VOID;
-            descriptor.object_name = NULL;
-            break;
+            return descriptor;
         }
     }
 
-    *string++;
+    (*string)++;
     return descriptor;
 }
 
-Descriptors *descriptors_new(char *descriptor_str)
+/* Skips one field type, or returns NULL if there isn't one */
+static const char *descriptor_skip_field(const char *descriptor)
+{
+    while (*descriptor == '[')
+        descriptor++;
+
+    switch (*descriptor) {
+        case 'B':
+        case 'C':
+        case 'D':
+        case 'F':
+        case 'I':
+        case 'J':
+        case 'S':
+        case 'Z':
+            return descriptor + 1;
+        case 'L': {
+            const char *name_end = strchr(descriptor, ';');
+            return name_end && name_end > descriptor + 1 ? name_end + 1 : NULL;
+        }
+        default:
+            return NULL;
+    }
+}
+
+bool descriptor_is_valid_method(const char *descriptor)
 {
-    Descriptors *descriptors = malloc(sizeof(Descriptors));
+    if (*descriptor++ != '(')
+        return false;
+
+    while (*descriptor != ')') {
+        descriptor = descriptor_skip_field(descriptor);
+        if (!descriptor)
+            return false;
+    }
+
+    descriptor++;
+    if (*descriptor == 'V')
+        return !descriptor[1];
+
+    descriptor = descriptor_skip_field(descriptor);
+    return descriptor && !*descriptor;
+}
+
+int descriptor_slots(Descriptor *descriptor)
+{
+    return descriptor->kind == DESCRIPTOR_KIND_LONG ? 2 : 1;
+}
+
+static DescriptorKind descriptor_kind(Descriptor *descriptor)
+{
+    if (descriptor->array_dimesions_count)
+        return DESCRIPTOR_KIND_REFERENCE;
+
+    switch (descriptor->type) {
+        case DESCRIPTOR_VOID:
+            return DESCRIPTOR_KIND_VOID;
+        case DESCRIPTOR_OBJECT:
+            return DESCRIPTOR_KIND_REFERENCE;
+        case DESCRIPTOR_LONG:
+        case DESCRIPTOR_DOUBLE:
+            return DESCRIPTOR_KIND_LONG;
+        default:
+            return DESCRIPTOR_KIND_INT;
+    }
+}
+
+static Descriptors *descriptors_parse(char *descriptor_str)
+{
+    Descriptors *descriptors = arena_alloc(&table.arena, sizeof(Descriptors));
     char *argument_start = descriptor_str;
     char *argument_end = get_argument_end(argument_start);
     char *returns_start = *argument_end != '\0' ? argument_end + 1 : NULL;
@@ -97,23 +210,62 @@ Descriptors *descriptors_new(char *descriptor_str)
 
     descriptors->arguments_count = get_descriptor_count(argument_start);
 
-    descriptors->arguments = calloc(descriptors->arguments_count, sizeof(Descriptor));
+    descriptors->arguments = arena_alloc(&table.arena, sizeof(Descriptor) * descriptors->arguments_count);
 
+    /* Lay the arguments out in the callee's locals once, here */
+    descriptors->arguments_slots = 0;
     for (int i = 0; i < descriptors->arguments_count; i++) {
-        descriptors->arguments[i] = parse_descriptor(&argument_start, argument_end);
+        Descriptor *argument = &descriptors->arguments[i];
+        *argument = parse_descriptor(&argument_start, argument_end);
+        argument->kind = descriptor_kind(argument);
+        argument->slot = descriptors->arguments_slots;
+        descriptors->arguments_slots += descriptor_slots(argument);
     }
 
-    if (returns_start)
+    if (returns_start) {
         descriptors->return_descriptor = parse_descriptor(&returns_start, NULL);
+    } else {
+        descriptors->return_descriptor.type = DESCRIPTOR_VOID;
+        descriptors->return_descriptor.object_name = NULL;
+        descriptors->return_descriptor.array_dimesions_count = 0;
+    }
+    descriptors->return_descriptor.kind = descriptor_kind(&descriptors->return_descriptor);
+    descriptors->return_descriptor.slot = 0;
 
     return descriptors;
 }
 
-void descriptors_free(Descriptors *descriptors)
+static bool descriptors_match(const void *entry, const void *key)
 {
-    if (!descriptors)
-        return;
+    return (*(Descriptors* const*) entry)->descriptor == key;
+}
+
+static uint32_t descriptors_hash(const void *entry)
+{
+    return symbol_of((*(Descriptors* const*) entry)->descriptor)->hash;
+}
+
+Descriptors *descriptors_intern(char *descriptor)
+{
+    pthread_mutex_lock(&table_lock);
+
+    hash_table_reserve(&table.index, sizeof(Descriptors*), 256, descriptors_hash);
 
-    free(descriptors->arguments);
-    free(descriptors);
+    Descriptors **slot = hash_table_probe(&table.index, sizeof(Descriptors*), symbol_of(descriptor)->hash,
+                                          descriptors_match, descriptor);
+    if (!*slot) {
+        *slot = descriptors_parse(descriptor);
+        table.index.count++;
+    }
+
+    Descriptors *descriptors = *slot;
+    pthread_mutex_unlock(&table_lock);
+    return descriptors;
+}
+
+void descriptor_table_free(void)
+{
+    hash_table_free(&table.index);
+    arena_free(&table.arena);
+    memset(&table, 0, sizeof(table));
 }
\ No newline at end of file
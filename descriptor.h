@@ -5,6 +5,10 @@
  * and is passed to Java methods (native or interpreted) to figure out
  * what arguments we need to push to locals of method and then pop from that
  * method's stack.
+ *
+ * Descriptors are interned VM-wide by their descriptor symbol, every method
+ * with the same signature shares one record and nothing frees it before
+ * descriptor_table_free.
 */
 
 #include <stdlib.h>
@@ -15,17 +19,41 @@ typedef enum {
     DESCRIPTOR_VOID,
     DESCRIPTOR_INT,
     DESCRIPTOR_OBJECT,
+    DESCRIPTOR_BOOLEAN,
+    DESCRIPTOR_BYTE,
+    DESCRIPTOR_CHAR,
+    DESCRIPTOR_SHORT,
+    DESCRIPTOR_LONG,
+    DESCRIPTOR_FLOAT,
+    DESCRIPTOR_DOUBLE,
 } DescriptorType;
 
+/* How a value is carried between frames, which is all a call needs to know */
+typedef enum {
+    DESCRIPTOR_KIND_VOID,
+    /* int, boolean, byte, char, short and float take one local slot */
+    DESCRIPTOR_KIND_INT,
+    /* long and double take two local slots */
+    DESCRIPTOR_KIND_LONG,
+    /* Objects and arrays */
+    DESCRIPTOR_KIND_REFERENCE,
+} DescriptorKind;
+
 typedef struct Descriptor {
     DescriptorType type;
+    DescriptorKind kind;
+    /* Symbol bytes of the class name, for objects and arrays of objects */
     char *object_name;
     /* The number of dimensions of the array (if descriptor is an array) */
     int array_dimesions_count;
+    /* Local variable slot of an argument, counted from the first argument */
+    int slot;
 } Descriptor;
 
 typedef struct Descriptors {
     int arguments_count;
+    /* Local variable slots taken by the arguments, longs and doubles take two */
+    int arguments_slots;
 
     /* Java-style descriptor (e.g. ()V)
      * () means no arguments
@@ -39,7 +67,13 @@ typedef struct Descriptors {
 
 extern int get_descriptor_count(char *descriptor);
 
-extern Descriptors *descriptors_new(char *descriptor);
-extern void descriptors_free(Descriptors *descriptor);
+extern int descriptor_slots(Descriptor *descriptor);
+
+/* Whether `descriptor` is a complete method descriptor such as (I[Ljava/lang/String;)V */
+extern bool descriptor_is_valid_method(const char *descriptor);
+
+/* `descriptor` has to be symbol bytes. Safe to call from any thread */
+extern Descriptors *descriptors_intern(char *descriptor);
+extern void descriptor_table_free(void);
 
 #endif
\ No newline at end of file
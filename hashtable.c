@@ -0,0 +1,64 @@
+/*
+ * This file is part of MiniJVM (https://github.com/muhammad23012009/minijvm)
+ * Copyright (c) 2025 Muhammad  <thevancedgamer@mentallysanemainliners.org>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdlib.h>
+
+#include "hashtable.h"
+
+uint32_t hash_table_capacity(uint32_t count)
+{
+    uint32_t capacity = 4;
+    while (capacity < count * 2)
+        capacity *= 2;
+
+    return capacity;
+}
+
+void hash_table_init(HashTable *table, size_t entry_size, uint32_t count)
+{
+    uint32_t capacity = hash_table_capacity(count);
+
+    table->mask = capacity - 1;
+    table->count = 0;
+    table->entries = calloc(capacity, entry_size);
+}
+
+void hash_table_reserve(HashTable *table, size_t entry_size, uint32_t initial_capacity, HashTableHash hash)
+{
+    uint32_t old_capacity = table->entries ? table->mask + 1 : 0;
+    if ((table->count + 1) * 2 <= old_capacity)
+        return;
+
+    char *old = table->entries;
+    uint32_t capacity = old_capacity ? old_capacity * 2 : initial_capacity;
+
+    table->mask = capacity - 1;
+    table->entries = calloc(capacity, entry_size);
+    for (uint32_t i = 0; i < old_capacity; i++) {
+        void *entry = old + (size_t) i * entry_size;
+        if (!hash_table_is_free(entry, entry_size))
+            memcpy(hash_table_free_entry(table, entry_size, hash(entry)), entry, entry_size);
+    }
+
+    free(old);
+}
+
+void hash_table_free(HashTable *table)
+{
+    free(table->entries);
+    memset(table, 0, sizeof(HashTable));
+}
\ No newline at end of file
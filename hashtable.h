@@ -0,0 +1,100 @@
+/*
+ * This file is part of MiniJVM (https://github.com/muhammad23012009/minijvm)
+ * Copyright (c) 2025 Muhammad  <thevancedgamer@mentallysanemainliners.org>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef HASHTABLE_H
+#define HASHTABLE_H
+
+/* Open addressing with linear probing, shared by the VM's internal tables.
+ * Entries are the callers' own structs, stored inline. An entry that is
+ * all zero bytes is free, so whatever a table keys on has to make its
+ * entries non-zero. Tables are kept at most half full, so every probe
+ * sequence ends at a free entry.
+ */
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+/* Larger entries can't be checked for being free */
+#define HASH_TABLE_ENTRY_MAX    64
+
+typedef struct HashTable {
+    /* The capacity minus one, the capacity is always a power of two */
+    uint32_t mask;
+    uint32_t count;
+    void *entries;
+} HashTable;
+
+/* Whether an occupied entry holds `key` */
+typedef bool (*HashTableMatch)(const void *entry, const void *key);
+/* The hash an occupied entry went in with, for moving it when growing */
+typedef uint32_t (*HashTableHash)(const void *entry);
+
+static inline bool hash_table_is_free(const void *entry, size_t entry_size)
+{
+    static const char zero[HASH_TABLE_ENTRY_MAX];
+    return !memcmp(entry, zero, entry_size);
+}
+
+/* Returns the entry holding `key`, or the free entry where it would go.
+ * The table has to be allocated already.
+ */
+static inline void *hash_table_probe(const HashTable *table, size_t entry_size, uint32_t hash,
+                                     HashTableMatch match, const void *key)
+{
+    for (uint32_t i = hash & table->mask;; i = (i + 1) & table->mask) {
+        void *entry = (char*) table->entries + (size_t) i * entry_size;
+        if (hash_table_is_free(entry, entry_size) || match(entry, key))
+            return entry;
+    }
+}
+
+/* Returns the entry holding `key`, or NULL */
+static inline void *hash_table_find(const HashTable *table, size_t entry_size, uint32_t hash,
+                                    HashTableMatch match, const void *key)
+{
+    if (!table->entries)
+        return NULL;
+
+    void *entry = hash_table_probe(table, entry_size, hash, match, key);
+    return hash_table_is_free(entry, entry_size) ? NULL : entry;
+}
+
+/* Returns the first free entry for `hash`, without looking for the key.
+ * Keys added more than once are found in the order they were added.
+ */
+static inline void *hash_table_free_entry(const HashTable *table, size_t entry_size, uint32_t hash)
+{
+    for (uint32_t i = hash & table->mask;; i = (i + 1) & table->mask) {
+        void *entry = (char*) table->entries + (size_t) i * entry_size;
+        if (hash_table_is_free(entry, entry_size))
+            return entry;
+    }
+}
+
+/* The capacity that holds `count` entries without growing */
+extern uint32_t hash_table_capacity(uint32_t count);
+/* Sizes the table for `count` entries, for tables that are filled once */
+extern void hash_table_init(HashTable *table, size_t entry_size, uint32_t count);
+/* Makes room for one more entry, growing the table if needed. Callers count
+ * the entries they fill in.
+ */
+extern void hash_table_reserve(HashTable *table, size_t entry_size, uint32_t initial_capacity, HashTableHash hash);
+extern void hash_table_free(HashTable *table);
+
+#endif
\ No newline at end of file
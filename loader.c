@@ -0,0 +1,226 @@
+/*
+ * This file is part of MiniJVM (https://github.com/muhammad23012009/minijvm)
+ * Copyright (c) 2025 Muhammad  <thevancedgamer@mentallysanemainliners.org>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <pthread.h>
+
+#include "loader.h"
+#include "hashtable.h"
+#include "constantpool.h"
+
+typedef struct LoaderJob {
+    Symbol *name;
+    /* NULL until parsed, and after that if the class file is missing */
+    Class *class;
+} LoaderJob;
+
+typedef struct Loader {
+    Classes *classes;
+
+    pthread_mutex_t lock;
+    pthread_cond_t wakeup;
+
+    /* Jobs in discovery order, `next` is the first one not yet taken */
+    int count;
+    int capacity;
+    int next;
+    int running;
+    LoaderJob *jobs;
+
+    /* Index of `jobs` by name, holding LoaderIndexEntry */
+    HashTable index;
+
+    /* Classes in the order they were published */
+    int published_count;
+    Class **published;
+} Loader;
+
+typedef struct LoaderIndexEntry {
+    Symbol *name;
+    int job;
+} LoaderIndexEntry;
+
+static bool loader_index_match(const void *entry, const void *key)
+{
+    return ((const LoaderIndexEntry*) entry)->name == key;
+}
+
+static uint32_t loader_index_hash(const void *entry)
+{
+    return ((const LoaderIndexEntry*) entry)->name->hash;
+}
+
+static LoaderJob *loader_get_job(Loader *loader, Symbol *name)
+{
+    LoaderIndexEntry *entry = hash_table_find(&loader->index, sizeof(LoaderIndexEntry), name->hash,
+                                              loader_index_match, name);
+    return entry ? &loader->jobs[entry->job] : NULL;
+}
+
+/* Queues a class unless it is already known. Called with the lock held */
+static void loader_add(Loader *loader, Symbol *name)
+{
+    /* `Classes` is only read while the workers run, the built-ins are there */
+    if (classes_get_class_by_symbol(loader->classes, name))
+        return;
+
+    hash_table_reserve(&loader->index, sizeof(LoaderIndexEntry), 64, loader_index_hash);
+
+    LoaderIndexEntry *entry = hash_table_probe(&loader->index, sizeof(LoaderIndexEntry), name->hash,
+                                               loader_index_match, name);
+    if (entry->name)
+        return;
+
+    if (loader->count == loader->capacity) {
+        loader->capacity = loader->capacity ? loader->capacity * 2 : 64;
+        loader->jobs = realloc(loader->jobs, sizeof(LoaderJob) * loader->capacity);
+    }
+
+    *entry = (LoaderIndexEntry) { name, loader->count };
+    loader->index.count++;
+    loader->jobs[loader->count++] = (LoaderJob) { name, NULL };
+    pthread_cond_broadcast(&loader->wakeup);
+}
+
+/* Calls `visit` with the superclass and then every class the pool refers
+ * to, in pool order. Primitive arrays have no class to load.
+ */
+static void loader_for_each_dependency(Loader *loader, Class *class, void (*visit)(Loader*, Symbol*))
+{
+    visit(loader, class->parent_name);
+
+    ConstantPool *pool = class->pool;
+    for (int i = 1; i < pool->count; i++) {
+        if (pool->tags[i] != CONSTANT_CLASS)
+            continue;
+
+        Symbol *name = constant_pool_resolve_symbol(pool, i);
+        if (name->bytes[0] == '[' && name->bytes[name->length - 1] != ';')
+            continue;
+
+        visit(loader, class_element_name(name));
+    }
+}
+
+static void *loader_worker(void *data)
+{
+    Loader *loader = data;
+
+    pthread_mutex_lock(&loader->lock);
+    for (;;) {
+        /* Done once nothing is queued and nobody can queue more */
+        while (loader->next == loader->count && loader->running)
+            pthread_cond_wait(&loader->wakeup, &loader->lock);
+
+        if (loader->next == loader->count)
+            break;
+
+        int job = loader->next++;
+        Symbol *name = loader->jobs[job].name;
+        loader->running++;
+        pthread_mutex_unlock(&loader->lock);
+
+        Class *class = class_read(name->bytes);
+
+        pthread_mutex_lock(&loader->lock);
+        /* `jobs` may have moved while the lock was dropped */
+        loader->jobs[job].class = class;
+        if (class)
+            loader_for_each_dependency(loader, class, loader_add);
+
+        if (!--loader->running)
+            pthread_cond_broadcast(&loader->wakeup);
+    }
+    pthread_mutex_unlock(&loader->lock);
+
+    return NULL;
+}
+
+/* Superclasses are published before their subclasses. A job is cleared
+ * before anything else happens, so each class is only published once.
+ */
+static void loader_publish(Loader *loader, Symbol *name)
+{
+    LoaderJob *job = loader_get_job(loader, name);
+    if (!job || !job->class)
+        return;
+
+    Class *class = job->class;
+    job->class = NULL;
+
+    loader_publish(loader, class->parent_name);
+    class->parent = classes_get_class_by_symbol(loader->classes, class->parent_name);
+    if (!class->parent) {
+        printf("Failed to load superclass %s of %s!\n", class->parent_name->bytes, class->name);
+        class_free(class);
+        return;
+    }
+
+    classes_add_class(loader->classes, class);
+    loader->published[loader->published_count++] = class;
+}
+
+Class *loader_preload(Classes *classes, char *main_class, int threads)
+{
+    Loader loader = { .classes = classes };
+    pthread_mutex_init(&loader.lock, NULL);
+    pthread_cond_init(&loader.wakeup, NULL);
+
+    Symbol *main_name = symbol_new(main_class);
+    loader_add(&loader, main_name);
+
+    /* `running` starts at one so no worker gives up before the others start */
+    loader.running = 1;
+    pthread_t *workers = malloc(sizeof(pthread_t) * threads);
+    for (int i = 0; i < threads; i++)
+        pthread_create(&workers[i], NULL, loader_worker, &loader);
+
+    pthread_mutex_lock(&loader.lock);
+    loader.running--;
+    pthread_cond_broadcast(&loader.wakeup);
+    pthread_mutex_unlock(&loader.lock);
+
+    for (int i = 0; i < threads; i++)
+        pthread_join(workers[i], NULL);
+
+    printf("miniJVM: parsed %d classes on %d threads\n", loader.count, threads);
+
+    /* Breadth-first from the main class, each class's dependencies in
+     * constant pool order. This only depends on the class files, not on
+     * the order the workers parsed them in.
+     */
+    loader.published = malloc(sizeof(Class*) * loader.count);
+    loader_publish(&loader, main_name);
+    for (int i = 0; i < loader.published_count; i++)
+        loader_for_each_dependency(&loader, loader.published[i], loader_publish);
+
+    /* Anything left was only reachable through a class that failed */
+    for (int i = 0; i < loader.count; i++) {
+        if (loader.jobs[i].class)
+            class_free(loader.jobs[i].class);
+    }
+
+    free(loader.published);
+    free(workers);
+    free(loader.jobs);
+    hash_table_free(&loader.index);
+    pthread_cond_destroy(&loader.wakeup);
+    pthread_mutex_destroy(&loader.lock);
+
+    return classes_get_class_by_symbol(classes, main_name);
+}
\ No newline at end of file
@@ -0,0 +1,36 @@
+/*
+ * This file is part of MiniJVM (https://github.com/muhammad23012009/minijvm)
+ * Copyright (c) 2025 Muhammad  <thevancedgamer@mentallysanemainliners.org>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef LOADER_H
+#define LOADER_H
+
+/* Eager class loading on a pool of worker threads. Starting from the main
+ * class, workers parse every class file reachable through constant pool
+ * class references. Once the whole graph is parsed, the calling thread
+ * publishes the classes into `Classes` in breadth-first order, so the
+ * result does not depend on which worker finished first.
+ */
+
+#include "method.h"
+
+/* Upper bound for -XX:LoaderThreads */
+#define LOADER_THREADS_MAX  256
+
+/* Returns the main class, or NULL if it could not be loaded */
+extern Class *loader_preload(Classes *classes, char *main_class, int threads);
+
+#endif
\ No newline at end of file
@@ -16,7 +16,11 @@
  */
 
 #include "builtins/builtins.h"
+#include "aot.h"
 #include "array.h"
+#include "bytecode.h"
+#include "cds.h"
+#include "classpath.h"
 #include "method.h"
 #include "object.h"
 
@@ -60,47 +64,172 @@ Method *get_method(ConstantPool *pool, Class *class, uint16_t index)
 {
     Method *class_method;
 
-    uint16_t name_and_type_index = pool->pool[index].method_ref.name_and_type_index;
-    uint16_t method_index = pool->pool[name_and_type_index].name_and_type_info.name_index;
-    uint16_t descriptor_index = pool->pool[name_and_type_index].name_and_type_info.descriptor_index;
-    char *method_name = constant_pool_resolve_string(pool, method_index);
-    char *descriptor = constant_pool_resolve_string(pool, descriptor_index);
+    uint16_t name_and_type_index = constant_pool_second_index(pool, index);
+    uint16_t method_index = constant_pool_first_index(pool, name_and_type_index);
+    uint16_t descriptor_index = constant_pool_second_index(pool, name_and_type_index);
+    Symbol *method_name = constant_pool_resolve_symbol(pool, method_index);
+    Symbol *descriptor = constant_pool_resolve_symbol(pool, descriptor_index);
 
-    class_method = class_get_method(class, method_name, descriptor);
+    class_method = class_get_method_by_symbol(class, method_name, descriptor);
 
     return class_method;
 }
 
+/* Resolves the InterfaceMethodref at `index` on its first execution and
+ * keeps the result in its resolved slot
+ */
+InterfaceCall *interface_call(ConstantPool *pool, uint16_t index)
+{
+    InterfaceCall *call = pool->resolved[index];
+    if (call)
+        return call;
+
+    uint16_t name_and_type_index = constant_pool_second_index(pool, index);
+    call = calloc(1, sizeof(InterfaceCall));
+    call->name = constant_pool_resolve_symbol(pool, constant_pool_first_index(pool, name_and_type_index));
+    call->descriptor = constant_pool_resolve_symbol(pool, constant_pool_second_index(pool, name_and_type_index));
+    call->arguments_count = descriptors_intern(call->descriptor->bytes)->arguments_count;
+
+    return pool->resolved[index] = call;
+}
+
+/* Interfaces have no code of their own, the receiver's class decides. Most
+ * call sites only ever see one class, so the last one is remembered.
+ */
+Method *interface_call_target(InterfaceCall *call, Object *receiver)
+{
+    if (!receiver) {
+        fprintf(stderr, "Exception in thread \"main\" java.lang.NullPointerException: "
+                        "Cannot invoke \"%s()\" on a null reference\n", call->name->bytes);
+        exit(1);
+    }
+
+    if (receiver->class == call->receiver_class)
+        return call->method;
+
+    Method *method = class_find_method_by_symbol(receiver->class, call->name, call->descriptor);
+    if (!method) {
+        fprintf(stderr, "Exception in thread \"main\" java.lang.AbstractMethodError: %s.%s%s\n",
+                receiver->class->name, call->name->bytes, call->descriptor->bytes);
+        exit(1);
+    }
+
+    call->receiver_class = receiver->class;
+    call->method = method;
+    return method;
+}
+
+/* Moves the arguments (and `this`, if the method has one) from the caller's
+ * stack into a new frame, runs the method and pushes its result, if any,
+ * back onto the caller's stack.
+ */
+void method_invoke(Method *method, Frame *frame, bool has_this)
+{
+    Frame *subframe = frame_new(method->max_stack, method->max_local);
+    Descriptors *descriptors = method->descriptors;
+    Variant *locals = subframe->locals + (has_this ? 1 : 0);
+
+    /* Arguments are pushed left to right, so the last one is on top */
+    for (int i = descriptors->arguments_count - 1; i >= 0; i--)
+        locals[descriptors->arguments[i].slot] = stack_pop(frame->stack);
+
+    if (has_this)
+        subframe->locals[0] = stack_pop(frame->stack);
+
+    if (method->class->built_in)
+        method->method(method, subframe);
+    else
+        method_execute(method, subframe);
+
+    /* TODO: Instead of doing this, pass the frame of the invoker 
+     * into the method being executed, and then push the result into
+     * the invoker frame on return.
+     */
+    if (descriptors->return_descriptor.kind != DESCRIPTOR_KIND_VOID)
+        stack_push(frame->stack, stack_pop(subframe->stack));
+
+    frame_free(subframe);
+}
+
+/* Calls a method from native code. `args` starts with `this` for instance
+ * methods and is followed by the declared arguments.
+ */
+Variant method_call(Method *method, Variant *args, bool has_this)
+{
+    Frame *frame = frame_new(method->max_stack, method->max_local);
+    Descriptors *descriptors = method->descriptors;
+    Variant result = { .type = VARIANT_TYPE_NONE };
+    Variant *locals = frame->locals;
+
+    if (has_this)
+        *locals++ = *args++;
+
+    for (int i = 0; i < descriptors->arguments_count; i++)
+        locals[descriptors->arguments[i].slot] = args[i];
+
+    if (method->class->built_in)
+        method->method(method, frame);
+    else
+        method_execute(method, frame);
+
+    if (descriptors->return_descriptor.kind != DESCRIPTOR_KIND_VOID)
+        result = stack_pop(frame->stack);
+
+    frame_free(frame);
+    return result;
+}
+
 void method_execute(Method *method, Frame *frame)
 {
     printf("Beginning execution of method %s\n", method->name);
+    if (method->compiled) {
+        Variant result = method->compiled(method, frame->locals);
+        if (method->descriptors->return_descriptor.kind != DESCRIPTOR_KIND_VOID)
+            stack_push(frame->stack, result);
+        return;
+    }
+
     /* Access code of method */
     uint8_t *data = method->data;
     ConstantPool *pool = method->class->pool;
     uint8_t op;
 
     static void *opcodes[] = {
+        [1] = &&aconst_null,
         [2 ... 8] = &&iconst_x,
+        [9 ... 10] = &&lconst_x,
         [16] = &&bipush,
         [17] = &&sipush,
         [18] = &&ldc,
+        [20] = &&ldc2_w,
         [21] = &&iload,
+        [22] = &&lload,
         [25] = &&aload,
         [26 ... 29] = &&iload_x,
+        [30 ... 33] = &&lload_x,
         [42 ... 45] = &&aload_x,
         [50] = &&aaload,
         [54] = &&istore,
+        [55] = &&lstore,
         [58] = &&astore,
         [59 ... 62] = &&istore_x,
+        [63 ... 66] = &&lstore_x,
         [75 ... 78] = &&astore_x,
         [83] = &&aastore,
         [87] = &&pop,
         [89] = &&dup,
         [96] = &&iadd,
+        [97] = &&ladd,
         [132] = &&iinc,
+        [133] = &&i2l,
+        [136] = &&l2i,
+        [153 ... 158] = &&if_x,
         [159 ... 164] = &&if_cmpx,
+        [165 ... 166] = &&if_acmpx,
         [167] = &&j_goto,
         [172] = &&ireturn,
+        [173] = &&lreturn,
+        [176] = &&areturn,
         [177] = &&j_return,
         [178] = &&getstatic,
         [179] = &&putstatic,
@@ -108,10 +237,16 @@ void method_execute(Method *method, Frame *frame)
         [181] = &&putfield,
         [182] = &&invokevirtual,
         [183] = &&invokespecial,
+        [184] = &&invokestatic,
+        [185] = &&invokeinterface,
         [186] = &&invokedynamic,
         [187] = &&new,
         [189] = &&anewarray,
         [190] = &&arraylength,
+        [192] = &&checkcast,
+        [198 ... 199] = &&ifnullx,
+        [OP_AALOAD_UNCHECKED] = &&aaload_unchecked,
+        [OP_AASTORE_UNCHECKED] = &&aastore_unchecked,
     };
 
     frame->pc = 0;
@@ -120,20 +255,32 @@ void method_execute(Method *method, Frame *frame)
     op = data[frame->pc];
     goto *opcodes[op];
 
+    aconst_null: {
+        Variant null = { .type = VARIANT_TYPE_OBJECT, .data.object = NULL };
+        stack_push(frame->stack, null);
+        DISPATCH();
+    }
+
     iconst_x: {
         int8_t const_int = op - 3;
         stack_push_int(frame->stack, const_int);
         DISPATCH();
     }
 
+    lconst_x: {
+        stack_push_long(frame->stack, op - 9);
+        DISPATCH();
+    }
+
     bipush: {
-        uint8_t byte = data[++frame->pc];
+        int8_t byte = data[++frame->pc];
         stack_push_int(frame->stack, byte);
         DISPATCH();
     }
 
     sipush:
-        uint16_t shrt = (data[++frame->pc] << 8) | data[++frame->pc];
+        int16_t shrt = code_s16(&data[frame->pc + 1]);
+        frame->pc += 2;
         stack_push_int(frame->stack, shrt);
         DISPATCH();
 
@@ -150,9 +297,7 @@ void method_execute(Method *method, Frame *frame)
             }
 
             case CONSTANT_STRING: {
-                Object *str_obj = object_new(classes_get_class(method->class->classes, "java/lang/String"));
-                object_get_field(str_obj, "value")->value.data.ref = constant_pool_resolve_string(pool, index);
-                variant.data.object = str_obj;
+                variant.data.object = constant_pool_resolve_string_object(pool, index, method->class->classes);
                 variant.type = VARIANT_TYPE_OBJECT;
                 break;
             }
@@ -168,12 +313,26 @@ void method_execute(Method *method, Frame *frame)
         DISPATCH();
     }
 
+    ldc2_w: {
+        uint16_t index = code_u16(&data[frame->pc + 1]);
+        frame->pc += 2;
+        /* TODO: Doubles */
+        stack_push_long(frame->stack, constant_pool_resolve_long(pool, index));
+        DISPATCH();
+    }
+
     iload: {
         uint8_t index = data[++frame->pc];
         stack_push(frame->stack, frame->locals[index]);
         DISPATCH();
     }
 
+    lload: {
+        uint8_t index = data[++frame->pc];
+        stack_push(frame->stack, frame->locals[index]);
+        DISPATCH();
+    }
+
     aload: {
         uint8_t index = data[++frame->pc];
         stack_push(frame->stack, frame->locals[index]);
@@ -187,6 +346,12 @@ void method_execute(Method *method, Frame *frame)
         DISPATCH();
     }
 
+    lload_x: {
+        uint8_t local_index = op - 30;
+        stack_push(frame->stack, frame->locals[local_index]);
+        DISPATCH();
+    }
+
     aload_x: {
         uint8_t local_index = op - 42;
         stack_push(frame->stack, frame->locals[local_index]);
@@ -197,6 +362,18 @@ void method_execute(Method *method, Frame *frame)
         int index = stack_pop(frame->stack).data.int_val;
         Array *array = stack_pop(frame->stack).data.ref;
 
+        if (!array_in_bounds(array, index))
+            array_throw_out_of_bounds(array, index);
+
+        stack_push(frame->stack, array->value[index]);
+        DISPATCH();
+    }
+
+    /* Emitted by method_prepare() for accesses proven to be in bounds */
+    aaload_unchecked: {
+        int index = stack_pop(frame->stack).data.int_val;
+        Array *array = stack_pop(frame->stack).data.ref;
+
         stack_push(frame->stack, array->value[index]);
         DISPATCH();
     }
@@ -207,6 +384,12 @@ void method_execute(Method *method, Frame *frame)
         DISPATCH();
     }
 
+    lstore: {
+        uint8_t local_index = data[++frame->pc];
+        frame->locals[local_index] = stack_pop(frame->stack);
+        DISPATCH();
+    }
+
     astore: {
         uint8_t local_index = data[++frame->pc];
         frame->locals[local_index] = stack_pop(frame->stack);
@@ -219,6 +402,12 @@ void method_execute(Method *method, Frame *frame)
         DISPATCH();
     }
 
+    lstore_x: {
+        uint8_t local_index = op - 63;
+        frame->locals[local_index] = stack_pop(frame->stack);
+        DISPATCH();
+    }
+
     astore_x: {
         uint8_t local_index = op - 75;
         frame->locals[local_index] = stack_pop(frame->stack);
@@ -230,6 +419,18 @@ void method_execute(Method *method, Frame *frame)
         int index = stack_pop(frame->stack).data.int_val;
         Array *array = stack_pop(frame->stack).data.ref;
 
+        if (!array_in_bounds(array, index))
+            array_throw_out_of_bounds(array, index);
+
+        array_set_value(array, index, value);
+        DISPATCH();
+    }
+
+    aastore_unchecked: {
+        Variant value = stack_pop(frame->stack);
+        int index = stack_pop(frame->stack).data.int_val;
+        Array *array = stack_pop(frame->stack).data.ref;
+
         array_set_value(array, index, value);
         DISPATCH();
     }
@@ -248,15 +449,55 @@ void method_execute(Method *method, Frame *frame)
         stack_push_int(frame->stack, a1 + a2);
         DISPATCH();
 
+    ladd: {
+        int64_t b = stack_pop(frame->stack).data.long_val;
+        int64_t a = stack_pop(frame->stack).data.long_val;
+        stack_push_long(frame->stack, (int64_t) ((uint64_t) a + (uint64_t) b));
+        DISPATCH();
+    }
+
+    i2l:
+        stack_push_long(frame->stack, stack_pop(frame->stack).data.int_val);
+        DISPATCH();
+
+    l2i:
+        stack_push_int(frame->stack, (int) stack_pop(frame->stack).data.long_val);
+        DISPATCH();
+
     iinc:
         uint8_t index = data[++frame->pc];
         int8_t const_val = data[++frame->pc];
         frame->locals[index].data.int_val += const_val;
         DISPATCH();
 
+    if_x: {
+        int16_t branch_offset = (int16_t) ((data[frame->pc + 1] << 8) | data[frame->pc + 2]);
+        int value = stack_pop(frame->stack).data.int_val;
+        bool taken;
+
+        switch (op) {
+            case 153: taken = value == 0; break; /* ifeq */
+            case 154: taken = value != 0; break; /* ifne */
+            case 155: taken = value < 0; break;  /* iflt */
+            case 156: taken = value >= 0; break; /* ifge */
+            case 157: taken = value > 0; break;  /* ifgt */
+            default: taken = value <= 0; break;  /* ifle */
+        }
+
+        if (taken) {
+            frame->pc += branch_offset;
+            op = data[frame->pc];
+            goto *opcodes[op];
+        }
+
+        frame->pc += 2;
+        DISPATCH();
+    }
+
     if_cmpx: {
         uint8_t cond = op - 159;
-        int16_t branch_offset = (data[++frame->pc] << 8) | data[++frame->pc];
+        int16_t branch_offset = code_s16(&data[frame->pc + 1]);
+        frame->pc += 2;
         int value2 = stack_pop(frame->stack).data.int_val;
         int value1 = stack_pop(frame->stack).data.int_val;
 
@@ -295,8 +536,42 @@ void method_execute(Method *method, Frame *frame)
             DISPATCH();
     }
 
+    if_acmpx: {
+        /* Interned strings make `==` on literals a plain pointer compare */
+        int16_t branch_offset = (int16_t) ((data[frame->pc + 1] << 8) | data[frame->pc + 2]);
+        void *value2 = stack_pop(frame->stack).data.ref;
+        void *value1 = stack_pop(frame->stack).data.ref;
+        bool equal = value1 == value2;
+
+        /* if_acmpeq is 165, if_acmpne is 166 */
+        if (equal == (op == 165)) {
+            frame->pc += branch_offset;
+            op = data[frame->pc];
+            goto *opcodes[op];
+        }
+
+        frame->pc += 2;
+        DISPATCH();
+    }
+
+    ifnullx: {
+        int16_t branch_offset = (int16_t) ((data[frame->pc + 1] << 8) | data[frame->pc + 2]);
+        bool null = stack_pop(frame->stack).data.ref == NULL;
+
+        /* ifnull is 198, ifnonnull is 199 */
+        if (null == (op == 198)) {
+            frame->pc += branch_offset;
+            op = data[frame->pc];
+            goto *opcodes[op];
+        }
+
+        frame->pc += 2;
+        DISPATCH();
+    }
+
     j_goto: {
-        int16_t branch_offset = (data[++frame->pc] << 8) | data[++frame->pc];
+        int16_t branch_offset = code_s16(&data[frame->pc + 1]);
+        frame->pc += 2;
         /* Two bytes for the branch offset, and one byte for DISPATCH */
         frame->pc += branch_offset - 3;
         DISPATCH();
@@ -305,32 +580,40 @@ void method_execute(Method *method, Frame *frame)
     ireturn:
         return;
 
+    lreturn:
+        return;
+
+    areturn:
+        return;
+
     j_return:
         return;
 
     getstatic: {
-        uint16_t index = (data[++frame->pc] << 8) | data[++frame->pc];
+        uint16_t index = code_u16(&data[frame->pc + 1]);
+        frame->pc += 2;
         Class *class = classes_get_class_from_index(method->class->classes, pool, index);
         if (class->static_field_count && !class->static_initialized) {
             class_initialize_static(class);
         }
 
         char *field_name = constant_pool_resolve_field_name(pool, index);
-        Field *field = class_get_static_field(class, field_name);
+        Field *field = class_get_static_field_by_symbol(class, symbol_of(field_name));
 
         stack_push(frame->stack, field->value);
         DISPATCH();
     }
 
     putstatic: {
-        uint16_t index = (data[++frame->pc] << 8) | data[++frame->pc];
+        uint16_t index = code_u16(&data[frame->pc + 1]);
+        frame->pc += 2;
         Class *class = classes_get_class_from_index(method->class->classes, pool, index);
         /* Check if the class has been initialized yet. */
         if (class->static_field_count && !class->static_initialized) {
             class_initialize_static(class);
         }
 
-        Field *field = class_get_static_field(class, constant_pool_resolve_field_name(class->pool, index));
+        Field *field = class_get_static_field_by_symbol(class, symbol_of(constant_pool_resolve_field_name(pool, index)));
 
         /* TODO: Implement value conversion */
         field->value = stack_pop(frame->stack);
@@ -338,63 +621,36 @@ void method_execute(Method *method, Frame *frame)
     }
 
     getfield: {
-        uint16_t index = (data[++frame->pc] << 8) | data[++frame->pc];
+        uint16_t index = code_u16(&data[frame->pc + 1]);
+        frame->pc += 2;
         Object *object = stack_pop(frame->stack).data.object;
-        char *field_name = constant_pool_resolve_field_name(object->class->pool, index);
-        Field *field = object_get_field(object, field_name);
+        char *field_name = constant_pool_resolve_field_name(pool, index);
+        Field *field = object_get_field(object, symbol_of(field_name));
 
         stack_push(frame->stack, field->value);
         DISPATCH();
     }
 
     putfield: {
-        uint16_t index = (data[++frame->pc] << 8) | data[++frame->pc];
+        uint16_t index = code_u16(&data[frame->pc + 1]);
+        frame->pc += 2;
         Variant value = stack_pop(frame->stack);
         Object *object = stack_pop(frame->stack).data.object;
 
-        char *field_name = constant_pool_resolve_field_name(object->class->pool, index);
-        Field *field = object_get_field(object, field_name);
+        char *field_name = constant_pool_resolve_field_name(pool, index);
+        Field *field = object_get_field(object, symbol_of(field_name));
 
         field->value = value;
         DISPATCH();
     }
 
     invokevirtual: {
-        uint16_t index = (data[++frame->pc] << 8) | data[++frame->pc];
+        uint16_t index = code_u16(&data[frame->pc + 1]);
+        frame->pc += 2;
         Class *class = classes_get_class_from_index(method->class->classes, pool, index);
         Method *class_method = get_method(pool, class, index);
 
-        Frame *subframe = frame_new(class_method->max_stack, class_method->max_local);
-        //printf("made new subframe for submethod %s in class %s with max stack %d virt\n", class_method->name, class->name, class_method->max_stack);
-
-        int arguments_count = class_method->descriptors->arguments_count;
-
-        for (int i = 1; i <= arguments_count; i++) {
-            Variant item = stack_pop(frame->stack);
-            subframe->locals[i] = item;
-        }
-        Variant item = stack_pop(frame->stack);
-        subframe->locals[0] = item;
-
-        if (class->built_in) {
-            class_method->method(method, subframe);
-        } else {
-            method_execute(class_method, subframe);
-        }
-
-        //printf("finished execution of submethod %s\n", class_method->name);
-        /* TODO: Instead of doing this, pass the frame of the invoker 
-         * into the method being executed, and then push the result into
-         * the invoker frame on return.
-         */
-        /* Take the returned value from the method, if it had one */
-        if (class_method->descriptors &&
-            class_method->descriptors->return_descriptor.type != DESCRIPTOR_VOID) {
-            Variant item = stack_pop(subframe->stack);
-            stack_push(frame->stack, item);
-        }
-
-        frame_free(subframe);
+        method_invoke(class_method, frame, true);
         DISPATCH();
     }
 
@@ -403,48 +659,68 @@ void method_execute(Method *method, Frame *frame)
          * Implement all of this
          */
 
-        uint16_t index = (data[++frame->pc] << 8) | data[++frame->pc];
+        uint16_t index = code_u16(&data[frame->pc + 1]);
+        frame->pc += 2;
         Class *class = classes_get_class_from_index(method->class->classes, pool, index);
         Method *class_method = get_method(pool, class, index);
 
-        Frame *subframe = frame_new(class_method->max_stack, class_method->max_local);
-        //printf("made new subframe with max stack %d\n", class_method->max_stack);
-
-        int arguments_count = class_method->descriptors->arguments_count;
+        method_invoke(class_method, frame, true);
+        DISPATCH();
+    }
 
-        for (int i = 1; i <= arguments_count; i++) {
-            Variant item = stack_pop(frame->stack);
-            subframe->locals[i] = item;
+    invokestatic: {
+        uint16_t index = code_u16(&data[frame->pc + 1]);
+        frame->pc += 2;
+        Class *class = classes_get_class_from_index(method->class->classes, pool, index);
+        if (class->static_field_count && !class->static_initialized) {
+            class_initialize_static(class);
         }
 
-        Variant item = stack_pop(frame->stack);
-        subframe->locals[0] = item;
+        Method *class_method = get_method(pool, class, index);
 
-        if (class->built_in) {
-            class->pool = pool;
-            class_method->method(class_method, subframe);
-        } else {
-            method_execute(class_method, subframe);
-        }
+        method_invoke(class_method, frame, false);
+        DISPATCH();
+    }
 
-        /* Take the returned value from the method, if it had one */
-        if (class_method->descriptors &&
-            class_method->descriptors->return_descriptor.type != DESCRIPTOR_VOID) {
-            Variant item = stack_pop(subframe->stack);
-            printf("got return\n");
-            stack_push(frame->stack, item);
-        }
+    invokeinterface: {
+        uint16_t index = code_u16(&data[frame->pc + 1]);
+        frame->pc += 2;
+        /* The argument count and a zero byte, both redundant */
+        frame->pc += 2;
 
-        frame_free(subframe);
+        InterfaceCall *call = interface_call(pool, index);
+        Object *receiver = stack_peek(frame->stack, call->arguments_count).data.object;
+        Method *class_method = interface_call_target(call, receiver);
+
+        method_invoke(class_method, frame, true);
         DISPATCH();
     }
 
     invokedynamic: {
+        uint16_t index = code_u16(&data[frame->pc + 1]);
+        frame->pc += 2;
+        /* The last two bytes are always zero */
+        frame->pc += 2;
+
+        /* Call sites are linked on first execution and reused after that */
+        ConcatRecipe *recipe = pool->resolved[index];
+        if (!recipe) {
+            recipe = string_concat_link(method->class, index);
+            if (!recipe) {
+                fprintf(stderr, "Unsupported invokedynamic call site in method %s\n", method->name);
+                exit(1);
+            }
+
+            pool->resolved[index] = recipe;
+        }
+
+        string_concat_execute(recipe, frame);
         DISPATCH();
     }
 
     new: {
-        uint16_t index = (data[++frame->pc] << 8) | data[++frame->pc];
+        uint16_t index = code_u16(&data[frame->pc + 1]);
+        frame->pc += 2;
         Class *class = classes_get_class_from_index(method->class->classes, pool, index);
         Object *object = object_new(class);
         stack_push_object(frame->stack, object);
@@ -452,7 +728,8 @@ void method_execute(Method *method, Frame *frame)
     }
 
     anewarray: {
-        uint16_t index = (data[++frame->pc] << 8) | data[++frame->pc];
+        uint16_t index = code_u16(&data[frame->pc + 1]);
+        frame->pc += 2;
         Class *class = classes_get_class_from_index(method->class->classes, pool, index);
         printf("Creating new array of class %s\n", class->name);
 
@@ -463,6 +740,14 @@ void method_execute(Method *method, Frame *frame)
         DISPATCH();
     }
 
+    checkcast: {
+        /* TODO: Check the type once exceptions are implemented. Until then
+         * a failed cast would just crash later anyway.
+         */
+        frame->pc += 2;
+        DISPATCH();
+    }
+
     arraylength: {
         Array *array = stack_pop(frame->stack).data.ref;
         stack_push_int(frame->stack, array->count);
@@ -481,16 +766,15 @@ FieldInfo fields_get_field(Fields *fields, char *name)
     }
 }
 
-Fields *fields_new(Reader *reader, ConstantPool *pool)
+Fields *fields_new(Reader *reader, ConstantPool *pool, Arena *arena)
 {
-    Fields *fields = malloc(sizeof(Fields));
-    fields->count = reader_read_uint16_be(reader);
-    if (fields->count <= 0) {
-        free(fields);
+    uint16_t count = reader_read_uint16_be(reader);
+    if (count <= 0)
         return NULL;
-    }
 
-    fields->fields = malloc(sizeof(FieldInfo) * fields->count);
+    Fields *fields = arena_alloc(arena, sizeof(Fields));
+    fields->count = count;
+    fields->fields = arena_alloc(arena, sizeof(FieldInfo) * fields->count);
 
     for (int i = 0; i < fields->count; i++) {
         FieldInfo *field = &fields->fields[i];
@@ -499,48 +783,119 @@ Fields *fields_new(Reader *reader, ConstantPool *pool)
         field->name.name = constant_pool_resolve_string(pool, field->name.index);
         field->descriptor.index = reader_read_uint16_be(reader);
         field->descriptor.descriptor = constant_pool_resolve_string(pool, field->descriptor.index);
-        field->attributes = attributes_new(reader, pool);
+        field->attributes = attributes_new(reader, pool, arena);
     }
 
     return fields;
 }
 
-void fields_free(Fields *fields)
+/* Class/methods code */
+
+/* What class_read parses out of the class file. None of it outlives
+ * class_read, class_file_link copies what the class needs at run time.
+ */
+typedef struct ClassFile {
+    Arena arena;
+    ClassBytes bytes;
+    Reader *reader;
+
+    Fields *fields;
+    Fields *methods;
+    Attributes *attributes;
+} ClassFile;
+
+/* Builds the runtime structures of the class from its class file: static
+ * fields, the instance field layout, bootstrap methods and methods with
+ * their own copy of the code.
+ */
+static bool class_file_link(Class *class, ClassFile *file)
 {
-    if (!fields)
-        return;
+    Fields *fields = file->fields;
+    if (fields) {
+        for (int i = 0; i < fields->count; i++) {
+            /* ACC_STATIC */
+            if (fields->fields[i].access_flags & 0x0008)
+                class->static_field_count++;
+            else
+                class->instance_field_count++;
+        }
 
-    for (int i = 0; i < fields->count; i++) {
-        FieldInfo info = fields->fields[i];
-        attributes_free(info.attributes);
+        if (class->static_field_count)
+            class->static_fields = arena_alloc(&class->arena, sizeof(Field) * class->static_field_count);
+        if (class->instance_field_count)
+            class->instance_field_names = arena_alloc(&class->arena, sizeof(char*) * class->instance_field_count);
+
+        int statics = 0, instances = 0;
+        for (int i = 0; i < fields->count; i++) {
+            FieldInfo info = fields->fields[i];
+            if (info.access_flags & 0x0008) {
+                Field *field = &class->static_fields[statics++];
+                field->name = info.name.name;
+                field->class = class;
+            } else {
+                class->instance_field_names[instances++] = info.name.name;
+            }
+        }
+    }
+
+    AttributeInfo *bootstrap = attributes_find(file->attributes, vm_symbols.bootstrap_methods);
+    if (bootstrap) {
+        uint16_t count = bootstrap->BootstrapMethodsAttribute.num_bootstrap_methods;
+        class->bootstrap_methods_count = count;
+        class->bootstrap_methods = arena_alloc(&class->arena, sizeof(struct BootstrapMethod) * count);
+
+        for (int i = 0; i < count; i++) {
+            struct BootstrapMethod *method = &class->bootstrap_methods[i];
+            *method = bootstrap->BootstrapMethodsAttribute.bootstrap_methods[i];
+            method->bootstrap_arguments = arena_alloc(&class->arena, sizeof(uint16_t) * method->num_bootstrap_arguments);
+            memcpy(method->bootstrap_arguments, bootstrap->BootstrapMethodsAttribute.bootstrap_methods[i].bootstrap_arguments,
+                   sizeof(uint16_t) * method->num_bootstrap_arguments);
+        }
     }
-    free(fields->fields);
-    free(fields);
+
+    if (file->methods) {
+        class->methods = arena_alloc(&class->arena, sizeof(Method) * file->methods->count);
+        for (int i = 0; i < file->methods->count; i++)
+            class_add_method(class, file->methods->fields[i]);
+    }
+
+    return class_link(class);
 }
 
-/* Class/methods code */
-Class *class_parse_file(Classes *classes, char *filename)
+static void class_file_free(ClassFile *file)
 {
-    Class *class = malloc(sizeof(Class));
-    Method *static_init = NULL;
-    struct stat filestat;
-    FILE *file;
-    memset(class, 0, sizeof(Class));
+    arena_free(&file->arena);
+    classpath_release(&file->bytes);
+    free(file->reader);
+}
 
-    int status = stat(filename, &filestat);
-    if (status < 0) {
-        printf("File not found!\n");
-        free(class);
-        return NULL;
+/* Finds a class on the class path, then parses and links it without
+ * touching `Classes`, so it is safe to call from any thread. The superclass
+ * is only named, see class_parse. Classes in the shared archive are returned
+ * as they are.
+ */
+Class *class_read(char *name)
+{
+    /* Archived classes are parsed and linked already */
+    Class *class = cds_find_class(name);
+    if (class) {
+        printf("Class %s mapped from the shared archive.\n", name);
+        aot_bind(class);
+        return class;
     }
 
-    file = fopen(filename, "r");
-    class->data = malloc(filestat.st_size);
-    fread(class->data, filestat.st_size, 1, file);
-    fclose(file);
+    ClassFile file;
+    memset(&file, 0, sizeof(file));
 
+    if (!classpath_find(name, &file.bytes)) {
+        printf("Class file for %s not found!\n", name);
+        return NULL;
+    }
+
+    class = malloc(sizeof(Class));
+    memset(class, 0, sizeof(Class));
     class->built_in = false;
-    Reader *reader = class->reader = reader_new(class->data, filestat.st_size);
+    Reader *reader = file.reader = reader_new(file.bytes.data, file.bytes.size);
 
     printf("class processing started!\n");
 
@@ -548,23 +903,31 @@ Class *class_parse_file(Classes *classes, char *filename)
     uint32_t magic = reader_read_uint32_be(reader);
     if (magic != 0xCAFEBABE) {
         printf("Invalid class!\n");
+        class_file_free(&file);
+        class_free(class);
         return NULL;
-        /* TODO: Cleanup... */
     }
 
     uint16_t minor_version = reader_read_uint16_be(reader);
     uint16_t major_version = reader_read_uint16_be(reader);
 
-    class->pool = constant_pool_new(reader);
+    class->pool = constant_pool_new(reader, &class->arena);
+    if (!class->pool) {
+        printf("Invalid constant pool in class %s!\n", name);
+        class_file_free(&file);
+        class_free(class);
+        return NULL;
+    }
+
     class->flags = reader_read_uint16_be(reader);
     class->name = constant_pool_resolve_string(class->pool, reader_read_uint16_be(reader));
-    /* TODO: Handle parents later */
-    class->parent = classes_get_class(classes, constant_pool_resolve_string(class->pool, reader_read_uint16_be(reader)));
+
+    class->parent_name = constant_pool_resolve_symbol(class->pool, reader_read_uint16_be(reader));
 
     printf("some basic information...\n");
 
     uint16_t interfaces_count = reader_read_uint16_be(reader);
-    Interface *interfaces = malloc(sizeof(Interface) * interfaces_count);
+    Interface *interfaces = arena_alloc(&file.arena, sizeof(Interface) * interfaces_count);
 
     for (int i = 0; i < interfaces_count; i++) {
         Interface *iface = &interfaces[i];
@@ -572,58 +935,69 @@ Class *class_parse_file(Classes *classes, char *filename)
         iface->interface = constant_pool_resolve_string(class->pool, iface->index);
     }
 
-    /* TODO: Eventually drop these somehow */
-    class->class_fields = fields_new(reader, class->pool);
-    class->method_fields = fields_new(reader, class->pool);
-    class->attributes = attributes_new(reader, class->pool);
-    class->static_field_count = 0;
-    class->static_initialized = false;
+    file.fields = fields_new(reader, class->pool, &file.arena);
+    file.methods = fields_new(reader, class->pool, &file.arena);
+    file.attributes = attributes_new(reader, class->pool, &file.arena);
 
-    if (class->class_fields) {
-        /* Parse static fields within the class and separate them */
-        for (int i = 0; i < class->class_fields->count; i++) {
-            FieldInfo info = class->class_fields->fields[i];
-            /* ACC_STATIC */
-            if (info.access_flags & 0x0008) {
-                class->static_field_count++;
-            }
-        }
-
-        if (class->static_field_count) {
-            class->static_fields = malloc(sizeof(Field) * class->static_field_count);
-            int j = 0;
-            for (int i = 0; i < class->class_fields->count; i++) {
-                FieldInfo info = class->class_fields->fields[i];
-                if (info.access_flags & 0x0008) {
-                    Field *field = &class->static_fields[j++];
-                    field->name = info.name.name;
-                    field->class = class;
-                }
-            }
-        }
+    /* Every read past the end returned zeroes, nothing of it can be linked */
+    if (reader->overflow) {
+        printf("Truncated or malformed class file for %s!\n", name);
+        class_file_free(&file);
+        class_free(class);
+        return NULL;
     }
 
-    for (int i = 0; i < class->method_fields->count; i++) {
-        FieldInfo info = class->method_fields->fields[i];
-        class_add_method(class, info);
+    /* Calls and frames are laid out from these, see descriptors_intern */
+    for (int i = 0; file.methods && i < file.methods->count; i++) {
+        FieldInfo *method = &file.methods->fields[i];
+        if (!descriptor_is_valid_method(method->descriptor.descriptor)) {
+            printf("Invalid descriptor %s of method %s in class %s!\n", method->descriptor.descriptor, method->name.name, name);
+            class_file_free(&file);
+            class_free(class);
+            return NULL;
+        }
     }
 
     printf("fields and methods...\n");
 
-    if (!constant_pool_resolve_unknowns(class->pool, classes, class)) {
+    bool linked = class_file_link(class, &file);
+    class_file_free(&file);
+    if (!linked) {
+        printf("Invalid code in class %s!\n", name);
         class_free(class);
         return NULL;
     }
 
+    aot_bind(class);
+
     printf("...and done!\n");
     return class;
 }
 
+Class *class_parse(Classes *classes, char *name)
+{
+    Class *class = class_read(name);
+    if (!class)
+        return NULL;
+
+    /* Everything else the class refers to is loaded on first use, but the
+     * superclass is needed up front for method and field lookups.
+     */
+    class->parent = classes_load_class(classes, class->parent_name);
+    if (!class->parent) {
+        printf("Failed to load superclass %s of %s!\n", class->parent_name->bytes, class->name);
+        class_free(class);
+        return NULL;
+    }
+
+    return class;
+}
+
 void class_initialize_static(Class *class)
 {
     Method *static_init = NULL;
 
-    if (class->static_field_count && (static_init = class_get_method(class, "<clinit>", "()V"))) {
+    if (class->static_field_count && (static_init = class_get_method_by_symbol(class, vm_symbols.clinit, vm_symbols.void_method))) {
         class->static_initialized = true;
         Frame *frame = frame_new(static_init->max_stack, static_init->max_local);
 
@@ -638,21 +1012,15 @@ void class_initialize_static(Class *class)
 
 void class_free(Class *class)
 {
-    if (!class->built_in) {
-        attributes_free(class->attributes);
-        fields_free(class->class_fields);
-        fields_free(class->method_fields);
-        constant_pool_free(class->pool);
-        free(class->reader);
-        free(class->data);
-    }
+    if (class->shared)
+        return;
 
-    for (int j = 0; j < class->methods_count; j++) {
-        descriptors_free(class->methods[j]->descriptors);
-        free(class->methods[j]);
-    }
+    if (class->pool)
+        constant_pool_free(class->pool);
 
-    free(class->methods);
+    /* Everything else the class owns */
+    arena_free(&class->arena);
+    free(class);
 }
 
 /* Built-in classes will have no constant pools or any other associated
@@ -663,26 +1031,26 @@ Class *class_create_builtin(char *name, builtins *class_builtins, Classes *class
     Class *class = malloc(sizeof(Class));
     memset(class, 0, sizeof(Class));
     class->built_in = true;
-    class->name = name;
+    class->name = symbol_new(name)->bytes;
 
     if (class_builtins->parent)
         class->parent = classes_get_class(classes, class_builtins->parent);
 
     class->methods_count = class_builtins->methods_length;
-    class->methods = malloc(sizeof(Method*) * class->methods_count);
+    class->methods = arena_alloc(&class->arena, sizeof(Method) * class->methods_count);
 
     for (int i = 0; i < class_builtins->methods_length; i++) {
         builtin_methods bmethod = class_builtins->methods[i];
-        Method *method = class->methods[i] = malloc(sizeof(Method));
-        method->name = bmethod.name;
+        Method *method = &class->methods[i];
+        method->name = symbol_new(bmethod.name)->bytes;
         method->class = class;
         method->method = bmethod.method;
         method->flags = 0; // TODO: Implement method flags
 
         if (strcmp(bmethod.descriptor, "") != 0) {
             /* This built-in method has predefined arguments and returns */
-            method->descriptors = descriptors_new(bmethod.descriptor);
-            method->max_local = method->descriptors->arguments_count + 1; // +1 for `this`
+            method->descriptors = descriptors_intern(symbol_new(bmethod.descriptor)->bytes);
+            method->max_local = method->descriptors->arguments_slots + 1; // +1 for `this`
             method->max_stack = bmethod.max_stack;
         }
     }
@@ -692,91 +1060,282 @@ Class *class_create_builtin(char *name, builtins *class_builtins, Classes *class
         if (field->flags & 0x0008) { // ACC_STATIC
             class->static_field_count++;
         } else {
-            class->class_fields = malloc(sizeof(Fields));
-            class->class_fields->count = class_builtins->fields_length;
-            class->class_fields->fields = malloc(sizeof(Field) * class->class_fields->count);
-
-            for (int j = 0; j < class_builtins->fields_length; j++) {
-                builtin_fields *bf = &class_builtins->fields[j];
-                FieldInfo *fi = &class->class_fields->fields[j];
-                fi->name.name = bf->name;
-                fi->descriptor.descriptor = NULL; // TODO: Implement built-in field descriptors
-                fi->access_flags = bf->flags;
-            }
+            class->instance_field_count++;
+        }
+    }
+
+    if (class->instance_field_count) {
+        class->instance_field_names = arena_alloc(&class->arena, sizeof(char*) * class->instance_field_count);
+
+        int j = 0;
+        for (int i = 0; i < class_builtins->fields_length; i++) {
+            builtin_fields *bf = &class_builtins->fields[i];
+            if (bf->flags & 0x0008)
+                continue;
+
+            class->instance_field_names[j++] = symbol_new(bf->name)->bytes;
         }
     }
 
     if (class->static_field_count) {
-        class->static_fields = malloc(sizeof(Field) * class->static_field_count);
+        class->static_fields = arena_alloc(&class->arena, sizeof(Field) * class->static_field_count);
         int j = 0;
         for (int i = 0; i < class_builtins->fields_length; i++) {
             builtin_fields *field = &class_builtins->fields[i];
             if (field->flags & 0x0008) { // ACC_STATIC
                 Field *f = &class->static_fields[j++];
-                f->name = field->name;
+                f->name = symbol_new(field->name)->bytes;
                 f->class = class;
             }
         }
     }
 
+    class_link(class);
     return class;
 }
 
+/* `class->methods` must already have room for every method of the class.
+ * The code is copied, as the class file goes away once the class is linked.
+ */
 void class_add_method(Class *class, FieldInfo method_info)
 {
-    Method *method = malloc(sizeof(Method));
-    AttributeInfo code = attributes_get_attribute(method_info.attributes, "Code");
+    Method *method = &class->methods[class->methods_count++];
+    AttributeInfo code = attributes_get_attribute(method_info.attributes, vm_symbols.code);
 
     method->name = method_info.name.name;
     method->class = class;
     method->data_length = code.CodeAttribute.code_length;
-    method->data = code.CodeAttribute.code;
+    method->data = NULL;
+    if (code.CodeAttribute.code) {
+        method->data = arena_alloc(&class->arena, method->data_length);
+        memcpy(method->data, code.CodeAttribute.code, method->data_length);
+    }
     method->flags = method_info.access_flags;
     method->max_stack = code.CodeAttribute.max_stack;
     method->max_local = code.CodeAttribute.max_locals;
-    method->descriptors = descriptors_new(method_info.descriptor.descriptor);
+    method->descriptors = descriptors_intern(method_info.descriptor.descriptor);
+    method->compiled = NULL;
+}
 
-    if (class->methods)
-        class->methods = realloc(class->methods, (sizeof(Method*) * (class->methods_count + 1)));
-    else
-        class->methods = malloc(sizeof(Method*));
+/* Whether the constant pool operand of `op` at `operand` is an entry of the
+ * kind the instruction needs. Instructions without one always pass.
+ */
+static bool method_operand_valid(ConstantPool *pool, uint8_t op, uint8_t *operand)
+{
+    uint16_t index = op == OP_LDC ? operand[0] : code_u16(operand);
+    uint8_t tag = constant_pool_get_tag(pool, index);
+
+    switch (op) {
+        case OP_LDC:
+        case OP_LDC_W:
+            return constant_pool_is_loadable(pool, index) && tag != CONSTANT_LONG && tag != CONSTANT_DOUBLE;
+        case OP_LDC2_W:
+            return tag == CONSTANT_LONG || tag == CONSTANT_DOUBLE;
+        case OP_GETSTATIC:
+        case OP_PUTSTATIC:
+        case OP_GETFIELD:
+        case OP_PUTFIELD:
+            return tag == CONSTANT_FIELDREF;
+        case OP_INVOKEVIRTUAL:
+            return tag == CONSTANT_METHODREF;
+        case OP_INVOKESPECIAL:
+        case OP_INVOKESTATIC:
+            return tag == CONSTANT_METHODREF || tag == CONSTANT_INTERFACE_METHODREF;
+        case OP_INVOKEINTERFACE:
+            return tag == CONSTANT_INTERFACE_METHODREF;
+        case OP_INVOKEDYNAMIC:
+            return tag == CONSTANT_INVOKEDYNAMIC;
+        case OP_NEW:
+        case OP_ANEWARRAY:
+        case OP_CHECKCAST:
+        case OP_INSTANCEOF:
+        case OP_MULTIANEWARRAY:
+            return tag == CONSTANT_CLASS;
+        default:
+            return true;
+    }
+}
+
+/* Runs once per method before it can be executed. Every constant pool
+ * operand is checked here, so the interpreter can index the pool with them
+ * as they are. This is also where we rewrite bytecode into faster internal
+ * variants once we know they are safe. Returns false if the code is
+ * malformed.
+ */
+bool method_prepare(Method *method)
+{
+    ConstantPool *pool = method->class->pool;
+    for (uint32_t pc = 0; pc < method->data_length;) {
+        int length = bytecode_instruction_length(method->data, method->data_length, pc);
+        if (!length || !method_operand_valid(pool, method->data[pc], &method->data[pc + 1])) {
+            printf("Invalid instruction at %u in method %s!\n", pc, method->name);
+            return false;
+        }
+
+        pc += length;
+    }
+
+    bytecode_eliminate_bounds_checks(method->data, method->data_length);
+    return true;
+}
+
+static inline uint32_t method_hash(Symbol *name, Symbol *descriptor)
+{
+    return name->hash * 31 + descriptor->hash;
+}
 
-    class->methods[class->methods_count] = method;
-    class->methods_count++;
+/* Sized once for every member, the index never grows */
+static void member_index_init(Arena *arena, MemberIndex *index, int count)
+{
+    uint32_t capacity = hash_table_capacity(count);
+
+    index->mask = capacity - 1;
+    index->count = 0;
+    index->entries = arena_alloc(arena, sizeof(MemberIndexEntry) * capacity);
 }
 
+/* Members are inserted in declaration order, so a lookup walking the probe
+ * sequence still finds the first of any duplicates, like a linear search.
+ */
+static void member_index_insert(MemberIndex *index, uint32_t hash, int position)
+{
+    MemberIndexEntry *entry = hash_table_free_entry(index, sizeof(MemberIndexEntry), hash);
+    entry->hash = hash;
+    entry->slot = position + 1;
+    index->count++;
+}
+
+/* Prepares the bytecode and builds the member lookup indexes once every
+ * method and static field of the class is in place. Classes are only loaded
+ * on first use, so this runs on demand too. Returns false if any method's
+ * code is malformed.
+ */
+bool class_link(Class *class)
+{
+    if (!class->built_in) {
+        for (int i = 0; i < class->methods_count; i++) {
+            if (!method_prepare(&class->methods[i]))
+                return false;
+        }
+    }
+
+    if (class->methods_count) {
+        member_index_init(&class->arena, &class->method_index, class->methods_count);
+        for (int i = 0; i < class->methods_count; i++) {
+            Method *method = &class->methods[i];
+            if (!method->descriptors)
+                continue;
+
+            uint32_t hash = method_hash(symbol_of(method->name), symbol_of(method->descriptors->descriptor));
+            member_index_insert(&class->method_index, hash, i);
+        }
+    }
+
+    if (class->static_field_count) {
+        member_index_init(&class->arena, &class->static_field_index, class->static_field_count);
+        for (int i = 0; i < class->static_field_count; i++) {
+            uint32_t hash = symbol_of(class->static_fields[i].name)->hash;
+            member_index_insert(&class->static_field_index, hash, i);
+        }
+    }
+
+    return true;
+}
+
+typedef struct MemberKey {
+    Class *class;
+    uint32_t hash;
+    Symbol *name;
+    Symbol *descriptor;
+} MemberKey;
+
+static bool method_index_match(const void *entry, const void *key)
+{
+    const MemberIndexEntry *e = entry;
+    const MemberKey *k = key;
+    if (e->hash != k->hash)
+        return false;
+
+    Method *method = &k->class->methods[e->slot - 1];
+    return method->name == k->name->bytes && method->descriptors->descriptor == k->descriptor->bytes;
+}
+
+Method *class_get_method_by_symbol(Class *class, Symbol *name, Symbol *descriptor)
+{
+    MemberKey key = { class, method_hash(name, descriptor), name, descriptor };
+    MemberIndexEntry *entry = hash_table_find(&class->method_index, sizeof(MemberIndexEntry), key.hash,
+                                              method_index_match, &key);
+    return entry ? &class->methods[entry->slot - 1] : NULL;
+}
+
+/* A name that was never interned can't belong to any method */
 Method *class_get_method(Class *class, char *name, char *descriptor)
 {
-    for (int i = 0; i < class->methods_count; i++) {
-        Method *method = class->methods[i];
-        if (!strcmp(method->name, name) && !strcmp(method->descriptors->descriptor, descriptor))
+    Symbol *name_symbol = symbol_find(name);
+    Symbol *descriptor_symbol = symbol_find(descriptor);
+    if (!name_symbol || !descriptor_symbol)
+        return NULL;
+
+    return class_get_method_by_symbol(class, name_symbol, descriptor_symbol);
+}
+
+/* Like class_get_method, but also searches the superclasses */
+Method *class_find_method_by_symbol(Class *class, Symbol *name, Symbol *descriptor)
+{
+    for (; class; class = class->parent) {
+        Method *method = class_get_method_by_symbol(class, name, descriptor);
+        if (method)
             return method;
     }
 
     return NULL;
 }
 
-Field *class_get_static_field(Class *class, char *name)
+Method *class_find_method(Class *class, char *name, char *descriptor)
 {
-    for (int i = 0; i < class->static_field_count; i++) {
-        Field *f = &class->static_fields[i];
-        if (!strcmp(name, f->name))
-            return f;
-    }
+    Symbol *name_symbol = symbol_find(name);
+    Symbol *descriptor_symbol = symbol_find(descriptor);
+    if (!name_symbol || !descriptor_symbol)
+        return NULL;
 
-    return NULL;
+    return class_find_method_by_symbol(class, name_symbol, descriptor_symbol);
+}
+
+static bool static_field_index_match(const void *entry, const void *key)
+{
+    const MemberIndexEntry *e = entry;
+    const MemberKey *k = key;
+    return k->class->static_fields[e->slot - 1].name == k->name->bytes;
+}
+
+Field *class_get_static_field_by_symbol(Class *class, Symbol *name)
+{
+    MemberKey key = { class, name->hash, name, NULL };
+    MemberIndexEntry *entry = hash_table_find(&class->static_field_index, sizeof(MemberIndexEntry), name->hash,
+                                              static_field_index_match, &key);
+    return entry ? &class->static_fields[entry->slot - 1] : NULL;
+}
+
+Field *class_get_static_field(Class *class, char *name)
+{
+    Symbol *symbol = symbol_find(name);
+    return symbol ? class_get_static_field_by_symbol(class, symbol) : NULL;
 }
 
 /* Gets class method from index. Index is expected to be of type `method_ref` */
 Method *class_get_method_from_index(Class *class, uint16_t index)
 {
-    uint16_t method_index = class->pool->pool[index].method_ref.name_and_type_index;
-    uint16_t name_index = class->pool->pool[method_index].name_and_type_info.name_index;
-    uint16_t descriptor_index = class->pool->pool[method_index].name_and_type_info.descriptor_index;
+    return get_method(class->pool, class, index);
+}
+
+static bool classes_index_match(const void *entry, const void *key)
+{
+    return (*(Class* const*) entry)->name == key;
+}
 
-    char *name = constant_pool_resolve_string(class->pool, name_index);
-    char *descriptor = constant_pool_resolve_string(class->pool, descriptor_index);
-    return class_get_method(class, name, descriptor);
+static uint32_t classes_index_hash(const void *entry)
+{
+    return symbol_of((*(Class* const*) entry)->name)->hash;
 }
 
 bool classes_add_class(Classes *classes, Class *class)
@@ -785,41 +1344,104 @@ bool classes_add_class(Classes *classes, Class *class)
         return false;
 
     class->classes = classes;
-    classes->classes = realloc(classes->classes, (sizeof(Class*) * (classes->count + 1)));
+
+    if (classes->count == classes->capacity) {
+        classes->capacity = classes->capacity ? classes->capacity * 2 : 16;
+        classes->classes = realloc(classes->classes, sizeof(Class*) * classes->capacity);
+    }
     classes->classes[classes->count++] = class;
 
+    hash_table_reserve(&classes->index, sizeof(Class*), 64, classes_index_hash);
+
+    /* If a name is added twice, the first class keeps it */
+    Symbol *name = symbol_of(class->name);
+    Class **entry = hash_table_probe(&classes->index, sizeof(Class*), name->hash, classes_index_match, name->bytes);
+    if (!*entry) {
+        *entry = class;
+        classes->index.count++;
+    }
+
     return true;
 }
 
+Class *classes_get_class_by_symbol(Classes *classes, Symbol *name)
+{
+    Class **entry = hash_table_find(&classes->index, sizeof(Class*), name->hash, classes_index_match, name->bytes);
+    return entry ? *entry : NULL;
+}
+
 Class *classes_get_class(Classes *classes, char *name)
 {
-    for (int i = 0; i < classes->count; i++) {
-        Class *class = classes->classes[i];
-        if (!strcmp(class->name, name))
-            return class;
+    Symbol *symbol = symbol_find(name);
+    return symbol ? classes_get_class_by_symbol(classes, symbol) : NULL;
+}
+
+/* Returns the class, loading it from the class path if it isn't known yet */
+Class *classes_load_class(Classes *classes, Symbol *name)
+{
+    Class *class = classes_get_class_by_symbol(classes, name);
+    if (class)
+        return class;
+
+    printf("Loading class %s on first use.\n", name->bytes);
+
+    class = class_parse(classes, name->bytes);
+    if (!classes_add_class(classes, class))
+        return NULL;
+
+    return class;
+}
+
+/* Array classes resolve to their element class, e.g. [Ljava/lang/String; */
+Symbol *class_element_name(Symbol *name)
+{
+    char *bytes = name->bytes;
+    int length = name->length;
+
+    while (length && *bytes == '[') {
+        bytes++;
+        length--;
     }
 
-    return NULL;
+    if (length >= 2 && *bytes == 'L' && bytes[length - 1] == ';') {
+        bytes++;
+        length -= 2;
+    }
+
+    return bytes == name->bytes ? name : symbol_intern(bytes, length);
 }
 
-/* TODO: Fix this method */
+/* `index` may be a class entry or a field or method reference. The class is
+ * loaded on the first resolution and cached in the pool after that.
+ */
 Class *classes_get_class_from_index(Classes *classes, ConstantPool *pool, uint16_t index)
 {
-    char *name = constant_pool_resolve_class_name(pool, index);
-    return classes_get_class(classes, name);
+    index = constant_pool_get_class_index(pool, index);
+    if (pool->resolved[index])
+        return pool->resolved[index];
+
+    Symbol *name = class_element_name(constant_pool_resolve_symbol(pool, index));
+    Class *class = classes_load_class(classes, name);
+    if (!class) {
+        /* TODO: Throw this once exceptions are implemented */
+        fprintf(stderr, "Exception in thread \"main\" java.lang.NoClassDefFoundError: %s\n", name->bytes);
+        exit(1);
+    }
+
+    return pool->resolved[index] = class;
 }
 
 Method *classes_get_main_method(Classes *classes)
 {
-    for (int i = 0; i < classes->count; i++) {
+    for (uint32_t i = 0; i < classes->count; i++) {
         Class *class = classes->classes[i];
         for (int j = 0; j < class->methods_count; j++) {
-            Method *method = class->methods[j];
-            if (!strcmp(method->name, "main")) {
+            Method *method = &class->methods[j];
+            if (method->name == vm_symbols.main->bytes) {
                 // We found the main method. Great. Mark this as our main class.
                 printf("Found method main in class %s\n", class->name);
                 classes->main_class = class;
-                return class->methods[j];
+                return method;
             }
         }
     }
@@ -831,17 +1453,21 @@ Classes *classes_new()
 {
     Classes *classes = malloc(sizeof(Classes));
     classes->count = 0;
+    classes->capacity = 0;
     classes->classes = NULL;
+    classes->main_class = NULL;
+    memset(&classes->index, 0, sizeof(HashTable));
 
     return classes;
 }
 
 void classes_free(Classes *classes)
 {
-    for (int i = 0; i < classes->count; i++) {
+    for (uint32_t i = 0; i < classes->count; i++) {
         Class *class = classes->classes[i];
         class_free(class);
     }
     free(classes->classes);
+    hash_table_free(&classes->index);
     free(classes);
 }
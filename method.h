@@ -25,10 +25,14 @@
 #include <stddef.h>
 #include <sys/stat.h>
 #include "minijvm.h"
+#include "arena.h"
 #include "constantpool.h"
+#include "hashtable.h"
 #include "reader.h"
 #include "stack.h"
 #include "descriptor.h"
+#include "symbol.h"
+#include "classpath.h"
 
 typedef struct Attributes Attributes;
 typedef struct ConstantPool ConstantPool;
@@ -57,8 +61,7 @@ typedef struct Fields {
 /* Helper functions */
 extern FieldInfo fields_get_field(Fields *fields, char *name);
 
-extern Fields *fields_new(Reader *reader, ConstantPool *pool);
-extern void fields_free(Fields *fields);
+extern Fields *fields_new(Reader *reader, ConstantPool *pool, Arena *arena);
 
 /* Method execution */
 
@@ -83,6 +86,8 @@ extern void frame_free(Frame *frame);
  * it doesn't have its own methods.
 */
 typedef void (*builtin_method)(Method *method, Frame *frame);
+/* Takes the method's locals and returns its result, see aot.h */
+typedef Variant (*compiled_method)(Method *method, Variant *locals);
 
 typedef struct Method {
     struct Class *class;
@@ -96,6 +101,8 @@ typedef struct Method {
     Descriptors *descriptors;
     int max_stack;
     int max_local;
+    /* Bound by aot_bind, runs in place of `data` */
+    compiled_method compiled;
 } Method;
 
 typedef struct Field {
@@ -104,52 +111,92 @@ typedef struct Field {
     Variant value;
 } Field;
 
+/* Index over the methods or static fields of a class. Entries store the
+ * member's position plus one, so zero marks a free slot.
+ */
+typedef struct MemberIndexEntry {
+    uint32_t hash;
+    uint16_t slot;
+} MemberIndexEntry;
+
+/* Holds MemberIndexEntry, allocated from the class's arena */
+typedef HashTable MemberIndex;
+
 typedef struct Class {
     struct Classes *classes;
-    /* Each class has an associated Reader to read data */
-    void *data;
-    Reader *reader;
 
     uint16_t flags;
     char *name;
     struct Class *parent;
+    /* Set by class_read, `parent` is resolved from it when published */
+    Symbol *parent_name;
     bool built_in;
+    /* Mapped from the shared archive, see cds.h. Never freed */
+    bool shared;
+
+    /* Owns the metadata below: the pool, members, code and indexes */
+    Arena arena;
 
     /* Each class has its own constant pool, except built-ins */
     ConstantPool *pool;
 
+    /* Allocated once at the final count, so Method pointers stay valid */
     uint16_t methods_count;
-    /* TODO: Maybe make this a single pointer? */
-    Method **methods;
+    Method *methods;
 
     uint16_t static_field_count;
     Field *static_fields;
     bool static_initialized;
 
-    /* These are not meant to be used by any functions except our own */
-    Fields *class_fields;
-    Fields *method_fields;
-    Attributes *attributes;
+    /* Built by class_link, keyed on name and descriptor for methods and
+     * on name for static fields
+     */
+    MemberIndex method_index;
+    MemberIndex static_field_index;
+
+    /* Every instance gets one Field per name, in declaration order */
+    uint16_t instance_field_count;
+    char **instance_field_names;
+
+    /* From the BootstrapMethods attribute, for invokedynamic */
+    uint16_t bootstrap_methods_count;
+    struct BootstrapMethod *bootstrap_methods;
 } Class;
 
 typedef struct Classes {
-    uint16_t count;
+    uint32_t count;
+    uint32_t capacity;
     Class **classes;
     Class *main_class;
+
+    /* Index of `classes` by name symbol, holding Class pointers */
+    HashTable index;
 } Classes;
 
-extern Class *class_parse_file(Classes *classes, char *filename);
+extern Class *class_read(char *name);
+extern Class *class_parse(Classes *classes, char *name);
+extern Symbol *class_element_name(Symbol *name);
 extern Class *class_create_builtin(char *name, builtins *class_builtins, Classes *classes);
+extern bool class_link(Class *class);
 extern void class_initialize_static(Class *class);
 extern void class_free(Class *class);
 
 extern void class_add_method(Class *class, FieldInfo method_info);
+/* The _by_symbol variants compare interned names by pointer. The others take
+ * any C string and look up its symbol first.
+ */
 extern Method *class_get_method(Class *class, char *name, char *descriptor);
+extern Method *class_get_method_by_symbol(Class *class, Symbol *name, Symbol *descriptor);
+extern Method *class_find_method(Class *class, char *name, char *descriptor);
+extern Method *class_find_method_by_symbol(Class *class, Symbol *name, Symbol *descriptor);
 extern Method *class_get_method_from_index(Class *class, uint16_t index);
 extern Field *class_get_static_field(Class *class, char *name);
+extern Field *class_get_static_field_by_symbol(Class *class, Symbol *name);
 
 extern bool classes_add_class(Classes *classes, Class *class);
 extern Class *classes_get_class(Classes *classes, char *name);
+extern Class *classes_get_class_by_symbol(Classes *classes, Symbol *name);
+extern Class *classes_load_class(Classes *classes, Symbol *name);
 extern Class *classes_get_class_from_index(Classes *classes, ConstantPool *pool, uint16_t index);
 
 extern Method *classes_get_main_method(Classes *classes);
@@ -157,6 +204,26 @@ extern Method *classes_get_main_method(Classes *classes);
 extern Classes *classes_new();
 extern void classes_free(Classes *classes);
 
+extern Method *get_method(ConstantPool *pool, Class *class, uint16_t index);
+
+/* What invokeinterface needs of an InterfaceMethodref, kept in its resolved
+ * slot, see interface_call
+ */
+typedef struct InterfaceCall {
+    Symbol *name;
+    Symbol *descriptor;
+    int arguments_count;
+    /* The last receiver's class and the method it resolved to */
+    Class *receiver_class;
+    Method *method;
+} InterfaceCall;
+
+extern InterfaceCall *interface_call(ConstantPool *pool, uint16_t index);
+/* Throws if `receiver` is null or has no such method */
+extern Method *interface_call_target(InterfaceCall *call, Object *receiver);
+extern bool method_prepare(Method *method);
+extern void method_invoke(Method *method, Frame *frame, bool has_this);
+extern Variant method_call(Method *method, Variant *args, bool has_this);
 extern void method_execute(Method *method, Frame *frame);
 
 #endif
\ No newline at end of file
@@ -23,37 +23,179 @@
 #include "minijvm.h"
 #include "reader.h"
 #include "builtins/builtins.h"
+#include "loader.h"
+#include "classpath.h"
+#include "cds.h"
+#include "snapshot.h"
+#include "aot.h"
+#include "descriptor.h"
 
 static char *help_text = "miniJVM: a stupidly simple JVM. \n\
-Usage: ./miniJVM <class name>\n";
+Usage: ./miniJVM [options] <class name>\n\
+Options:\n\
+  -cp, -classpath <path>      colon separated directories and JAR files to load classes from\n\
+  -XX:AutoBoxCacheMax=<size>  cache boxed Integers from -128 up to <size>\n\
+  -XX:LoaderThreads=<count>   parse every reachable class up front on <count> threads\n\
+  -XX:SharedArchiveFile=<file> map classes from the shared archive <file>\n\
+  -Xshare:dump                write every class reachable from <class name> to the shared archive and exit\n\
+  -XX:Checkpoint=<file>       initialize the main class, then write the VM's state to <file> and exit\n\
+  -XX:CheckpointAfter=<name>  run the static ()V method <name> of the main class before the checkpoint\n\
+  -XX:Restore=<file>          start from the state in <file> instead of initializing again\n\
+  -XX:AOTLibrary=<file>       run the methods compiled into the shared library <file> natively\n\
+  -Xaot:compile               compile every class reachable from <class name> into the AOT library and exit\n";
 
 int main(int argc, char *argv[])
 {
-    if (argc < 2) {
+    /* Before anything is written to stdout */
+    printstream_init();
+
+    int loader_threads = 0;
+    char *shared_archive = NULL;
+    bool dump_archive = false;
+    char *checkpoint = NULL;
+    char *checkpoint_after = NULL;
+    char *restore = NULL;
+    char *aot_library = NULL;
+    bool aot_compile_library = false;
+    char *class_path = getenv("CLASSPATH");
+    int arg = 1;
+    for (; arg < argc && argv[arg][0] == '-'; arg++) {
+        if (!strcmp(argv[arg], "-cp") || !strcmp(argv[arg], "-classpath")) {
+            if (++arg >= argc) {
+                fprintf(stderr, "miniJVM: %s requires a class path\n", argv[arg - 1]);
+                fprintf(stderr, help_text);
+                return 1;
+            }
+            class_path = argv[arg];
+        } else if (!strncmp(argv[arg], "-XX:AutoBoxCacheMax=", 20)) {
+            char *end;
+            long max = strtol(argv[arg] + 20, &end, 10);
+            if (end == argv[arg] + 20 || *end || max < INT32_MIN || max > INT32_MAX || !integer_set_cache_max(max)) {
+                fprintf(stderr, "miniJVM: invalid %s\n", argv[arg]);
+                return 1;
+            }
+        } else if (!strncmp(argv[arg], "-XX:LoaderThreads=", 18)) {
+            char *end;
+            long threads = strtol(argv[arg] + 18, &end, 10);
+            if (end == argv[arg] + 18 || *end || threads < 1 || threads > LOADER_THREADS_MAX) {
+                fprintf(stderr, "miniJVM: invalid %s\n", argv[arg]);
+                return 1;
+            }
+            loader_threads = threads;
+        } else if (!strncmp(argv[arg], "-XX:SharedArchiveFile=", 22)) {
+            shared_archive = argv[arg] + 22;
+        } else if (!strcmp(argv[arg], "-Xshare:dump")) {
+            dump_archive = true;
+        } else if (!strncmp(argv[arg], "-XX:Checkpoint=", 15)) {
+            checkpoint = argv[arg] + 15;
+        } else if (!strncmp(argv[arg], "-XX:CheckpointAfter=", 20)) {
+            checkpoint_after = argv[arg] + 20;
+        } else if (!strncmp(argv[arg], "-XX:Restore=", 12)) {
+            restore = argv[arg] + 12;
+        } else if (!strncmp(argv[arg], "-XX:AOTLibrary=", 15)) {
+            aot_library = argv[arg] + 15;
+        } else if (!strcmp(argv[arg], "-Xaot:compile")) {
+            aot_compile_library = true;
+        } else {
+            fprintf(stderr, "miniJVM: unknown option %s\n", argv[arg]);
+            fprintf(stderr, help_text);
+            return 1;
+        }
+    }
+
+    if (arg >= argc) {
         fprintf(stderr, "miniJVM: invalid arguments!\n");
         fprintf(stderr, help_text);
         return 1;
     }
 
-    if (argc > 2) {
+    if (argc - arg > 1) {
         fprintf(stderr, "miniJVM: too many arguments!\n");
         return 1;
     }
 
-    char filename[2048];
-    snprintf(filename, 2048, "%s%s", argv[1], ".class");
+    if (dump_archive && !shared_archive) {
+        fprintf(stderr, "miniJVM: -Xshare:dump requires -XX:SharedArchiveFile\n");
+        return 1;
+    }
+
+    if (aot_compile_library && !aot_library) {
+        fprintf(stderr, "miniJVM: -Xaot:compile requires -XX:AOTLibrary\n");
+        return 1;
+    }
+
+    /* Accept both a.b.Main and a/b/Main */
+    char *class_name = argv[arg];
+    for (char *c = class_name; *c; c++) {
+        if (*c == '.')
+            *c = '/';
+    }
+
+    classpath_init(class_path && *class_path ? class_path : ".");
+    /* The archived symbols have to be in the table before anything is interned */
+    if (shared_archive && !dump_archive)
+        cds_map(shared_archive);
 
+    symbol_table_init();
     Classes *classes = classes_new();
 
+    /* System.out is buffered, make sure it goes out however we exit */
+    atexit(printstream_flush);
+
     /* Setup built-in classes and methods */
     classes_add_class(classes, class_create_builtin("java/lang/Object", &java_lang_Object_builtins, classes));
     classes_add_class(classes, class_create_builtin("java/util/Objects", &java_util_Objects_builtins, classes));
+    classes_add_class(classes, class_create_builtin("java/util/Collection", &java_util_Collection_builtins, classes));
+    classes_add_class(classes, class_create_builtin("java/util/List", &java_util_List_builtins, classes));
+    classes_add_class(classes, class_create_builtin("java/util/ArrayList", &java_util_ArrayList_builtins, classes));
+    classes_add_class(classes, class_create_builtin("java/util/Map", &java_util_Map_builtins, classes));
+    classes_add_class(classes, class_create_builtin("java/util/HashMap", &java_util_HashMap_builtins, classes));
     classes_add_class(classes, class_create_builtin("java/lang/System", &java_lang_System_builtins, classes));
     classes_add_class(classes, class_create_builtin("java/io/PrintStream", &java_io_PrintStream_builtins, classes));
     classes_add_class(classes, class_create_builtin("java/lang/String", &java_lang_String_builtins, classes));
+    classes_add_class(classes, class_create_builtin("java/lang/Integer", &java_lang_Integer_builtins, classes));
+    classes_add_class(classes, class_create_builtin("java/lang/StringBuilder", &java_lang_StringBuilder_builtins, classes));
     classes_add_class(classes, class_create_builtin("java/lang/invoke/StringConcatFactory", &java_lang_invoke_StringConcatFactory_builtins, classes));
 
-    if (!classes_add_class(classes, class_parse_file(classes, filename))) {
+    /* Dumping needs every class up front, and stops before running anything */
+    if (dump_archive) {
+        bool dumped = loader_preload(classes, class_name, loader_threads > 0 ? loader_threads : 1) &&
+                      cds_dump(classes, shared_archive);
+
+        classes_free(classes);
+        classpath_free();
+        descriptor_table_free();
+        symbol_table_free();
+        return dumped ? 0 : 1;
+    }
+
+    if (aot_compile_library) {
+        bool compiled = loader_preload(classes, class_name, loader_threads > 0 ? loader_threads : 1) &&
+                        aot_compile(classes, aot_library);
+
+        classes_free(classes);
+        classpath_free();
+        descriptor_table_free();
+        symbol_table_free();
+        cds_unmap();
+        return compiled ? 0 : 1;
+    }
+
+    /* Classes bind their compiled methods as they are loaded */
+    if (aot_library)
+        aot_load(aot_library);
+
+    /* A snapshot that doesn't match is ignored, and the VM starts as usual.
+     * By default classes are loaded lazily, on first use.
+     */
+    if (restore && snapshot_restore(classes, restore, class_name)) {
+        /* The main class and everything it initialized are back */
+    } else if (loader_threads > 0) {
+        if (!loader_preload(classes, class_name, loader_threads)) {
+            classes_free(classes);
+            return 1;
+        }
+    } else if (!classes_add_class(classes, class_parse(classes, class_name))) {
         classes_free(classes);
         return 1;
     }
@@ -67,11 +209,46 @@ int main(int argc, char *argv[])
         return 1;
     }
 
+    if (checkpoint) {
+        /* A JVM initializes the main class before main runs, too */
+        Class *main_class = classes->main_class;
+        if (!main_class->static_initialized)
+            class_initialize_static(main_class);
+
+        if (checkpoint_after) {
+            Method *warm_up = class_get_method(main_class, checkpoint_after, "()V");
+            if (!warm_up) {
+                fprintf(stderr, "miniJVM: %s has no method %s()V\n", main_class->name, checkpoint_after);
+                classes_free(classes);
+                return 1;
+            }
+
+            Frame *frame = frame_new(warm_up->max_stack, warm_up->max_local);
+            method_execute(warm_up, frame);
+            frame_free(frame);
+        }
+
+        bool written = snapshot_write(classes, checkpoint);
+
+        classes_free(classes);
+        classpath_free();
+        descriptor_table_free();
+        symbol_table_free();
+        cds_unmap();
+        aot_unload();
+        return written ? 0 : 1;
+    }
+
     Frame *main_frame = frame_new(main_method->max_stack, main_method->max_local);
 
     method_execute(main_method, main_frame);
 
     classes_free(classes);
     frame_free(main_frame);
+    classpath_free();
+    descriptor_table_free();
+    symbol_table_free();
+    cds_unmap();
+    aot_unload();
     return 0;
 }
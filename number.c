@@ -0,0 +1,97 @@
+/*
+ * This file is part of MiniJVM (https://github.com/muhammad23012009/minijvm)
+ * Copyright (c) 2025 Muhammad  <thevancedgamer@mentallysanemainliners.org>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "number.h"
+
+static const char digit_pairs[200] =
+    "00010203040506070809"
+    "10111213141516171819"
+    "20212223242526272829"
+    "30313233343536373839"
+    "40414243444546474849"
+    "50515253545556575859"
+    "60616263646566676869"
+    "70717273747576777879"
+    "80818283848586878889"
+    "90919293949596979899";
+
+static const uint64_t powers_of_ten[] = {
+    1ULL, 10ULL, 100ULL, 1000ULL, 10000ULL, 100000ULL, 1000000ULL, 10000000ULL,
+    100000000ULL, 1000000000ULL, 10000000000ULL, 100000000000ULL, 1000000000000ULL,
+    10000000000000ULL, 100000000000000ULL, 1000000000000000ULL, 10000000000000000ULL,
+    100000000000000000ULL, 1000000000000000000ULL, 10000000000000000000ULL,
+};
+
+/* log10 estimated from the bit length (1233 / 4096 ~ log10(2)), then
+ * corrected by one comparison. Setting the low bit never crosses a power
+ * of ten and makes zero count as one digit.
+ */
+static int digits_count(uint64_t value)
+{
+    value |= 1;
+    int estimate = ((64 - __builtin_clzll(value)) * 1233) >> 12;
+    return estimate + (value >= powers_of_ten[estimate]);
+}
+
+/* Writes the digits backwards, two at a time, ending just before `end` */
+static void write_digits(uint64_t value, char *end)
+{
+    while (value >= 100) {
+        int pair = (value % 100) * 2;
+        value /= 100;
+        *--end = digit_pairs[pair + 1];
+        *--end = digit_pairs[pair];
+    }
+
+    if (value >= 10) {
+        *--end = digit_pairs[value * 2 + 1];
+        *--end = digit_pairs[value * 2];
+    } else {
+        *--end = '0' + value;
+    }
+}
+
+/* Negating in unsigned arithmetic keeps INT64_MIN well defined */
+static uint64_t magnitude(int64_t value)
+{
+    return value < 0 ? -(uint64_t) value : (uint64_t) value;
+}
+
+int number_int_length(int32_t value)
+{
+    return number_long_length(value);
+}
+
+int number_long_length(int64_t value)
+{
+    return (value < 0) + digits_count(magnitude(value));
+}
+
+int number_format_int(int32_t value, char *dest)
+{
+    return number_format_long(value, dest);
+}
+
+int number_format_long(int64_t value, char *dest)
+{
+    int length = number_long_length(value);
+    if (value < 0)
+        dest[0] = '-';
+
+    write_digits(magnitude(value), dest + length);
+    return length;
+}
\ No newline at end of file
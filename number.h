@@ -0,0 +1,38 @@
+/*
+ * This file is part of MiniJVM (https://github.com/muhammad23012009/minijvm)
+ * Copyright (c) 2025 Muhammad  <thevancedgamer@mentallysanemainliners.org>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef NUMBER_H
+#define NUMBER_H
+
+/* Decimal formatting of ints and longs, shared by everything that turns
+ * numbers into text. The length is known up front, so callers can size
+ * their output exactly and let the digits be written in place.
+ */
+
+#include <stdint.h>
+
+/* Number of chars needed to print `value`, including the minus sign */
+extern int number_int_length(int32_t value);
+extern int number_long_length(int64_t value);
+
+/* Writes exactly number_*_length(value) chars without a terminator and
+ * returns that count.
+ */
+extern int number_format_int(int32_t value, char *dest);
+extern int number_format_long(int64_t value, char *dest);
+
+#endif
\ No newline at end of file
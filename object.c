@@ -23,11 +23,11 @@
  * Also maybe we want to add something else here?
  */
 
-Field *object_get_field(Object *object, char *field_name)
+Field *object_get_field(Object *object, Symbol *field_name)
 {
     for (int i = 0; i < object->fields_count; i++) {
         Field *f = object->fields[i];
-        if (!strcmp(f->name, field_name))
+        if (f->name == field_name->bytes)
             return f;
     }
 
@@ -39,16 +39,16 @@ Object *object_new(Class *class)
     Object *object = malloc(sizeof(Object));
     object->class = class;
     object->initialized = false;
+    object->pinned = false;
 
-    /* Parse all fields in the class */
-    if (class->class_fields) {
-        object->fields_count = class->class_fields->count;
+    /* One field for each in the class's layout */
+    if (class->instance_field_count) {
+        object->fields_count = class->instance_field_count;
         object->fields = malloc(sizeof(Field*) * object->fields_count);
-        for (int i = 0; i < class->class_fields->count; i++) {
-            FieldInfo *info = &class->class_fields->fields[i];
+        for (int i = 0; i < class->instance_field_count; i++) {
             Field *field = malloc(sizeof(Field));
 
-            field->name = info->name.name;
+            field->name = class->instance_field_names[i];
             field->class = class;
             object->fields[i] = field;
         }
@@ -60,6 +60,15 @@ Object *object_new(Class *class)
     return object;
 }
 
+/* Objects never move, so the address makes a stable identity hash. The
+ * low bits are always zero due to alignment and are shifted out.
+ */
+int32_t object_identity_hash(Object *object)
+{
+    uintptr_t address = (uintptr_t) object;
+    return (int32_t) ((address >> 4) ^ (address >> 36));
+}
+
 void object_free(Object *object)
 {
     for (int i = 0; i < object->fields_count; i++)
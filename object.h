@@ -25,6 +25,7 @@
 #include <stdlib.h>
 #include <stdbool.h>
 #include "method.h"
+#include "symbol.h"
 
 typedef struct Class Class;
 typedef struct Field Field;
@@ -32,13 +33,18 @@ typedef struct Field Field;
 typedef struct Object {
     Class *class;
     bool initialized;
+    /* Pinned objects are owned by the VM (e.g. interned strings) and are
+     * never freed along with a frame.
+     */
+    bool pinned;
 
     uint16_t fields_count;
     Field **fields;
 } Object;
 
-extern Field *object_get_field(Object *object, char *field_name);
+extern Field *object_get_field(Object *object, Symbol *field_name);
 extern Object *object_new(Class *class);
+extern int32_t object_identity_hash(Object *object);
 extern void object_free(Object *object);
 
 #endif
\ No newline at end of file
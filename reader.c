@@ -19,54 +19,83 @@
 
 #include "reader.h"
 
-uint8_t reader_read_uint8(Reader *reader)
+/* Returns where the next `len` bytes are and moves past them, or NULL if
+ * there aren't that many left
+ */
+static void *reader_take(Reader *reader, int len)
 {
+    if (len < 0 || len > reader->size - reader->offset) {
+        reader->offset = reader->size;
+        reader->overflow = true;
+        return NULL;
+    }
+
     void *ptr = &reader->data[reader->offset];
-    reader->offset += 1;
-    return *(uint8_t*)ptr;
+    reader->offset += len;
+    return ptr;
+}
+
+uint8_t reader_read_uint8(Reader *reader)
+{
+    void *ptr = reader_take(reader, 1);
+    return ptr ? *(uint8_t*)ptr : 0;
 }
 
 uint16_t reader_read_uint16(Reader *reader)
 {
-    void *val = &reader->data[reader->offset];
-    reader->offset += 2;
-    return *(uint16_t*)val;
+    uint16_t val = 0;
+    void *ptr = reader_take(reader, 2);
+    if (ptr)
+        memcpy(&val, ptr, 2);
+    return val;
 }
 
 uint16_t reader_read_uint16_be(Reader *reader)
 {
-    void *ptr = &reader->data[reader->offset];
-    reader->offset += 2;
-    uint16_t val = htobe16(*(uint16_t*)ptr);
-    return val;
+    return htobe16(reader_read_uint16(reader));
 }
 
 uint32_t reader_read_uint32(Reader *reader)
 {
-    void *ptr = &reader->data[reader->offset];
-    reader->offset += 4;
-    uint32_t val = htole32(*(uint32_t*)ptr);
-    return val;
+    uint32_t val = 0;
+    void *ptr = reader_take(reader, 4);
+    if (ptr)
+        memcpy(&val, ptr, 4);
+    return htole32(val);
 }
 
 uint32_t reader_read_uint32_be(Reader *reader)
 {
-    void *ptr = &reader->data[reader->offset];
-    reader->offset += 4;
-    uint32_t val = htobe32(*(uint32_t*)ptr);
-    return val;
+    uint32_t val = 0;
+    void *ptr = reader_take(reader, 4);
+    if (ptr)
+        memcpy(&val, ptr, 4);
+    return htobe32(val);
 }
 
 void reader_read_bytes(Reader *reader, char *dest, int len)
 {
-    void *ptr = &reader->data[reader->offset];
-    memcpy(dest, ptr, len);
-    reader->offset += len;
+    void *ptr = reader_take(reader, len);
+    if (ptr)
+        memcpy(dest, ptr, len);
+    else if (len > 0)
+        memset(dest, 0, len);
+}
+
+/* Returns a pointer to the next `len` bytes instead of copying them out */
+void *reader_get_bytes(Reader *reader, int len)
+{
+    return reader_take(reader, len);
 }
 
 void reader_skip(Reader *reader, int length)
 {
-    reader->offset += length;
+    reader_take(reader, length);
+}
+
+int reader_remaining(Reader *reader)
+{
+    return reader->size - reader->offset;
 }
 
 Reader *reader_new(void *data, int size)
@@ -75,6 +104,7 @@ Reader *reader_new(void *data, int size)
     reader->data = data;
     reader->size = size;
     reader->offset = 0;
+    reader->overflow = false;
 
     return reader;
 }
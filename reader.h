@@ -24,10 +24,15 @@
 #include <stdbool.h>
 #include <endian.h>
 
+/* Reads never go past `size`. One that would returns zeroes (or NULL from
+ * reader_get_bytes) and sets `overflow`, which stays set, so a parser can
+ * check once at the end instead of before every read.
+ */
 typedef struct Reader {
     char *data;
     int size;
     int offset;
+    bool overflow;
 } Reader;
 
 extern Reader *reader_new(void *data, int size);
@@ -38,6 +43,8 @@ extern uint16_t reader_read_uint16_be(Reader *reader);
 extern uint32_t reader_read_uint32(Reader *reader);
 extern uint32_t reader_read_uint32_be(Reader *reader);
 extern void reader_read_bytes(Reader *reader, char *dest, int len);
+extern void *reader_get_bytes(Reader *reader, int len);
 extern void reader_skip(Reader *reader, int length);
+extern int reader_remaining(Reader *reader);
 
 #endif
\ No newline at end of file
@@ -0,0 +1,368 @@
+/*
+ * This file is part of MiniJVM (https://github.com/muhammad23012009/minijvm)
+ * Copyright (c) 2025 Muhammad  <thevancedgamer@mentallysanemainliners.org>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "simd.h"
+
+/* Every kernel follows the same pattern: the vector loop handles whole
+ * blocks and returns where it stopped (either the exact answer or the end
+ * of the last whole block), and a scalar loop finishes the tail.
+ */
+
+#if defined(__x86_64__) || (defined(__i386__) && defined(__SSE2__))
+#define SIMD_X86
+#include <immintrin.h>
+
+#define AVX2 __attribute__((target("avx2")))
+
+static bool has_avx2(void)
+{
+    static int supported = -1;
+    if (supported < 0) {
+        __builtin_cpu_init();
+        supported = __builtin_cpu_supports("avx2");
+    }
+
+    return supported;
+}
+
+static size_t ascii_prefix_sse2(const uint8_t *data, size_t length)
+{
+    size_t i = 0;
+    for (; i + 16 <= length; i += 16) {
+        uint32_t mask = _mm_movemask_epi8(_mm_loadu_si128((const __m128i*) (data + i)));
+        if (mask)
+            return i + __builtin_ctz(mask);
+    }
+
+    return i;
+}
+
+AVX2 static size_t ascii_prefix_avx2(const uint8_t *data, size_t length)
+{
+    size_t i = 0;
+    for (; i + 32 <= length; i += 32) {
+        uint32_t mask = _mm256_movemask_epi8(_mm256_loadu_si256((const __m256i*) (data + i)));
+        if (mask)
+            return i + __builtin_ctz(mask);
+    }
+
+    return i;
+}
+
+static size_t mismatch_sse2(const uint8_t *a, const uint8_t *b, size_t length)
+{
+    size_t i = 0;
+    for (; i + 16 <= length; i += 16) {
+        __m128i va = _mm_loadu_si128((const __m128i*) (a + i));
+        __m128i vb = _mm_loadu_si128((const __m128i*) (b + i));
+        uint32_t mask = _mm_movemask_epi8(_mm_cmpeq_epi8(va, vb)) ^ 0xFFFF;
+        if (mask)
+            return i + __builtin_ctz(mask);
+    }
+
+    return i;
+}
+
+AVX2 static size_t mismatch_avx2(const uint8_t *a, const uint8_t *b, size_t length)
+{
+    size_t i = 0;
+    for (; i + 32 <= length; i += 32) {
+        __m256i va = _mm256_loadu_si256((const __m256i*) (a + i));
+        __m256i vb = _mm256_loadu_si256((const __m256i*) (b + i));
+        uint32_t mask = ~(uint32_t) _mm256_movemask_epi8(_mm256_cmpeq_epi8(va, vb));
+        if (mask)
+            return i + __builtin_ctz(mask);
+    }
+
+    return i;
+}
+
+static size_t index_of_u8_sse2(const uint8_t *data, size_t length, uint8_t value)
+{
+    __m128i needle = _mm_set1_epi8(value);
+    size_t i = 0;
+    for (; i + 16 <= length; i += 16) {
+        __m128i chunk = _mm_loadu_si128((const __m128i*) (data + i));
+        uint32_t mask = _mm_movemask_epi8(_mm_cmpeq_epi8(chunk, needle));
+        if (mask)
+            return i + __builtin_ctz(mask);
+    }
+
+    return i;
+}
+
+AVX2 static size_t index_of_u8_avx2(const uint8_t *data, size_t length, uint8_t value)
+{
+    __m256i needle = _mm256_set1_epi8(value);
+    size_t i = 0;
+    for (; i + 32 <= length; i += 32) {
+        __m256i chunk = _mm256_loadu_si256((const __m256i*) (data + i));
+        uint32_t mask = _mm256_movemask_epi8(_mm256_cmpeq_epi8(chunk, needle));
+        if (mask)
+            return i + __builtin_ctz(mask);
+    }
+
+    return i;
+}
+
+/* The byte mask has two bits per matching code unit */
+static size_t index_of_u16_sse2(const uint16_t *data, size_t length, uint16_t value)
+{
+    __m128i needle = _mm_set1_epi16(value);
+    size_t i = 0;
+    for (; i + 8 <= length; i += 8) {
+        __m128i chunk = _mm_loadu_si128((const __m128i*) (data + i));
+        uint32_t mask = _mm_movemask_epi8(_mm_cmpeq_epi16(chunk, needle));
+        if (mask)
+            return i + __builtin_ctz(mask) / 2;
+    }
+
+    return i;
+}
+
+AVX2 static size_t index_of_u16_avx2(const uint16_t *data, size_t length, uint16_t value)
+{
+    __m256i needle = _mm256_set1_epi16(value);
+    size_t i = 0;
+    for (; i + 16 <= length; i += 16) {
+        __m256i chunk = _mm256_loadu_si256((const __m256i*) (data + i));
+        uint32_t mask = _mm256_movemask_epi8(_mm256_cmpeq_epi16(chunk, needle));
+        if (mask)
+            return i + __builtin_ctz(mask) / 2;
+    }
+
+    return i;
+}
+
+/* Number of leading bytes from 0x01 to 0x7F, which are valid on their own
+ * in modified UTF-8. Zero bytes get their top bit set by the compare.
+ */
+static size_t utf8_plain_prefix_sse2(const uint8_t *data, size_t length)
+{
+    __m128i zero = _mm_setzero_si128();
+    size_t i = 0;
+    for (; i + 16 <= length; i += 16) {
+        __m128i chunk = _mm_loadu_si128((const __m128i*) (data + i));
+        uint32_t mask = _mm_movemask_epi8(_mm_or_si128(chunk, _mm_cmpeq_epi8(chunk, zero)));
+        if (mask)
+            return i + __builtin_ctz(mask);
+    }
+
+    return i;
+}
+
+AVX2 static size_t utf8_plain_prefix_avx2(const uint8_t *data, size_t length)
+{
+    __m256i zero = _mm256_setzero_si256();
+    size_t i = 0;
+    for (; i + 32 <= length; i += 32) {
+        __m256i chunk = _mm256_loadu_si256((const __m256i*) (data + i));
+        uint32_t mask = _mm256_movemask_epi8(_mm256_or_si256(chunk, _mm256_cmpeq_epi8(chunk, zero)));
+        if (mask)
+            return i + __builtin_ctz(mask);
+    }
+
+    return i;
+}
+
+static bool utf16_is_latin1_sse2(const uint16_t *data, size_t length, size_t *done)
+{
+    __m128i high = _mm_set1_epi16((short) 0xFF00);
+    __m128i acc = _mm_setzero_si128();
+    size_t i = 0;
+    for (; i + 8 <= length; i += 8)
+        acc = _mm_or_si128(acc, _mm_loadu_si128((const __m128i*) (data + i)));
+
+    *done = i;
+    acc = _mm_and_si128(acc, high);
+    return _mm_movemask_epi8(_mm_cmpeq_epi16(acc, _mm_setzero_si128())) == 0xFFFF;
+}
+
+/* 31^7 ... 31^0, the weight of each lane once all blocks are folded in */
+#define HASH_WEIGHTS 1742810335, 887503681, 28629151, 923521, 29791, 961, 31, 1
+/* 31^8, applied to the accumulator for every block of 8 chars */
+#define HASH_STEP 0x94446f01
+
+AVX2 static uint32_t hash_reduce_avx2(__m256i acc)
+{
+    acc = _mm256_mullo_epi32(acc, _mm256_setr_epi32(HASH_WEIGHTS));
+
+    __m128i sum = _mm_add_epi32(_mm256_castsi256_si128(acc), _mm256_extracti128_si256(acc, 1));
+    sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(1, 0, 3, 2)));
+    sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(2, 3, 0, 1)));
+    return _mm_cvtsi128_si32(sum);
+}
+
+/* Each lane accumulates every 8th char. Seeding the last lane with the
+ * incoming hash multiplies it by 31^8 per block, as the scalar loop would.
+ */
+AVX2 static uint32_t hash_u8_avx2(const uint8_t *data, size_t blocks, uint32_t hash)
+{
+    __m256i step = _mm256_set1_epi32(HASH_STEP);
+    __m256i acc = _mm256_setr_epi32(0, 0, 0, 0, 0, 0, 0, hash);
+
+    for (size_t i = 0; i < blocks; i++) {
+        __m256i chars = _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i*) (data + i * 8)));
+        acc = _mm256_add_epi32(_mm256_mullo_epi32(acc, step), chars);
+    }
+
+    return hash_reduce_avx2(acc);
+}
+
+AVX2 static uint32_t hash_u16_avx2(const uint16_t *data, size_t blocks, uint32_t hash)
+{
+    __m256i step = _mm256_set1_epi32(HASH_STEP);
+    __m256i acc = _mm256_setr_epi32(0, 0, 0, 0, 0, 0, 0, hash);
+
+    for (size_t i = 0; i < blocks; i++) {
+        __m256i chars = _mm256_cvtepu16_epi32(_mm_loadu_si128((const __m128i*) (data + i * 8)));
+        acc = _mm256_add_epi32(_mm256_mullo_epi32(acc, step), chars);
+    }
+
+    return hash_reduce_avx2(acc);
+}
+#endif
+
+size_t simd_ascii_prefix(const uint8_t *data, size_t length)
+{
+    size_t i = 0;
+#ifdef SIMD_X86
+    i = has_avx2() ? ascii_prefix_avx2(data, length) : ascii_prefix_sse2(data, length);
+#endif
+    while (i < length && data[i] < 0x80)
+        i++;
+
+    return i;
+}
+
+size_t simd_mismatch(const void *a, const void *b, size_t length)
+{
+    const uint8_t *pa = a, *pb = b;
+    size_t i = 0;
+#ifdef SIMD_X86
+    i = has_avx2() ? mismatch_avx2(pa, pb, length) : mismatch_sse2(pa, pb, length);
+#endif
+    while (i < length && pa[i] == pb[i])
+        i++;
+
+    return i;
+}
+
+size_t simd_index_of_u8(const uint8_t *data, size_t length, uint8_t value)
+{
+    size_t i = 0;
+#ifdef SIMD_X86
+    i = has_avx2() ? index_of_u8_avx2(data, length, value) : index_of_u8_sse2(data, length, value);
+#endif
+    while (i < length && data[i] != value)
+        i++;
+
+    return i;
+}
+
+size_t simd_index_of_u16(const uint16_t *data, size_t length, uint16_t value)
+{
+    size_t i = 0;
+#ifdef SIMD_X86
+    i = has_avx2() ? index_of_u16_avx2(data, length, value) : index_of_u16_sse2(data, length, value);
+#endif
+    while (i < length && data[i] != value)
+        i++;
+
+    return i;
+}
+
+/* Runs of plain bytes are skipped a block at a time, only the multi-byte
+ * sequences in between are decoded one by one
+ */
+bool simd_modified_utf8_valid(const uint8_t *data, size_t length)
+{
+    size_t i = 0;
+    while (i < length) {
+#ifdef SIMD_X86
+        i += has_avx2() ? utf8_plain_prefix_avx2(data + i, length - i) : utf8_plain_prefix_sse2(data + i, length - i);
+#endif
+        while (i < length && data[i] - 1u < 0x7F)
+            i++;
+
+        if (i == length)
+            break;
+
+        uint8_t c = data[i];
+        size_t size = (c & 0xE0) == 0xC0 ? 2 : (c & 0xF0) == 0xE0 ? 3 : 0;
+        /* NUL, stray continuation bytes and four byte sequences */
+        if (!size || size > length - i)
+            return false;
+
+        for (size_t j = 1; j < size; j++) {
+            if ((data[i + j] & 0xC0) != 0x80)
+                return false;
+        }
+
+        i += size;
+    }
+
+    return true;
+}
+
+bool simd_utf16_is_latin1(const uint16_t *data, size_t length)
+{
+    size_t i = 0;
+#ifdef SIMD_X86
+    if (!utf16_is_latin1_sse2(data, length, &i))
+        return false;
+#endif
+    for (; i < length; i++) {
+        if (data[i] > 0xFF)
+            return false;
+    }
+
+    return true;
+}
+
+/* SSE2 has no 32-bit multiply, so without AVX2 the hash stays scalar */
+int32_t simd_hash_u8(const uint8_t *data, size_t length, int32_t hash)
+{
+    uint32_t h = hash;
+    size_t i = 0;
+#ifdef SIMD_X86
+    if (length >= 16 && has_avx2()) {
+        h = hash_u8_avx2(data, length / 8, h);
+        i = length & ~(size_t) 7;
+    }
+#endif
+    for (; i < length; i++)
+        h = 31 * h + data[i];
+
+    return h;
+}
+
+int32_t simd_hash_u16(const uint16_t *data, size_t length, int32_t hash)
+{
+    uint32_t h = hash;
+    size_t i = 0;
+#ifdef SIMD_X86
+    if (length >= 16 && has_avx2()) {
+        h = hash_u16_avx2(data, length / 8, h);
+        i = length & ~(size_t) 7;
+    }
+#endif
+    for (; i < length; i++)
+        h = 31 * h + data[i];
+
+    return h;
+}
@@ -0,0 +1,52 @@
+/*
+ * This file is part of MiniJVM (https://github.com/muhammad23012009/minijvm)
+ * Copyright (c) 2025 Muhammad  <thevancedgamer@mentallysanemainliners.org>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SIMD_H
+#define SIMD_H
+
+/* Vectorized scanning and comparison kernels. On x86-64 these use SSE2,
+ * which is always available, and switch to AVX2 at runtime when the CPU
+ * supports it. Other architectures get the plain C loops.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Number of leading bytes below 0x80 */
+extern size_t simd_ascii_prefix(const uint8_t *data, size_t length);
+
+/* Index of the first differing byte, or `length` if both are equal */
+extern size_t simd_mismatch(const void *a, const void *b, size_t length);
+
+/* Index of the first occurrence of `value`, or `length` if there is none */
+extern size_t simd_index_of_u8(const uint8_t *data, size_t length, uint8_t value);
+extern size_t simd_index_of_u16(const uint16_t *data, size_t length, uint16_t value);
+
+/* Whether the bytes are the modified UTF-8 of class files: no NUL bytes
+ * (U+0000 is C0 80), and only one, two and three byte sequences
+ */
+extern bool simd_modified_utf8_valid(const uint8_t *data, size_t length);
+
+/* Whether every UTF-16 code unit fits in a single Latin-1 byte */
+extern bool simd_utf16_is_latin1(const uint16_t *data, size_t length);
+
+/* Continues a java/lang/String style hash (h = 31 * h + c) over the chars */
+extern int32_t simd_hash_u8(const uint8_t *data, size_t length, int32_t hash);
+extern int32_t simd_hash_u16(const uint16_t *data, size_t length, int32_t hash);
+
+#endif
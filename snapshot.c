@@ -0,0 +1,855 @@
+/*
+ * This file is part of MiniJVM (https://github.com/muhammad23012009/minijvm)
+ * Copyright (c) 2025 Muhammad  <thevancedgamer@mentallysanemainliners.org>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "snapshot.h"
+#include "array.h"
+#include "hashtable.h"
+#include "builtins/builtins.h"
+
+#define SNAPSHOT_MAGIC      0x4D4A434B  /* "MJCK" */
+#define SNAPSHOT_VERSION    3
+
+/* Every number is big endian, like in class files, so the snapshot is read
+ * with the same Reader. Objects and arrays are numbered from 1 in the order
+ * they are found, 0 is null.
+ *
+ *     header     magic, version, class path stamp, main class name
+ *     classes    names of the loaded classes, in load order, each followed
+ *                by its classpath_class_stamp
+ *     shells     one record per object or array, enough to allocate it
+ *     contents   the fields and elements of each, in the same order
+ *     roots      static fields of the initialized classes, interned strings,
+ *                constant pool caches
+ */
+typedef enum RecordKind {
+    RECORD_OBJECT,
+    RECORD_ARRAY,
+    /* One of the shared boxes of integer_value_of, only the value is kept */
+    RECORD_CACHED_INTEGER,
+} RecordKind;
+
+/* Built-in classes whose only field holds native state */
+typedef enum Payload {
+    PAYLOAD_NONE,
+    PAYLOAD_STRING,
+    PAYLOAD_STRING_BUILDER,
+    PAYLOAD_ARRAY_LIST,
+    PAYLOAD_HASH_MAP,
+} Payload;
+
+typedef struct Buffer {
+    uint8_t *data;
+    size_t size;
+    size_t capacity;
+} Buffer;
+
+typedef struct HeapSlot {
+    const void *pointer;
+    uint32_t id;
+} HeapSlot;
+
+typedef struct HeapItem {
+    const void *pointer;
+    bool array;
+} HeapItem;
+
+typedef struct Writer {
+    Buffer shells;
+    Buffer contents;
+    Buffer roots;
+
+    /* Everything found so far, in id order */
+    uint32_t count;
+    uint32_t capacity;
+    HeapItem *items;
+
+    /* Map from pointer to id, holding HeapSlot */
+    HashTable slots;
+} Writer;
+
+static Payload class_payload(Class *class)
+{
+    static const struct {
+        const char *name;
+        Payload payload;
+    } payloads[] = {
+        { "java/lang/String", PAYLOAD_STRING },
+        { "java/lang/StringBuilder", PAYLOAD_STRING_BUILDER },
+        { "java/util/ArrayList", PAYLOAD_ARRAY_LIST },
+        { "java/util/HashMap", PAYLOAD_HASH_MAP },
+    };
+
+    if (!class->built_in)
+        return PAYLOAD_NONE;
+
+    for (size_t i = 0; i < ARRAY_SIZE(payloads); i++) {
+        if (!strcmp(class->name, payloads[i].name))
+            return payloads[i].payload;
+    }
+
+    return PAYLOAD_NONE;
+}
+
+static void buffer_put(Buffer *buffer, const void *data, size_t size)
+{
+    /* An empty source, like a program without interned strings, may be NULL */
+    if (!size)
+        return;
+
+    if (buffer->size + size > buffer->capacity) {
+        buffer->capacity = buffer->capacity ? buffer->capacity : 4096;
+        while (buffer->size + size > buffer->capacity)
+            buffer->capacity *= 2;
+        buffer->data = realloc(buffer->data, buffer->capacity);
+    }
+
+    memcpy(buffer->data + buffer->size, data, size);
+    buffer->size += size;
+}
+
+static void buffer_u8(Buffer *buffer, uint8_t value)
+{
+    buffer_put(buffer, &value, 1);
+}
+
+static void buffer_u16(Buffer *buffer, uint16_t value)
+{
+    value = htobe16(value);
+    buffer_put(buffer, &value, 2);
+}
+
+static void buffer_u32(Buffer *buffer, uint32_t value)
+{
+    value = htobe32(value);
+    buffer_put(buffer, &value, 4);
+}
+
+static void buffer_name(Buffer *buffer, const char *name)
+{
+    size_t length = strlen(name);
+    buffer_u16(buffer, length);
+    buffer_put(buffer, name, length);
+}
+
+static uint32_t writer_hash(const void *pointer)
+{
+    uintptr_t address = (uintptr_t) pointer;
+    return (uint32_t) ((address >> 4) ^ (address >> 32)) * 0x9E3779B9u;
+}
+
+static bool heap_slot_match(const void *entry, const void *key)
+{
+    return ((const HeapSlot*) entry)->pointer == key;
+}
+
+static uint32_t heap_slot_hash(const void *entry)
+{
+    return writer_hash(((const HeapSlot*) entry)->pointer);
+}
+
+/* Returns the id of an object or array, numbering it if it is new */
+static uint32_t writer_ref(Writer *writer, const void *pointer, bool array)
+{
+    if (!pointer)
+        return 0;
+
+    hash_table_reserve(&writer->slots, sizeof(HeapSlot), 1024, heap_slot_hash);
+
+    HeapSlot *slot = hash_table_probe(&writer->slots, sizeof(HeapSlot), writer_hash(pointer), heap_slot_match, pointer);
+    if (slot->pointer)
+        return slot->id;
+
+    if (writer->count == writer->capacity) {
+        writer->capacity = writer->capacity ? writer->capacity * 2 : 256;
+        writer->items = realloc(writer->items, sizeof(HeapItem) * writer->capacity);
+    }
+
+    writer->items[writer->count++] = (HeapItem) { pointer, array };
+    slot->pointer = pointer;
+    slot->id = writer->count;
+    writer->slots.count++;
+    return slot->id;
+}
+
+static void writer_variant(Writer *writer, Buffer *buffer, Variant value)
+{
+    buffer_u8(buffer, value.type);
+
+    switch (value.type) {
+        case VARIANT_TYPE_OBJECT:
+            buffer_u32(buffer, writer_ref(writer, value.data.object, false));
+            break;
+        /* Outside of built-in objects, the only references are arrays */
+        case VARIANT_TYPE_REF:
+            buffer_u32(buffer, writer_ref(writer, value.data.ref, true));
+            break;
+        case VARIANT_TYPE_INT:
+            buffer_u32(buffer, value.data.int_val);
+            break;
+        case VARIANT_TYPE_LONG:
+            buffer_u32(buffer, (uint64_t) value.data.long_val >> 32);
+            buffer_u32(buffer, value.data.long_val);
+            break;
+        default:
+            break;
+    }
+}
+
+/* Only the first `length` chars, the rest of a builder's buffer is unused */
+static void writer_string_data(Buffer *buffer, StringData *data, int32_t length)
+{
+    buffer_u32(buffer, length);
+    buffer_u8(buffer, data->coder);
+    buffer_put(buffer, data->value, (size_t) length << data->coder);
+}
+
+static void writer_payload(Writer *writer, Payload payload, void *ref)
+{
+    Buffer *buffer = &writer->contents;
+
+    switch (payload) {
+        case PAYLOAD_STRING: {
+            StringData *data = ref;
+            writer_string_data(buffer, data, data->length);
+            break;
+        }
+        case PAYLOAD_STRING_BUILDER: {
+            StringBuilderData *builder = ref;
+            buffer_u32(buffer, builder->capacity);
+            writer_string_data(buffer, builder->data, builder->length);
+            break;
+        }
+        case PAYLOAD_ARRAY_LIST: {
+            ArrayListData *list = ref;
+            buffer_u32(buffer, list->size);
+            buffer_u32(buffer, writer_ref(writer, list->elements, true));
+            break;
+        }
+        /* Only the entries are kept. Keys hashed by identity get new
+         * addresses, so the table is rebuilt on restore, see restore_maps.
+         */
+        case PAYLOAD_HASH_MAP: {
+            HashMapData *map = ref;
+            buffer_u32(buffer, map->count);
+            buffer_u32(buffer, map->capacity);
+            for (uint32_t i = 0; i < map->capacity; i++) {
+                HashMapEntry *entry = &map->entries[i];
+                if (!entry->distance)
+                    continue;
+
+                buffer_u32(buffer, writer_ref(writer, entry->key, false));
+                writer_variant(writer, buffer, entry->value);
+            }
+            break;
+        }
+        default:
+            break;
+    }
+}
+
+static void writer_record(Writer *writer, HeapItem *item)
+{
+    if (item->array) {
+        const Array *array = item->pointer;
+        buffer_u8(&writer->shells, RECORD_ARRAY);
+        buffer_name(&writer->shells, array->parent_class->name);
+        buffer_u32(&writer->shells, array->count);
+
+        for (int i = 0; i < array->count; i++)
+            writer_variant(writer, &writer->contents, array->value[i]);
+        return;
+    }
+
+    Object *object = (Object*) item->pointer;
+    if (integer_is_cached(object)) {
+        buffer_u8(&writer->shells, RECORD_CACHED_INTEGER);
+        buffer_u32(&writer->shells, object->fields[0]->value.data.int_val);
+        return;
+    }
+
+    buffer_u8(&writer->shells, RECORD_OBJECT);
+    buffer_name(&writer->shells, object->class->name);
+    buffer_u8(&writer->shells, object->initialized);
+    buffer_u8(&writer->shells, object->pinned);
+    buffer_u16(&writer->shells, object->fields_count);
+
+    Payload payload = class_payload(object->class);
+    for (int i = 0; i < object->fields_count; i++) {
+        Variant value = object->fields[i]->value;
+        if (payload && value.type == VARIANT_TYPE_REF) {
+            buffer_u8(&writer->contents, VARIANT_TYPE_REF);
+            writer_payload(writer, payload, value.data.ref);
+        } else {
+            writer_variant(writer, &writer->contents, value);
+        }
+    }
+}
+
+/* Ids are written to a buffer of their own, the count goes first */
+typedef struct InternedStrings {
+    Writer *writer;
+    Buffer ids;
+    uint32_t count;
+} InternedStrings;
+
+static void writer_interned(Object *string, void *context)
+{
+    InternedStrings *interned = context;
+    buffer_u32(&interned->ids, writer_ref(interned->writer, string, false));
+    interned->count++;
+}
+
+static void writer_roots(Writer *writer, Classes *classes)
+{
+    Buffer *buffer = &writer->roots;
+
+    /* Classes that were never initialized have nothing to keep, their
+     * <clinit> simply runs after the restore.
+     */
+    uint32_t count = 0;
+    for (uint32_t i = 0; i < classes->count; i++)
+        count += classes->classes[i]->static_initialized;
+
+    buffer_u32(buffer, count);
+    for (uint32_t i = 0; i < classes->count; i++) {
+        Class *class = classes->classes[i];
+        if (!class->static_initialized)
+            continue;
+
+        buffer_name(buffer, class->name);
+        buffer_u16(buffer, class->static_field_count);
+        for (int j = 0; j < class->static_field_count; j++)
+            writer_variant(writer, buffer, class->static_fields[j].value);
+    }
+
+    InternedStrings interned = { .writer = writer };
+    string_intern_visit(writer_interned, &interned);
+    buffer_u32(buffer, interned.count);
+    buffer_put(buffer, interned.ids.data, interned.ids.size);
+    free(interned.ids.data);
+
+    /* Resolved class and string constants. Their count isn't known until
+     * the pool was walked, so it is patched in afterwards.
+     */
+    count = 0;
+    for (uint32_t i = 0; i < classes->count; i++)
+        count += classes->classes[i]->pool != NULL;
+
+    buffer_u32(buffer, count);
+    for (uint32_t i = 0; i < classes->count; i++) {
+        ConstantPool *pool = classes->classes[i]->pool;
+        if (!pool)
+            continue;
+
+        buffer_name(buffer, classes->classes[i]->name);
+        size_t at = buffer->size;
+        uint16_t resolved = 0;
+        buffer_u16(buffer, 0);
+
+        for (int j = 1; j < pool->count; j++) {
+            if (!pool->resolved[j])
+                continue;
+
+            if (pool->tags[j] == CONSTANT_CLASS) {
+                buffer_u16(buffer, j);
+                buffer_u8(buffer, CONSTANT_CLASS);
+                resolved++;
+            } else if (pool->tags[j] == CONSTANT_STRING) {
+                buffer_u16(buffer, j);
+                buffer_u8(buffer, CONSTANT_STRING);
+                buffer_u32(buffer, writer_ref(writer, pool->resolved[j], false));
+                resolved++;
+            }
+        }
+
+        uint16_t big_endian = htobe16(resolved);
+        memcpy(buffer->data + at, &big_endian, 2);
+    }
+}
+
+static bool snapshot_write_file(const char *path, Buffer *buffers, int count)
+{
+    int fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0)
+        return false;
+
+    bool written = true;
+    for (int i = 0; i < count && written; i++) {
+        size_t done = 0;
+        while (done < buffers[i].size) {
+            ssize_t result = write(fd, buffers[i].data + done, buffers[i].size - done);
+            if (result <= 0)
+                break;
+            done += result;
+        }
+
+        written = done == buffers[i].size;
+    }
+
+    return !close(fd) && written;
+}
+
+bool snapshot_write(Classes *classes, const char *path)
+{
+    Writer writer;
+    memset(&writer, 0, sizeof(writer));
+
+    Buffer header;
+    memset(&header, 0, sizeof(header));
+    buffer_u32(&header, SNAPSHOT_MAGIC);
+    buffer_u32(&header, SNAPSHOT_VERSION);
+    buffer_u32(&header, classpath_stamp());
+    buffer_name(&header, classes->main_class->name);
+
+    /* Built-ins are always there, only the rest has to be loaded again */
+    uint32_t loaded = 0;
+    for (uint32_t i = 0; i < classes->count; i++)
+        loaded += !classes->classes[i]->built_in;
+
+    buffer_u32(&header, loaded);
+    for (uint32_t i = 0; i < classes->count; i++) {
+        Class *class = classes->classes[i];
+        if (class->built_in)
+            continue;
+
+        /* A class whose file is gone by now is stamped 0 and never matches */
+        uint32_t stamp;
+        if (!classpath_class_stamp(class->name, &stamp))
+            stamp = 0;
+
+        buffer_name(&header, class->name);
+        buffer_u32(&header, stamp);
+    }
+
+    /* Numbers the roots first, then records everything they reach. The
+     * list grows while it is walked.
+     */
+    writer_roots(&writer, classes);
+    for (uint32_t i = 0; i < writer.count; i++)
+        writer_record(&writer, &writer.items[i]);
+
+    buffer_u32(&header, writer.count);
+
+    Buffer buffers[] = { header, writer.shells, writer.contents, writer.roots };
+    bool written = snapshot_write_file(path, buffers, ARRAY_SIZE(buffers));
+    if (written)
+        printf("miniJVM: wrote %u classes and %u objects to snapshot %s\n", loaded, writer.count, path);
+    else
+        fprintf(stderr, "miniJVM: failed to write snapshot %s\n", path);
+
+    for (size_t i = 0; i < ARRAY_SIZE(buffers); i++)
+        free(buffers[i].data);
+    free(writer.items);
+    hash_table_free(&writer.slots);
+    return written;
+}
+
+/* Restoring */
+
+typedef struct Restorer {
+    Classes *classes;
+    Reader *reader;
+    uint32_t count;
+    /* Indexed by id, so entry 0 is null */
+    void **heap;
+    uint8_t *kinds;
+} Restorer;
+
+static void restore_fail(const char *what)
+{
+    fprintf(stderr, "miniJVM: damaged snapshot, %s\n", what);
+    exit(1);
+}
+
+static void restore_check(Restorer *restorer)
+{
+    if (restorer->reader->overflow)
+        restore_fail("it ends early");
+}
+
+/* For variable sized reads, which are checked before they are made */
+static void restore_need(Restorer *restorer, size_t size)
+{
+    restore_check(restorer);
+    if (size > (size_t) reader_remaining(restorer->reader))
+        restore_fail("it ends early");
+}
+
+/* Names in the file aren't terminated, so they are copied into `buffer` */
+static char *restore_name(Restorer *restorer, char *buffer)
+{
+    uint16_t length = reader_read_uint16_be(restorer->reader);
+    restore_need(restorer, length);
+    reader_read_bytes(restorer->reader, buffer, length);
+    buffer[length] = '\0';
+    return buffer;
+}
+
+static Class *restore_class(Restorer *restorer)
+{
+    char name[UINT16_MAX + 1];
+    restore_name(restorer, name);
+
+    Symbol *symbol = symbol_new(name);
+    Class *class = classes_load_class(restorer->classes, symbol);
+    if (!class)
+        restore_fail("it names a class that can't be loaded");
+
+    return class;
+}
+
+/* Reads ahead through the list of classes without loading any of them */
+static bool restore_classes_unchanged(Restorer *restorer)
+{
+    char name[UINT16_MAX + 1];
+    int offset = restorer->reader->offset;
+    uint32_t loaded = reader_read_uint32_be(restorer->reader);
+
+    bool unchanged = true;
+    for (uint32_t i = 0; i < loaded && unchanged; i++) {
+        restore_name(restorer, name);
+
+        uint32_t stamp;
+        unchanged = classpath_class_stamp(name, &stamp) && stamp == reader_read_uint32_be(restorer->reader);
+    }
+
+    restorer->reader->offset = offset;
+    return unchanged;
+}
+
+static void *restore_ref(Restorer *restorer)
+{
+    uint32_t id = reader_read_uint32_be(restorer->reader);
+    if (id > restorer->count)
+        restore_fail("an object id is out of range");
+
+    return restorer->heap[id];
+}
+
+static Variant restore_value(Restorer *restorer, VariantType type)
+{
+    Variant value;
+    memset(&value, 0, sizeof(value));
+    value.type = type;
+
+    switch (value.type) {
+        case VARIANT_TYPE_OBJECT:
+            value.data.object = restore_ref(restorer);
+            break;
+        case VARIANT_TYPE_REF:
+            value.data.ref = restore_ref(restorer);
+            break;
+        case VARIANT_TYPE_INT:
+            value.data.int_val = reader_read_uint32_be(restorer->reader);
+            break;
+        case VARIANT_TYPE_LONG: {
+            uint64_t high = reader_read_uint32_be(restorer->reader);
+            value.data.long_val = high << 32 | reader_read_uint32_be(restorer->reader);
+            break;
+        }
+        case VARIANT_TYPE_NONE:
+            break;
+        default:
+            restore_fail("a value has an unknown type");
+    }
+
+    return value;
+}
+
+static Variant restore_variant(Restorer *restorer)
+{
+    return restore_value(restorer, reader_read_uint8(restorer->reader));
+}
+
+/* Reads the chars into a string with room for `capacity`, or just for
+ * the chars if that is negative
+ */
+static StringData *restore_string_data(Restorer *restorer, int32_t capacity, int32_t *length)
+{
+    *length = reader_read_uint32_be(restorer->reader);
+    uint8_t coder = reader_read_uint8(restorer->reader);
+    if (*length < 0 || coder > STRING_UTF16 || (capacity >= 0 && capacity < *length))
+        restore_fail("a string is malformed");
+
+    restore_need(restorer, (size_t) *length << coder);
+    StringData *data = string_data_new(capacity >= 0 ? capacity : *length, coder);
+    reader_read_bytes(restorer->reader, (char*) data->value, (size_t) *length << coder);
+    return data;
+}
+
+static void *restore_payload(Restorer *restorer, Payload payload, Object *object)
+{
+    switch (payload) {
+        case PAYLOAD_STRING: {
+            int32_t length;
+            return restore_string_data(restorer, -1, &length);
+        }
+        /* Whatever String the builder's chars were shared with has its own copy */
+        case PAYLOAD_STRING_BUILDER: {
+            StringBuilderData *builder = malloc(sizeof(StringBuilderData));
+            builder->capacity = reader_read_uint32_be(restorer->reader);
+            builder->data = restore_string_data(restorer, builder->capacity, &builder->length);
+            builder->shared = false;
+            return builder;
+        }
+        case PAYLOAD_ARRAY_LIST: {
+            ArrayListData *list = malloc(sizeof(ArrayListData));
+            list->size = reader_read_uint32_be(restorer->reader);
+            list->elements = restore_ref(restorer);
+            return list;
+        }
+        case PAYLOAD_HASH_MAP: {
+            HashMapData *map = malloc(sizeof(HashMapData));
+            map->count = reader_read_uint32_be(restorer->reader);
+            map->capacity = reader_read_uint32_be(restorer->reader);
+            if (!map->capacity || (map->capacity & (map->capacity - 1)) || map->count > map->capacity ||
+                map->capacity > (uint32_t) restorer->reader->size)
+                restore_fail("a map is malformed");
+
+            map->shift = 32 - __builtin_ctz(map->capacity);
+            map->entries = calloc(map->capacity, sizeof(HashMapEntry));
+            map->string_class = classes_get_class(object->class->classes, "java/lang/String");
+            map->integer_class = classes_get_class(object->class->classes, "java/lang/Integer");
+
+            /* Only marked as used, the keys are hashed once everything is restored */
+            for (uint32_t i = 0; i < map->count; i++) {
+                HashMapEntry *entry = &map->entries[i];
+                entry->distance = 1;
+                entry->key = restore_ref(restorer);
+                entry->value = restore_variant(restorer);
+            }
+            return map;
+        }
+        default:
+            return NULL;
+    }
+}
+
+/* Allocates every object and array, without their contents */
+static void restore_shells(Restorer *restorer)
+{
+    for (uint32_t id = 1; id <= restorer->count; id++) {
+        switch (reader_read_uint8(restorer->reader)) {
+            case RECORD_OBJECT: {
+                restorer->kinds[id] = RECORD_OBJECT;
+                Class *class = restore_class(restorer);
+                Object *object = object_new(class);
+                object->initialized = reader_read_uint8(restorer->reader);
+                object->pinned = reader_read_uint8(restorer->reader);
+                if (reader_read_uint16_be(restorer->reader) != object->fields_count)
+                    restore_fail("an object's fields don't match its class");
+
+                restorer->heap[id] = object;
+                break;
+            }
+            case RECORD_ARRAY: {
+                restorer->kinds[id] = RECORD_ARRAY;
+                Class *class = restore_class(restorer);
+                int32_t count = reader_read_uint32_be(restorer->reader);
+                if (count < 0 || count > restorer->reader->size)
+                    restore_fail("an array is malformed");
+
+                restorer->heap[id] = array_new(class, count);
+                break;
+            }
+            case RECORD_CACHED_INTEGER: {
+                restorer->kinds[id] = RECORD_CACHED_INTEGER;
+                Class *integer_class = classes_get_class(restorer->classes, "java/lang/Integer");
+                restorer->heap[id] = integer_value_of(integer_class, reader_read_uint32_be(restorer->reader));
+                break;
+            }
+            default:
+                restore_fail("a record has an unknown kind");
+        }
+
+        restore_check(restorer);
+    }
+}
+
+/* Same order as the shells, cached integers have no contents */
+static void restore_contents(Restorer *restorer)
+{
+    for (uint32_t id = 1; id <= restorer->count; id++) {
+        if (restorer->kinds[id] == RECORD_ARRAY) {
+            Array *array = restorer->heap[id];
+            for (int i = 0; i < array->count; i++)
+                array->value[i] = restore_variant(restorer);
+        } else if (restorer->kinds[id] == RECORD_OBJECT) {
+            Object *object = restorer->heap[id];
+            Payload payload = class_payload(object->class);
+
+            for (int i = 0; i < object->fields_count; i++) {
+                Variant *value = &object->fields[i]->value;
+                VariantType type = reader_read_uint8(restorer->reader);
+                if (payload && type == VARIANT_TYPE_REF) {
+                    value->type = VARIANT_TYPE_REF;
+                    value->data.ref = restore_payload(restorer, payload, object);
+                } else {
+                    *value = restore_value(restorer, type);
+                }
+            }
+        }
+
+        restore_check(restorer);
+    }
+}
+
+/* hashCode() may read other objects, strings or static fields, so maps
+ * are only filled in once all of them are back
+ */
+static void restore_maps(Restorer *restorer)
+{
+    for (uint32_t id = 1; id <= restorer->count; id++) {
+        if (restorer->kinds[id] != RECORD_OBJECT)
+            continue;
+
+        Object *object = restorer->heap[id];
+        if (class_payload(object->class) != PAYLOAD_HASH_MAP)
+            continue;
+
+        /* Unset if the map was never constructed */
+        Variant *value = &object->fields[0]->value;
+        if (value->type == VARIANT_TYPE_REF && value->data.ref)
+            hashmap_rehash(value->data.ref);
+    }
+}
+
+static void restore_roots(Restorer *restorer)
+{
+    uint32_t count = reader_read_uint32_be(restorer->reader);
+    for (uint32_t i = 0; i < count; i++) {
+        Class *class = restore_class(restorer);
+        if (reader_read_uint16_be(restorer->reader) != class->static_field_count)
+            restore_fail("a class's static fields don't match it");
+
+        for (int j = 0; j < class->static_field_count; j++)
+            class->static_fields[j].value = restore_variant(restorer);
+
+        class->static_initialized = true;
+        restore_check(restorer);
+    }
+
+    /* Nothing was interned before the restore, so these are the canonical strings */
+    count = reader_read_uint32_be(restorer->reader);
+    for (uint32_t i = 0; i < count; i++) {
+        Object *string = restore_ref(restorer);
+        if (!string || string_intern(string) != string)
+            restore_fail("an interned string is missing or twice");
+    }
+    restore_check(restorer);
+
+    count = reader_read_uint32_be(restorer->reader);
+    for (uint32_t i = 0; i < count; i++) {
+        Class *class = restore_class(restorer);
+        uint16_t resolved = reader_read_uint16_be(restorer->reader);
+
+        for (int j = 0; j < resolved; j++) {
+            uint16_t index = reader_read_uint16_be(restorer->reader);
+            uint8_t tag = reader_read_uint8(restorer->reader);
+            if (!class->pool || index >= class->pool->count || class->pool->tags[index] != tag)
+                restore_fail("a constant pool entry doesn't match its class");
+
+            if (tag == CONSTANT_STRING)
+                class->pool->resolved[index] = restore_ref(restorer);
+            else
+                classes_get_class_from_index(restorer->classes, class->pool, index);
+        }
+
+        restore_check(restorer);
+    }
+}
+
+bool snapshot_restore(Classes *classes, const char *path, const char *main_class)
+{
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        fprintf(stderr, "miniJVM: cannot open snapshot %s\n", path);
+        return false;
+    }
+
+    struct stat filestat;
+    void *data = MAP_FAILED;
+    if (!fstat(fd, &filestat) && filestat.st_size > 0 && filestat.st_size <= INT32_MAX)
+        data = mmap(NULL, filestat.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+
+    if (data == MAP_FAILED) {
+        fprintf(stderr, "miniJVM: cannot map snapshot %s\n", path);
+        return false;
+    }
+
+    Restorer restorer;
+    memset(&restorer, 0, sizeof(restorer));
+    restorer.classes = classes;
+    restorer.reader = reader_new(data, filestat.st_size);
+
+    /* Nothing has been changed up to here, so a mismatch can still fall back */
+    char name[UINT16_MAX + 1];
+    const char *error = NULL;
+    if (filestat.st_size < 14 || reader_read_uint32_be(restorer.reader) != SNAPSHOT_MAGIC)
+        error = "not a snapshot";
+    else if (reader_read_uint32_be(restorer.reader) != SNAPSHOT_VERSION)
+        error = "written by a different build";
+    else if (reader_read_uint32_be(restorer.reader) != classpath_stamp())
+        error = "the class path changed since it was written";
+    else if (strcmp(restore_name(&restorer, name), main_class))
+        error = "it was written for another main class";
+    else if (!restore_classes_unchanged(&restorer))
+        error = "a class file changed since it was written";
+
+    if (error) {
+        fprintf(stderr, "miniJVM: ignoring snapshot %s: %s\n", path, error);
+        free(restorer.reader);
+        munmap(data, filestat.st_size);
+        return false;
+    }
+
+    uint32_t loaded = reader_read_uint32_be(restorer.reader);
+    for (uint32_t i = 0; i < loaded; i++) {
+        restore_class(&restorer);
+        /* The stamp, compared already */
+        reader_read_uint32_be(restorer.reader);
+    }
+
+    restorer.count = reader_read_uint32_be(restorer.reader);
+    restore_check(&restorer);
+    if (restorer.count > (uint32_t) filestat.st_size)
+        restore_fail("it has more objects than bytes");
+
+    restorer.heap = calloc(restorer.count + 1, sizeof(void*));
+    restorer.kinds = calloc(restorer.count + 1, sizeof(uint8_t));
+    restore_shells(&restorer);
+    restore_contents(&restorer);
+    restore_roots(&restorer);
+    restore_maps(&restorer);
+
+    printf("miniJVM: restored %u classes and %u objects from snapshot %s\n", loaded, restorer.count, path);
+
+    free(restorer.heap);
+    free(restorer.kinds);
+    free(restorer.reader);
+    munmap(data, filestat.st_size);
+    return true;
+}
\ No newline at end of file
@@ -0,0 +1,48 @@
+/*
+ * This file is part of MiniJVM (https://github.com/muhammad23012009/minijvm)
+ * Copyright (c) 2025 Muhammad  <thevancedgamer@mentallysanemainliners.org>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+/* Checkpoint and restore of a warmed up VM. A checkpoint run initializes
+ * the main class and optionally runs a warm-up method, then writes out
+ * which classes are loaded and initialized, their static fields, every
+ * object reachable from those, the interned strings and the resolved
+ * constant pool entries. A restore run maps the snapshot, rebuilds that
+ * state and goes straight to main without running any static initializer
+ * again.
+ *
+ * Classes are recorded by name and loaded the usual way on restore, so a
+ * shared archive (see cds.h) makes that a lookup too. Objects are rebuilt
+ * on the heap rather than used from the mapping, since the built-in
+ * collections grow and free their storage in place. Linked invokedynamic
+ * call sites are not recorded, they are linked again on first use.
+ */
+
+#include <stdbool.h>
+#include "method.h"
+
+/* `classes->main_class` has to be set, see classes_get_main_method */
+extern bool snapshot_write(Classes *classes, const char *path);
+
+/* Returns false, with nothing changed, if the snapshot doesn't match this
+ * build, class path or main class, or one of its classes' files changed
+ * since. A snapshot that is damaged past that point ends the VM.
+ */
+extern bool snapshot_restore(Classes *classes, const char *path, const char *main_class);
+
+#endif
\ No newline at end of file
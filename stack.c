@@ -40,6 +40,14 @@ void stack_push_int(Stack *stack, int value)
     stack_push(stack, variant);
 }
 
+void stack_push_long(Stack *stack, int64_t value)
+{
+    Variant variant;
+    variant.type = VARIANT_TYPE_LONG;
+    variant.data.long_val = value;
+    stack_push(stack, variant);
+}
+
 void stack_push_ref(Stack *stack, void *value)
 {
     Variant variant;
@@ -76,6 +84,16 @@ Variant stack_pop(Stack *stack)
     return value;
 }
 
+/* Returns the item `depth` places below the top without removing it */
+Variant stack_peek(Stack *stack, int depth)
+{
+    StackItem *item = stack->head;
+    while (depth--)
+        item = item->next;
+
+    return item->item;
+}
+
 Stack *stack_new(int max_size)
 {
     Stack *stack = malloc(sizeof(Stack));
@@ -91,7 +109,8 @@ void stack_free(Stack *stack)
     for (StackItem *item = stack->head; item != NULL;) {
         StackItem *next = item->next;
 
-        if (item->item.type == VARIANT_TYPE_OBJECT)
+        if (item->item.type == VARIANT_TYPE_OBJECT && item->item.data.object &&
+            !item->item.data.object->pinned)
             object_free(item->item.data.object);
 
         free(item);
@@ -37,11 +37,13 @@ typedef struct Stack {
 extern void stack_push(Stack *stack, Variant value);
 
 extern void stack_push_int(Stack *stack, int value);
+extern void stack_push_long(Stack *stack, int64_t value);
 extern void stack_push_ref(Stack *stack, void *value);
 extern void stack_push_object(Stack *stack, Object *value);
 
 extern void stack_dup(Stack *stack);
 extern Variant stack_pop(Stack *stack);
+extern Variant stack_peek(Stack *stack, int depth);
 
 extern Stack *stack_new(int max_size);
 extern void stack_free(Stack *stack);
@@ -0,0 +1,153 @@
+/*
+ * This file is part of MiniJVM (https://github.com/muhammad23012009/minijvm)
+ * Copyright (c) 2025 Muhammad  <thevancedgamer@mentallysanemainliners.org>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+
+#include "symbol.h"
+#include "hash.h"
+#include "hashtable.h"
+
+VMSymbols vm_symbols;
+
+/* Every symbol, by its bytes. The lock is only contended
+ * while the class loader parses on several threads.
+ */
+static HashTable table;
+
+static pthread_mutex_t table_lock = PTHREAD_MUTEX_INITIALIZER;
+
+/* Where the shared symbols are mapped, they are not ours to free */
+static const void *shared_start, *shared_end;
+
+typedef struct SymbolKey {
+    const char *bytes;
+    uint16_t length;
+    uint32_t hash;
+} SymbolKey;
+
+static bool symbol_matches(const void *entry, const void *key)
+{
+    const Symbol *symbol = *(Symbol* const*) entry;
+    const SymbolKey *k = key;
+    return symbol->hash == k->hash && symbol->length == k->length && !memcmp(symbol->bytes, k->bytes, k->length);
+}
+
+static uint32_t symbol_entry_hash(const void *entry)
+{
+    return (*(Symbol* const*) entry)->hash;
+}
+
+static Symbol **symbol_table_find(const char *bytes, uint16_t length, uint32_t hash)
+{
+    SymbolKey key = { bytes, length, hash };
+    return hash_table_probe(&table, sizeof(Symbol*), hash, symbol_matches, &key);
+}
+
+static void symbol_table_reserve(void)
+{
+    hash_table_reserve(&table, sizeof(Symbol*), 1024, symbol_entry_hash);
+}
+
+Symbol *symbol_intern(const char *bytes, uint16_t length)
+{
+    uint32_t hash = hash_bytes(bytes, length);
+
+    pthread_mutex_lock(&table_lock);
+    symbol_table_reserve();
+
+    Symbol **slot = symbol_table_find(bytes, length, hash);
+    Symbol *symbol = *slot;
+    if (!symbol) {
+        symbol = malloc(sizeof(Symbol) + length + 1);
+        symbol->hash = hash;
+        symbol->length = length;
+        memcpy(symbol->bytes, bytes, length);
+        symbol->bytes[length] = '\0';
+
+        table.count++;
+        *slot = symbol;
+    }
+    pthread_mutex_unlock(&table_lock);
+
+    return symbol;
+}
+
+Symbol *symbol_new(const char *string)
+{
+    return symbol_intern(string, strlen(string));
+}
+
+Symbol *symbol_find(const char *string)
+{
+    size_t length = strlen(string);
+    if (length > UINT16_MAX)
+        return NULL;
+
+    SymbolKey key = { string, length, hash_bytes(string, length) };
+
+    pthread_mutex_lock(&table_lock);
+    Symbol **slot = hash_table_find(&table, sizeof(Symbol*), key.hash, symbol_matches, &key);
+    pthread_mutex_unlock(&table_lock);
+
+    return slot ? *slot : NULL;
+}
+
+void symbol_table_share(Symbol **symbols, uint32_t count, const void *start, const void *end)
+{
+    shared_start = start;
+    shared_end = end;
+
+    pthread_mutex_lock(&table_lock);
+    for (uint32_t i = 0; i < count; i++) {
+        symbol_table_reserve();
+
+        Symbol **slot = symbol_table_find(symbols[i]->bytes, symbols[i]->length, symbols[i]->hash);
+        if (!*slot) {
+            *slot = symbols[i];
+            table.count++;
+        }
+    }
+    pthread_mutex_unlock(&table_lock);
+}
+
+void symbol_table_init(void)
+{
+    vm_symbols.empty = symbol_new("");
+    vm_symbols.code = symbol_new("Code");
+    vm_symbols.constant_value = symbol_new("ConstantValue");
+    vm_symbols.inner_classes = symbol_new("InnerClasses");
+    vm_symbols.bootstrap_methods = symbol_new("BootstrapMethods");
+    vm_symbols.clinit = symbol_new("<clinit>");
+    vm_symbols.void_method = symbol_new("()V");
+    vm_symbols.main = symbol_new("main");
+}
+
+void symbol_table_free(void)
+{
+    Symbol **entries = table.entries;
+    for (uint32_t i = 0; entries && i <= table.mask; i++) {
+        const void *symbol = entries[i];
+        if (symbol < shared_start || symbol >= shared_end)
+            free(entries[i]);
+    }
+
+    hash_table_free(&table);
+    memset(&vm_symbols, 0, sizeof(vm_symbols));
+    shared_start = shared_end = NULL;
+}
\ No newline at end of file
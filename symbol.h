@@ -0,0 +1,74 @@
+/*
+ * This file is part of MiniJVM (https://github.com/muhammad23012009/minijvm)
+ * Copyright (c) 2025 Muhammad  <thevancedgamer@mentallysanemainliners.org>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SYMBOL_H
+#define SYMBOL_H
+
+/* A VM-wide table of interned UTF-8 strings. Every name the VM deals with
+ * (class, method and field names, descriptors, attribute names) is a
+ * symbol, and the same string is only ever stored once. Since names stored
+ * on classes, methods and fields always point at symbol bytes, two names are
+ * equal exactly when their pointers are.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+typedef struct Symbol {
+    uint32_t hash;
+    uint16_t length;
+    /* NUL terminated, so the bytes can be used as a C string */
+    char bytes[];
+} Symbol;
+
+/* Names the VM looks up itself, interned once by symbol_table_init */
+typedef struct VMSymbols {
+    Symbol *empty;
+    Symbol *code;
+    Symbol *constant_value;
+    Symbol *inner_classes;
+    Symbol *bootstrap_methods;
+    Symbol *clinit;
+    Symbol *void_method;
+    Symbol *main;
+} VMSymbols;
+
+extern VMSymbols vm_symbols;
+
+extern void symbol_table_init(void);
+extern void symbol_table_free(void);
+
+/* Returns the symbol for the string, creating it if needed */
+extern Symbol *symbol_intern(const char *bytes, uint16_t length);
+extern Symbol *symbol_new(const char *string);
+
+/* Adds symbols that live in a mapped shared archive (see cds.h) between
+ * `start` and `end`. They are never freed, and have to be added before
+ * anything else is interned.
+ */
+extern void symbol_table_share(Symbol **symbols, uint32_t count, const void *start, const void *end);
+
+/* Returns NULL if the string was never interned, so nothing can be named by it */
+extern Symbol *symbol_find(const char *string);
+
+/* Only valid for strings that are already symbol bytes */
+static inline Symbol *symbol_of(const char *bytes)
+{
+    return (Symbol*) (bytes - offsetof(Symbol, bytes));
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,12 @@
+# Addresses and the dynamic loader's own error messages depend on the system
+stable() {
+    run "$@" | sed -e 's/0x[0-9a-f]*/ADDRESS/g' -e 's/\(cannot open compiled library [^:]*\):.*/\1/'
+}
+
+stable -XX:AOTLibrary=warm.so -Xaot:compile Warm
+stable -XX:AOTLibrary=warm.so Warm
+
+# Not a library, or one that predates a class change
+stable -XX:AOTLibrary=Warm.class Warm
+cp changed/Node.class Node.class
+stable -XX:AOTLibrary=warm.so Warm
@@ -0,0 +1,32 @@
+# Counted loops whose bounds checks can go, and one whose check must stay
+import sys
+sys.path.insert(0, sys.argv[1])
+from jasm import ClassFile
+
+OUT = 'Ljava/io/PrintStream;'
+
+cf = ClassFile('Loops')
+main = cf.method('main', '([Ljava/lang/String;)V')
+main.iconst_3().anewarray('java/lang/String').astore_1()
+
+# for (i = 0; i < array.length; i++) array[i] = "x" + i;
+main.iconst_0().istore_2()
+main.label('fill').iload_2().aload_1().arraylength().if_icmpge('filled')
+main.aload_1().iload_2().iload_2().invokedynamic('x\1', '(I)Ljava/lang/String;').aastore()
+main.iinc(2, 1).goto('fill').label('filled')
+
+# for (i = 0; i < array.length; i++) System.out.println(array[i]);
+main.iconst_0().istore_2()
+main.label('print').iload_2().aload_1().arraylength().if_icmpge('printed')
+main.getstatic('java/lang/System', 'out', OUT).aload_1().iload_2().aaload()
+main.invokevirtual('java/io/PrintStream', 'println', '(Ljava/lang/String;)V')
+main.iinc(2, 1).goto('print').label('printed')
+
+# The index is incremented before the access, so the last one is out of bounds
+main.iconst_0().istore_2()
+main.label('past').iload_2().aload_1().arraylength().if_icmpge('done')
+main.iinc(2, 1).getstatic('java/lang/System', 'out', OUT).aload_1().iload_2().aaload()
+main.invokevirtual('java/io/PrintStream', 'println', '(Ljava/lang/String;)V')
+main.goto('past').label('done')
+getattr(main, 'return')()
+cf.write()
@@ -0,0 +1 @@
+run Loops | sed -e 's/0x[0-9a-f]*/ADDRESS/g'
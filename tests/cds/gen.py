@@ -0,0 +1,7 @@
+# The Warm program, and a Node of a different size to make an archive stale
+import sys
+sys.path.insert(0, sys.argv[1])
+import warm
+
+warm.write()
+warm.node(extra_method=True).write('changed')
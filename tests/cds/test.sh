@@ -0,0 +1,20 @@
+# Addresses, the archive size and whether it had to be relocated depend on the build
+stable() {
+    run "$@" | sed -e 's/0x[0-9a-f]*/ADDRESS/g' -e 's/ ([0-9]* bytes)$//' -e 's/ (relocated)$//'
+}
+
+stable Warm
+stable -XX:SharedArchiveFile=warm.jsa -Xshare:dump Warm
+stable -XX:SharedArchiveFile=warm.jsa Warm
+
+# Not an archive, cut short, or with a class table that is not a power of two
+stable -XX:SharedArchiveFile=Warm.class Warm
+head -c 4096 warm.jsa > truncated.jsa
+stable -XX:SharedArchiveFile=truncated.jsa Warm
+cp warm.jsa malformed.jsa
+printf '\003' | dd of=malformed.jsa bs=1 seek=80 conv=notrunc 2> /dev/null
+stable -XX:SharedArchiveFile=malformed.jsa Warm
+
+# A class that changed since the dump is parsed again
+cp changed/Node.class Node.class
+stable -XX:SharedArchiveFile=warm.jsa Warm
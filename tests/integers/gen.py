@@ -0,0 +1,44 @@
+# Integer parsing, formatting and the valueOf cache
+import sys
+sys.path.insert(0, sys.argv[1])
+from jasm import ClassFile
+
+INTEGER = 'java/lang/Integer'
+VALUE_OF = (INTEGER, 'valueOf', '(I)Ljava/lang/Integer;')
+
+
+def boxes(main, value, label):
+    """Prints whether two valueOf calls with value return the same box"""
+    main.getstatic('java/lang/System', 'out', 'Ljava/io/PrintStream;')
+    main.ldc(value).invokestatic(*VALUE_OF).ldc(value).invokestatic(*VALUE_OF)
+    main.if_acmpeq(label).iconst_0().goto(label + 'print').label(label).iconst_1().label(label + 'print')
+    main.invokevirtual('java/io/PrintStream', 'println', '(Z)V')
+
+
+cf = ClassFile('Integers')
+main = cf.method('main', '([Ljava/lang/String;)V')
+for text in ('-2147483648', '2147483647', '+000000000000123', '-0'):
+    main.getstatic('java/lang/System', 'out', 'Ljava/io/PrintStream;')
+    main.ldc(text).invokestatic(INTEGER, 'parseInt', '(Ljava/lang/String;)I')
+    main.invokevirtual('java/io/PrintStream', 'println', '(I)V')
+main.getstatic('java/lang/System', 'out', 'Ljava/io/PrintStream;')
+main.ldc('-ff').bipush(16).invokestatic(INTEGER, 'parseInt', '(Ljava/lang/String;I)I')
+main.invokevirtual('java/io/PrintStream', 'println', '(I)V')
+for value in (0, -98765, -2147483648):
+    main.getstatic('java/lang/System', 'out', 'Ljava/io/PrintStream;')
+    main.ldc(value).invokestatic(INTEGER, 'toString', '(I)Ljava/lang/String;')
+    main.invokevirtual('java/io/PrintStream', 'println', '(Ljava/lang/String;)V')
+
+# -128 to 127 are always cached, more with -XX:AutoBoxCacheMax
+boxes(main, -128, 'low')
+boxes(main, 127, 'high')
+boxes(main, 1000, 'above')
+boxes(main, 65535, 'limit')
+getattr(main, 'return')()
+cf.write()
+
+overflow = ClassFile('Overflow')
+main = overflow.method('main', '([Ljava/lang/String;)V')
+main.ldc('2147483648').invokestatic(INTEGER, 'parseInt', '(Ljava/lang/String;)I').pop()
+getattr(main, 'return')()
+overflow.write()
@@ -0,0 +1,5 @@
+run Integers
+run -XX:AutoBoxCacheMax=65535 Integers
+run -XX:AutoBoxCacheMax=65536 Integers
+run -XX:AutoBoxCacheMax=1000x Integers
+run Overflow
@@ -0,0 +1,48 @@
+# invokeinterface on alternating receiver classes, a builtin, null and a
+# receiver without the method
+import sys
+sys.path.insert(0, sys.argv[1])
+from jasm import ClassFile
+
+OUT = 'Ljava/io/PrintStream;'
+
+for name in ('Circle', 'Square', 'Blank'):
+    shape = ClassFile(name)
+    init = shape.method('<init>', '()V', flags=0x1)
+    getattr(init.aload_0().invokespecial('java/lang/Object', '<init>', '()V'), 'return')()
+    if name != 'Blank':
+        shape.method('describe', '()Ljava/lang/String;', flags=0x1).ldc('a ' + name.lower()).areturn()
+    shape.write()
+
+cf = ClassFile('Shapes')
+main = cf.method('main', '([Ljava/lang/String;)V')
+main.iconst_5().anewarray('java/lang/Object').astore_1()
+for i, name in enumerate(('Circle', 'Square', 'Circle', 'Circle', 'Square')):
+    main.aload_1().bipush(i).new(name).dup().invokespecial(name, '<init>', '()V').aastore()
+
+# The call site sees a new receiver class on most iterations
+main.iconst_0().istore_2()
+main.label('loop').iload_2().aload_1().arraylength().if_icmpge('done')
+main.getstatic('java/lang/System', 'out', OUT).aload_1().iload_2().aaload()
+main.invokeinterface('Shape', 'describe', '()Ljava/lang/String;', 1)
+main.invokevirtual('java/io/PrintStream', 'println', '(Ljava/lang/String;)V')
+main.iinc(2, 1).goto('loop').label('done')
+
+main.new('java/util/ArrayList').dup().invokespecial('java/util/ArrayList', '<init>', '()V').astore_3()
+main.aload_3().ldc('element').invokeinterface('java/util/List', 'add', '(Ljava/lang/Object;)Z', 2).pop()
+main.getstatic('java/lang/System', 'out', OUT).aload_3().invokeinterface('java/util/List', 'size', '()I', 1)
+main.invokevirtual('java/io/PrintStream', 'println', '(I)V')
+
+main.getstatic('java/lang/System', 'out', OUT).aconst_null()
+main.invokeinterface('Shape', 'describe', '()Ljava/lang/String;', 1)
+main.invokevirtual('java/io/PrintStream', 'println', '(Ljava/lang/String;)V')
+getattr(main, 'return')()
+cf.write()
+
+unimplemented = ClassFile('Unimplemented')
+main = unimplemented.method('main', '([Ljava/lang/String;)V')
+main.getstatic('java/lang/System', 'out', OUT).new('Blank').dup().invokespecial('Blank', '<init>', '()V')
+main.invokeinterface('Shape', 'describe', '()Ljava/lang/String;', 1)
+main.invokevirtual('java/io/PrintStream', 'println', '(Ljava/lang/String;)V')
+getattr(main, 'return')()
+unimplemented.write()
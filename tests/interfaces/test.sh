@@ -0,0 +1,2 @@
+run Shapes | sed -e 's/0x[0-9a-f]*/ADDRESS/g'
+run Unimplemented
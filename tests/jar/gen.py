@@ -0,0 +1,30 @@
+# Stored and deflated JARs of classes that reference each other
+import sys
+import zipfile
+sys.path.insert(0, sys.argv[1])
+from jasm import ClassFile, hello
+
+COUNT = 200
+
+classes = [hello('Main', 'jar ok')]
+classes[0].methods[0].instructions[:0] = [('iconst_1', ()), ('ifne', ('skip',)), ('new', ('p/C0',)),
+                                         ('pop', ()), ('label', ('skip',))]
+for i in range(COUNT):
+    cf = ClassFile('p/C%d' % i, super='p/C%d' % (i // 3) if i % 7 == 3 else 'java/lang/Object')
+    method = cf.method('f', '()V').iconst_1().ifne('end')
+    for j in (2 * i + 1, 2 * i + 2, i * 7919 % COUNT):
+        if j < COUNT:
+            method.new('p/C%d' % j).pop()
+    getattr(method.label('end'), 'return')()
+    classes.append(cf)
+
+for name, compression in (('stored.jar', zipfile.ZIP_STORED), ('deflated.jar', zipfile.ZIP_DEFLATED)):
+    with zipfile.ZipFile(name, 'w', compression) as jar:
+        jar.writestr('META-INF/MANIFEST.MF', 'Manifest-Version: 1.0\r\n\r\n')
+        for cf in classes:
+            jar.writestr(cf.name + '.class', cf.bytes())
+
+with open('deflated.jar', 'rb') as file:
+    data = file.read()
+with open('truncated.jar', 'wb') as file:
+    file.write(data[:len(data) // 2])
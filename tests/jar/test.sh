@@ -0,0 +1,11 @@
+# Per-class progress lines interleave when classes load in parallel
+quiet() {
+    run "$@" | grep -v "^class processing started!$\|^some basic information...$\|^fields and methods...$\|^...and done!$"
+}
+
+quiet -cp stored.jar Main
+quiet -cp deflated.jar Main
+quiet -XX:LoaderThreads=4 -cp stored.jar Main
+quiet -XX:LoaderThreads=4 -cp deflated.jar Main
+quiet -cp truncated.jar Main
+quiet -cp deflated.jar p/Missing
@@ -0,0 +1,254 @@
+#
+# This file is part of MiniJVM (https://github.com/muhammad23012009/minijvm)
+# Copyright (c) 2025 Muhammad  <thevancedgamer@mentallysanemainliners.org>
+#
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, version 3.
+#
+# This program is distributed in the hope that it will be useful, but
+# WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+# General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program. If not, see <http://www.gnu.org/licenses/>.
+#
+
+"""Assembles the class files the tests run, so they need no Java compiler.
+
+Only the instructions and constants the tests use are supported. Branch
+targets are labels, and raw() appends bytes as they are, for code that is
+malformed on purpose.
+"""
+
+import os
+import struct
+
+OPS = {
+    'nop': 0, 'aconst_null': 1, 'iconst_m1': 2, 'iconst_0': 3, 'iconst_1': 4, 'iconst_2': 5, 'iconst_3': 6,
+    'iconst_4': 7, 'iconst_5': 8, 'lconst_0': 9, 'lconst_1': 10, 'bipush': 16, 'sipush': 17, 'ldc': 18,
+    'ldc2_w': 20, 'iload': 21, 'lload': 22, 'aload': 25, 'iload_0': 26, 'iload_1': 27, 'iload_2': 28,
+    'iload_3': 29, 'lload_0': 30, 'lload_1': 31, 'lload_2': 32, 'lload_3': 33, 'aload_0': 42, 'aload_1': 43,
+    'aload_2': 44, 'aload_3': 45, 'iaload': 46, 'aaload': 50, 'istore': 54, 'lstore': 55, 'astore': 58,
+    'istore_0': 59, 'istore_1': 60, 'istore_2': 61, 'istore_3': 62, 'lstore_0': 63, 'lstore_1': 64,
+    'lstore_2': 65, 'lstore_3': 66, 'astore_0': 75, 'astore_1': 76, 'astore_2': 77, 'astore_3': 78,
+    'iastore': 79, 'aastore': 83, 'pop': 87, 'dup': 89, 'iadd': 96, 'ladd': 97, 'isub': 100, 'imul': 104,
+    'iinc': 132, 'i2l': 133, 'i2c': 146, 'ifeq': 153, 'ifne': 154, 'iflt': 155, 'ifge': 156, 'ifgt': 157,
+    'ifle': 158, 'if_icmpeq': 159, 'if_icmpne': 160, 'if_icmplt': 161, 'if_icmpge': 162, 'if_icmpgt': 163,
+    'if_icmple': 164, 'if_acmpeq': 165, 'if_acmpne': 166, 'goto': 167, 'ireturn': 172, 'lreturn': 173,
+    'areturn': 176, 'return': 177, 'getstatic': 178, 'putstatic': 179, 'getfield': 180, 'putfield': 181,
+    'invokevirtual': 182, 'invokespecial': 183, 'invokestatic': 184, 'invokeinterface': 185,
+    'invokedynamic': 186, 'new': 187, 'anewarray': 189, 'arraylength': 190, 'checkcast': 192,
+    'ifnull': 198, 'ifnonnull': 199,
+}
+BRANCHES = {'ifeq', 'ifne', 'iflt', 'ifge', 'ifgt', 'ifle', 'if_icmpeq', 'if_icmpne', 'if_icmplt',
+            'if_icmpge', 'if_icmpgt', 'if_icmple', 'if_acmpeq', 'if_acmpne', 'goto', 'ifnull', 'ifnonnull'}
+LOCALS = {'iload', 'lload', 'aload', 'istore', 'lstore', 'astore'}
+FIELDS = {'getstatic', 'putstatic', 'getfield', 'putfield'}
+METHODS = {'invokevirtual', 'invokespecial', 'invokestatic'}
+CLASSES = {'new', 'anewarray', 'checkcast'}
+
+CONCAT_BOOTSTRAP = ('java/lang/invoke/StringConcatFactory', 'makeConcatWithConstants',
+                    '(Ljava/lang/invoke/MethodHandles$Lookup;Ljava/lang/String;Ljava/lang/invoke/MethodType;'
+                    'Ljava/lang/String;[Ljava/lang/Object;)Ljava/lang/invoke/CallSite;')
+
+
+class Pool:
+    def __init__(self):
+        self.entries = [None]
+        self.indexes = {}
+
+    def add(self, key, data, wide=False):
+        if key not in self.indexes:
+            self.indexes[key] = len(self.entries)
+            self.entries.append(data)
+            # Longs and doubles take two slots
+            if wide:
+                self.entries.append(None)
+        return self.indexes[key]
+
+    def utf8(self, string):
+        # Modified UTF-8: NUL takes two bytes, supplementary chars are surrogate pairs
+        units = string.encode('utf-16-be', 'surrogatepass')
+        data = b''
+        for i in range(0, len(units), 2):
+            unit = int.from_bytes(units[i:i + 2], 'big')
+            data += chr(unit).encode('utf-8', 'surrogatepass') if unit else b'\xc0\x80'
+        return self.add(('utf8', string), struct.pack('>BH', 1, len(data)) + data)
+
+    def cls(self, name):
+        return self.add(('class', name), struct.pack('>BH', 7, self.utf8(name)))
+
+    def string(self, string):
+        return self.add(('string', string), struct.pack('>BH', 8, self.utf8(string)))
+
+    def int(self, value):
+        return self.add(('int', value), struct.pack('>Bi', 3, value))
+
+    def long(self, value):
+        return self.add(('long', value), struct.pack('>Bq', 5, value), wide=True)
+
+    def name_and_type(self, name, descriptor):
+        return self.add(('nat', name, descriptor),
+                        struct.pack('>BHH', 12, self.utf8(name), self.utf8(descriptor)))
+
+    def ref(self, tag, cls, name, descriptor):
+        return self.add(('ref', tag, cls, name, descriptor),
+                        struct.pack('>BHH', tag, self.cls(cls), self.name_and_type(name, descriptor)))
+
+    def method_handle(self, kind, ref):
+        return self.add(('handle', kind, ref), struct.pack('>BBH', 15, kind, ref))
+
+    def invoke_dynamic(self, bootstrap, name, descriptor):
+        return self.add(('indy', bootstrap, name, descriptor),
+                        struct.pack('>BHH', 18, bootstrap, self.name_and_type(name, descriptor)))
+
+    def bytes(self):
+        return struct.pack('>H', len(self.entries)) + b''.join(e for e in self.entries[1:] if e is not None)
+
+
+class Code:
+    def __init__(self, cf, name, descriptor, flags, max_stack, max_locals):
+        self.cf, self.name, self.descriptor, self.flags = cf, name, descriptor, flags
+        self.max_stack, self.max_locals = max_stack, max_locals
+        self.instructions = []
+
+    def label(self, label):
+        self.instructions.append(('label', (label,)))
+        return self
+
+    def __getattr__(self, op):
+        def emit(*args):
+            self.instructions.append((op, args))
+            return self
+        return emit
+
+    @staticmethod
+    def size(op, args):
+        if op == 'label':
+            return 0
+        if op == 'raw':
+            return len(args[0])
+        if op in ('invokeinterface', 'invokedynamic'):
+            return 5
+        if op in BRANCHES or op in FIELDS or op in METHODS or op in CLASSES or op in ('sipush', 'iinc', 'ldc2_w'):
+            return 3
+        if op in LOCALS or op in ('bipush', 'ldc'):
+            return 2
+        return 1
+
+    def assemble(self):
+        pool = self.cf.pool
+        labels, pc = {}, 0
+        for op, args in self.instructions:
+            if op == 'label':
+                labels[args[0]] = pc
+            pc += self.size(op, args)
+
+        out, pc = b'', 0
+        for op, args in self.instructions:
+            if op == 'label':
+                continue
+            if op == 'raw':
+                code = args[0]
+            else:
+                code = bytes([OPS[op]])
+                if op in BRANCHES:
+                    code += struct.pack('>h', labels[args[0]] - pc)
+                elif op == 'bipush':
+                    code += struct.pack('>b', args[0])
+                elif op == 'sipush':
+                    code += struct.pack('>h', args[0])
+                elif op in LOCALS:
+                    code += bytes([args[0]])
+                elif op == 'iinc':
+                    code += struct.pack('>Bb', *args)
+                elif op == 'ldc':
+                    value = args[0]
+                    code += bytes([pool.int(value) if isinstance(value, int) else pool.string(value)])
+                elif op == 'ldc2_w':
+                    code += struct.pack('>H', pool.long(args[0]))
+                elif op in FIELDS:
+                    code += struct.pack('>H', pool.ref(9, *args))
+                elif op in METHODS:
+                    code += struct.pack('>H', pool.ref(10, *args))
+                elif op == 'invokeinterface':
+                    cls, name, descriptor, count = args
+                    code += struct.pack('>HBB', pool.ref(11, cls, name, descriptor), count, 0)
+                elif op == 'invokedynamic':
+                    code += struct.pack('>HH', self.cf.concat(*args), 0)
+                elif op in CLASSES:
+                    code += struct.pack('>H', pool.cls(args[0]))
+            out += code
+            pc += len(code)
+        return out
+
+
+class ClassFile:
+    def __init__(self, name, super='java/lang/Object'):
+        self.name, self.super = name, super
+        self.pool = Pool()
+        self.methods, self.fields, self.bootstraps = [], [], []
+        # Extra class attributes as (name, payload, declared length or None)
+        self.attributes = []
+
+    def method(self, name, descriptor, flags=0x9, max_stack=8, max_locals=8):
+        code = Code(self, name, descriptor, flags, max_stack, max_locals)
+        self.methods.append(code)
+        return code
+
+    def field(self, name, descriptor, flags=0):
+        self.fields.append((flags, name, descriptor))
+
+    def concat(self, recipe, descriptor, *constants):
+        """A StringConcatFactory call site for invokedynamic"""
+        handle = self.pool.method_handle(6, self.pool.ref(10, *CONCAT_BOOTSTRAP))
+        args = [self.pool.string(recipe)] + [self.pool.string(c) for c in constants]
+        self.bootstraps.append((handle, args))
+        return self.pool.invoke_dynamic(len(self.bootstraps) - 1, 'makeConcatWithConstants', descriptor)
+
+    def bytes(self):
+        pool = self.pool
+        self.bootstraps = []
+        body = struct.pack('>HHHH', 0x21, pool.cls(self.name), pool.cls(self.super), 0)
+
+        body += struct.pack('>H', len(self.fields))
+        for flags, name, descriptor in self.fields:
+            body += struct.pack('>HHHH', flags, pool.utf8(name), pool.utf8(descriptor), 0)
+
+        body += struct.pack('>H', len(self.methods))
+        for method in self.methods:
+            code = method.assemble()
+            attribute = struct.pack('>HHI', method.max_stack, method.max_locals, len(code)) + code
+            attribute += struct.pack('>HH', 0, 0)
+            body += struct.pack('>HHHH', method.flags, pool.utf8(method.name), pool.utf8(method.descriptor), 1)
+            body += struct.pack('>HI', pool.utf8('Code'), len(attribute)) + attribute
+
+        attributes = []
+        for name, payload, length in self.attributes:
+            attributes.append(struct.pack('>HI', pool.utf8(name), len(payload) if length is None else length) + payload)
+        if self.bootstraps:
+            payload = struct.pack('>H', len(self.bootstraps))
+            for handle, args in self.bootstraps:
+                payload += struct.pack('>HH', handle, len(args)) + b''.join(struct.pack('>H', a) for a in args)
+            attributes.append(struct.pack('>HI', pool.utf8('BootstrapMethods'), len(payload)) + payload)
+        body += struct.pack('>H', len(attributes)) + b''.join(attributes)
+
+        return struct.pack('>IHH', 0xCAFEBABE, 0, 61) + pool.bytes() + body
+
+    def write(self, directory='.'):
+        path = os.path.join(directory, self.name + '.class')
+        os.makedirs(os.path.dirname(path) or '.', exist_ok=True)
+        with open(path, 'wb') as file:
+            file.write(self.bytes())
+
+
+def hello(name, message=None):
+    """A class whose main prints message, or its own name"""
+    cf = ClassFile(name)
+    main = cf.method('main', '([Ljava/lang/String;)V')
+    main.getstatic('java/lang/System', 'out', 'Ljava/io/PrintStream;').ldc(message or name)
+    main.invokevirtual('java/io/PrintStream', 'println', '(Ljava/lang/String;)V')
+    getattr(main, 'return')()
+    return cf
@@ -0,0 +1,19 @@
+# Classes in a directory that reference each other, some through a superclass
+import sys
+sys.path.insert(0, sys.argv[1])
+from jasm import ClassFile, hello
+
+COUNT = 60
+
+main = hello('Main', 'loader ok')
+main.methods[0].instructions[:0] = [('iconst_1', ()), ('ifne', ('skip',)), ('new', ('q/C0',)),
+                                    ('pop', ()), ('label', ('skip',))]
+main.write()
+for i in range(COUNT):
+    cf = ClassFile('q/C%d' % i, super='q/C%d' % (i // 2) if i % 5 == 4 else 'java/lang/Object')
+    method = cf.method('f', '()V').iconst_1().ifne('end')
+    for j in (2 * i + 1, 2 * i + 2):
+        if j < COUNT:
+            method.new('q/C%d' % j).pop()
+    getattr(method.label('end'), 'return')()
+    cf.write()
@@ -0,0 +1,11 @@
+# Per-class progress lines interleave when classes load in parallel
+quiet() {
+    run "$@" | grep -v "^class processing started!$\|^some basic information...$\|^fields and methods...$\|^...and done!$"
+}
+
+quiet -XX:LoaderThreads=1 Main
+quiet -XX:LoaderThreads=8 Main
+quiet -XX:LoaderThreads=0 Main
+quiet -XX:LoaderThreads=257 Main
+quiet -XX:LoaderThreads=4x Main
+quiet -XX:LoaderThreads= Main
@@ -0,0 +1,54 @@
+# Class files the reader and linker must accept or reject cleanly
+import struct
+import sys
+sys.path.insert(0, sys.argv[1])
+from jasm import ClassFile, CONCAT_BOOTSTRAP, hello
+
+
+def code(name, data):
+    cf = ClassFile(name)
+    cf.method('main', '([Ljava/lang/String;)V').raw(data)
+    cf.write()
+
+
+def bootstrap(name, handle, args):
+    cf = hello(name)
+    payload = struct.pack('>HHH', 1, handle(cf.pool), len(args)) + b''.join(struct.pack('>H', a) for a in args)
+    cf.attributes.append(('BootstrapMethods', payload, None))
+    cf.write()
+
+
+hello('Hello').write()
+with open('Truncated.class', 'wb') as file:
+    file.write(hello('Truncated').bytes()[:40])
+
+# An InnerClasses entry is skipped, and the attribute after it still parses
+inner = hello('Inner')
+inner.attributes = [('InnerClasses', struct.pack('>HHHHH', 1, 0, 0, 0, 0), None),
+                    ('SourceFile', struct.pack('>H', 1), None)]
+inner.write()
+short = hello('Short')
+short.attributes = [('ConstantValue', struct.pack('>HH', 1, 0), None)]
+short.write()
+
+concat = ClassFile('Concat')
+main = concat.method('main', '([Ljava/lang/String;)V')
+main.getstatic('java/lang/System', 'out', 'Ljava/io/PrintStream;').bipush(42)
+main.invokedynamic('answer \1', '(I)Ljava/lang/String;')
+main.invokevirtual('java/io/PrintStream', 'println', '(Ljava/lang/String;)V')
+getattr(main, 'return')()
+concat.write()
+bootstrap('BootstrapRef', lambda pool: 0x7000, [])
+bootstrap('BootstrapArg', lambda pool: pool.method_handle(6, pool.ref(10, *CONCAT_BOOTSTRAP)), [0x7000])
+
+code('LdcPast', bytes([0x12, 0xF0, 0x57, 0xB1]))
+code('Ldc2Past', bytes([0x14, 0xFF, 0xF0, 0x58, 0xB1]))
+code('GetstaticUtf8', bytes([0xB2, 0x00, 0x01, 0x57, 0xB1]))
+code('CutShort', bytes([0xB8, 0x00]))
+
+bad_method = hello('BadMethod')
+bad_method.method('m', '(Lfoo')
+bad_method.write()
+bad_ref = ClassFile('BadRef')
+getattr(bad_ref.method('main', '([Ljava/lang/String;)V').invokestatic('BadRef', 'x', '(Lfoo'), 'return')()
+bad_ref.write()
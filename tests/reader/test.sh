@@ -0,0 +1,13 @@
+run Hello
+run Truncated
+run Inner
+run Short
+run Concat
+run BootstrapRef
+run BootstrapArg
+run LdcPast
+run Ldc2Past
+run GetstaticUtf8
+run CutShort
+run BadMethod
+run BadRef
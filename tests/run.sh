@@ -0,0 +1,42 @@
+#!/bin/sh
+#
+# Runs every test suite against a built miniJVM:
+#
+#   tests/run.sh path/to/minijvm [suite...]
+#
+# Each suite directory has a gen.py that writes its class files, a test.sh
+# that runs them, and the expected.txt output. The fixtures are generated
+# into a scratch directory, so the tests only need python3.
+
+if [ $# -lt 1 ]; then
+    echo "Usage: $0 <minijvm binary> [suite...]" >&2
+    exit 2
+fi
+
+MINIJVM=$(realpath "$1")
+shift
+TESTS=$(dirname "$(realpath "$0")")
+SUITES=${*:-$(cd "$TESTS" && ls -d */ | tr -d /)}
+
+# Runs miniJVM with the given arguments and records its output and exit status
+run() {
+    echo "\$ minijvm $*"
+    "$MINIJVM" "$@" 2>&1
+    echo "exit $?"
+}
+
+failed=0
+for suite in $SUITES; do
+    scratch=$(mktemp -d)
+    if (cd "$scratch" && python3 -B "$TESTS/$suite/gen.py" "$TESTS" &&
+        . "$TESTS/$suite/test.sh") > "$scratch/output.txt" 2>&1 &&
+        diff -u "$TESTS/$suite/expected.txt" "$scratch/output.txt"; then
+        echo "PASS $suite"
+    else
+        echo "FAIL $suite"
+        failed=1
+    fi
+    rm -rf "$scratch"
+done
+
+exit $failed
@@ -0,0 +1,43 @@
+# The Warm program, a map keyed by identity hash codes, and a Node of a
+# different size to make a snapshot stale
+import sys
+sys.path.insert(0, sys.argv[1])
+from jasm import ClassFile
+import warm
+
+warm.write()
+warm.node(extra_method=True).write('changed')
+
+key = ClassFile('Key')
+init = key.method('<init>', '()V', flags=0x1)
+getattr(init.aload_0().invokespecial('java/lang/Object', '<init>', '()V'), 'return')()
+key.write()
+
+# Keys without hashCode hash by identity, which a restore must preserve
+identity = ClassFile('Identity')
+identity.field('map', 'Ljava/util/HashMap;', 0x8)
+identity.field('keys', '[LKey;', 0x8)
+init = identity.method('<clinit>', '()V')
+init.new('java/util/HashMap').dup().invokespecial('java/util/HashMap', '<init>', '()V')
+init.putstatic('Identity', 'map', 'Ljava/util/HashMap;')
+init.bipush(40).anewarray('Key').putstatic('Identity', 'keys', '[LKey;')
+init.iconst_0().istore_0()
+init.label('loop').iload_0().bipush(40).if_icmpge('done')
+init.getstatic('Identity', 'keys', '[LKey;').iload_0()
+init.new('Key').dup().invokespecial('Key', '<init>', '()V').aastore()
+init.getstatic('Identity', 'map', 'Ljava/util/HashMap;').getstatic('Identity', 'keys', '[LKey;').iload_0().aaload()
+init.iload_0().invokestatic(*warm.INTEGER_VALUE_OF)
+init.invokevirtual('java/util/HashMap', 'put', '(Ljava/lang/Object;Ljava/lang/Object;)Ljava/lang/Object;').pop()
+init.iinc(0, 1).goto('loop').label('done')
+getattr(init, 'return')()
+
+main = identity.method('main', '([Ljava/lang/String;)V')
+main.iconst_0().istore_0()
+main.label('loop').iload_0().bipush(40).if_icmpge('done')
+main.getstatic('java/lang/System', 'out', 'Ljava/io/PrintStream;')
+main.getstatic('Identity', 'map', 'Ljava/util/HashMap;').getstatic('Identity', 'keys', '[LKey;').iload_0().aaload()
+main.invokevirtual('java/util/HashMap', 'get', '(Ljava/lang/Object;)Ljava/lang/Object;')
+main.invokevirtual('java/io/PrintStream', 'println', '(Ljava/lang/Object;)V')
+main.iinc(0, 1).goto('loop').label('done')
+getattr(main, 'return')()
+identity.write()
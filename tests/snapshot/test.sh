@@ -0,0 +1,20 @@
+# Addresses and whether the archive had to be relocated depend on the build
+stable() {
+    run "$@" | sed -e 's/0x[0-9a-f]*/ADDRESS/g' -e 's/ ([0-9]* bytes)$//' -e 's/ (relocated)$//'
+}
+
+stable -XX:Checkpoint=warm.snap -XX:CheckpointAfter=warmUp Warm
+stable -XX:Restore=warm.snap Warm
+stable -XX:SharedArchiveFile=warm.jsa -Xshare:dump Warm
+stable -XX:SharedArchiveFile=warm.jsa -XX:Restore=warm.snap Warm
+
+stable -XX:Checkpoint=identity.snap Identity
+stable -XX:Restore=identity.snap Identity
+
+# Snapshots that do not fit are ignored, unless they are damaged past the header
+stable -XX:Restore=Warm.class Warm
+stable -XX:Restore=warm.snap Identity
+head -c 1024 warm.snap > truncated.snap
+stable -XX:Restore=truncated.snap Warm
+cp changed/Node.class Node.class
+stable -XX:Restore=warm.snap Warm
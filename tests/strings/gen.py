@@ -0,0 +1,51 @@
+# String builtins on Latin-1 and UTF-16 strings
+import sys
+sys.path.insert(0, sys.argv[1])
+from jasm import ClassFile
+
+STRING = 'java/lang/String'
+LONG = 'the quick brown fox jumps over the lazy dog, again and again and again!'
+WIDE = 'héllo wörld €uro café \U0001F600 end'
+
+cf = ClassFile('Strings')
+main = cf.method('main', '([Ljava/lang/String;)V')
+
+
+def check(push, method, descriptor):
+    main.getstatic('java/lang/System', 'out', 'Ljava/io/PrintStream;')
+    push()
+    main.invokevirtual(STRING, method, descriptor)
+    result = descriptor[descriptor.index(')') + 1:]
+    main.invokevirtual('java/io/PrintStream', 'println', '(%s)V' % ('I' if result in 'CZ' else result))
+
+
+main.ldc(LONG).astore_1()
+main.ldc(WIDE).astore_2()
+check(lambda: main.aload_1(), 'length', '()I')
+check(lambda: main.aload_1().iconst_4(), 'charAt', '(I)C')
+check(lambda: main.aload_1(), 'hashCode', '()I')
+check(lambda: main.aload_1().ldc('lazy'), 'indexOf', '(Ljava/lang/String;)I')
+check(lambda: main.aload_1().ldc(''), 'indexOf', '(Ljava/lang/String;)I')
+check(lambda: main.aload_1().ldc('lazy cat'), 'indexOf', '(Ljava/lang/String;)I')
+check(lambda: main.aload_1().bipush(ord('z')), 'indexOf', '(I)I')
+check(lambda: main.aload_1().bipush(ord('a')).bipush(50), 'indexOf', '(II)I')
+check(lambda: main.aload_1().bipush(ord('t')).bipush(-5), 'indexOf', '(II)I')
+check(lambda: main.aload_1().bipush(4).bipush(9), 'substring', '(II)Ljava/lang/String;')
+check(lambda: main.aload_1().bipush(60), 'substring', '(I)Ljava/lang/String;')
+check(lambda: main.ldc('apple').ldc('apricot'), 'compareTo', '(Ljava/lang/String;)I')
+check(lambda: main.aload_1().ldc(LONG), 'equals', '(Ljava/lang/Object;)Z')
+
+# A UTF-16 string, with a char that takes a surrogate pair
+main.getstatic('java/lang/System', 'out', 'Ljava/io/PrintStream;').aload_2()
+main.invokevirtual('java/io/PrintStream', 'println', '(Ljava/lang/String;)V')
+check(lambda: main.aload_2(), 'length', '()I')
+check(lambda: main.aload_2(), 'hashCode', '()I')
+check(lambda: main.aload_2().sipush(0x20ac), 'indexOf', '(I)I')
+check(lambda: main.aload_2().ldc('café'), 'indexOf', '(Ljava/lang/String;)I')
+check(lambda: main.aload_1().ldc('café'), 'indexOf', '(Ljava/lang/String;)I')
+check(lambda: main.aload_2().ldc('end'), 'indexOf', '(Ljava/lang/String;)I')
+check(lambda: main.aload_2().iconst_0().bipush(11), 'substring', '(II)Ljava/lang/String;')
+check(lambda: main.aload_2().iconst_0().bipush(11).invokevirtual(STRING, 'substring', '(II)Ljava/lang/String;')
+      .ldc('héllo wörld'), 'equals', '(Ljava/lang/Object;)Z')
+getattr(main, 'return')()
+cf.write()
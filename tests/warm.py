@@ -0,0 +1,125 @@
+# A program whose static initializer builds up state worth archiving:
+# a HashMap, a list, a builder, boxed and interned values and a cycle of
+# Nodes. warmUp changes some of it, so a restored run shows whether the
+# state after it was kept.
+from jasm import ClassFile
+
+OBJECT = 'Ljava/lang/Object;'
+STRING = 'Ljava/lang/String;'
+BUILDER = 'Ljava/lang/StringBuilder;'
+MAP = ('java/util/HashMap', 'Ljava/util/HashMap;')
+LIST = ('java/util/ArrayList', 'Ljava/util/ArrayList;')
+OUT = ('java/io/PrintStream', 'Ljava/io/PrintStream;')
+INTEGER_VALUE_OF = ('java/lang/Integer', 'valueOf', '(I)Ljava/lang/Integer;')
+
+
+def node(extra_method=False):
+    cf = ClassFile('Node')
+    cf.field('id', 'I')
+    cf.field('name', STRING)
+    cf.field('next', 'LNode;')
+    init = cf.method('<init>', '(ILjava/lang/String;)V', flags=0x1)
+    init.aload_0().invokespecial('java/lang/Object', '<init>', '()V')
+    init.aload_0().iload_1().putfield('Node', 'id', 'I')
+    init.aload_0().aload_2().putfield('Node', 'name', STRING)
+    getattr(init, 'return')()
+    if extra_method:
+        getattr(cf.method('unused', '()V', flags=0x1), 'return')()
+    return cf
+
+
+def warm():
+    cf = ClassFile('Warm')
+    for name, descriptor in (('map', MAP[1]), ('list', LIST[1]), ('builder', BUILDER), ('greeting', STRING),
+                             ('count', 'I'), ('big', 'J'), ('array', '[Ljava/lang/String;'), ('node', 'LNode;'),
+                             ('box', 'Ljava/lang/Integer;')):
+        cf.field(name, descriptor, 0x8)
+
+    init = cf.method('<clinit>', '()V')
+    init.new(MAP[0]).dup().invokespecial(MAP[0], '<init>', '()V').putstatic('Warm', 'map', MAP[1])
+    init.iconst_0().istore_0()
+    init.label('loop').iload_0().bipush(50).if_icmpge('done')
+    init.getstatic('Warm', 'map', MAP[1])
+    init.ldc('k').iload_0().invokedynamic('\1\1', '(Ljava/lang/String;I)Ljava/lang/String;')
+    init.ldc('v').iload_0().invokedynamic('\1\1', '(Ljava/lang/String;I)Ljava/lang/String;')
+    init.invokevirtual(MAP[0], 'put', '(%s%s)%s' % (OBJECT, OBJECT, OBJECT)).pop()
+    init.iinc(0, 1).goto('loop').label('done')
+    init.getstatic('Warm', 'map', MAP[1]).iconst_5().invokestatic(*INTEGER_VALUE_OF)
+    init.sipush(1000).invokestatic(*INTEGER_VALUE_OF)
+    init.invokevirtual(MAP[0], 'put', '(%s%s)%s' % (OBJECT, OBJECT, OBJECT)).pop()
+    init.new(LIST[0]).dup().invokespecial(LIST[0], '<init>', '()V').putstatic('Warm', 'list', LIST[1])
+    init.getstatic('Warm', 'list', LIST[1]).ldc('first').invokevirtual(LIST[0], 'add', '(%s)Z' % OBJECT).pop()
+    init.getstatic('Warm', 'list', LIST[1]).getstatic('Warm', 'map', MAP[1])
+    init.invokevirtual(LIST[0], 'add', '(%s)Z' % OBJECT).pop()
+    init.new('java/lang/StringBuilder').dup().invokespecial('java/lang/StringBuilder', '<init>', '()V')
+    init.putstatic('Warm', 'builder', BUILDER)
+    init.getstatic('Warm', 'builder', BUILDER).ldc('warm')
+    init.invokevirtual('java/lang/StringBuilder', 'append', '(%s)%s' % (STRING, BUILDER)).pop()
+    init.ldc('hello').putstatic('Warm', 'greeting', STRING)
+    init.bipush(7).putstatic('Warm', 'count', 'I')
+    init.ldc2_w(5000000000).putstatic('Warm', 'big', 'J')
+    init.iconst_3().anewarray('java/lang/String').putstatic('Warm', 'array', '[Ljava/lang/String;')
+    init.getstatic('Warm', 'array', '[Ljava/lang/String;').iconst_1().ldc('element').aastore()
+    init.new('Node').dup().iconst_1().ldc('one').invokespecial('Node', '<init>', '(ILjava/lang/String;)V')
+    init.putstatic('Warm', 'node', 'LNode;')
+    init.getstatic('Warm', 'node', 'LNode;')
+    init.new('Node').dup().iconst_2().ldc('two').invokespecial('Node', '<init>', '(ILjava/lang/String;)V')
+    init.putfield('Node', 'next', 'LNode;')
+    init.getstatic('Warm', 'node', 'LNode;').getfield('Node', 'next', 'LNode;')
+    init.getstatic('Warm', 'node', 'LNode;').putfield('Node', 'next', 'LNode;')
+    init.bipush(100).invokestatic(*INTEGER_VALUE_OF).putstatic('Warm', 'box', 'Ljava/lang/Integer;')
+    getattr(init, 'return')()
+
+    warm_up = cf.method('warmUp', '()V')
+    warm_up.getstatic('Warm', 'count', 'I').bipush(100).iadd().putstatic('Warm', 'count', 'I')
+    warm_up.getstatic('Warm', 'builder', BUILDER).ldc('ed')
+    warm_up.invokevirtual('java/lang/StringBuilder', 'append', '(%s)%s' % (STRING, BUILDER)).pop()
+    getattr(warm_up, 'return')()
+
+    main = cf.method('main', '([Ljava/lang/String;)V')
+    main.getstatic('java/lang/System', 'out', OUT[1]).astore_1()
+
+    def println(descriptor):
+        main.invokevirtual(OUT[0], 'println', '(%s)V' % descriptor)
+
+    main.aload_1().getstatic('Warm', 'map', MAP[1]).ldc('k7')
+    main.invokevirtual(MAP[0], 'get', '(%s)%s' % (OBJECT, OBJECT))
+    println(OBJECT)
+    main.aload_1().getstatic('Warm', 'map', MAP[1]).iconst_5().invokestatic(*INTEGER_VALUE_OF)
+    main.invokevirtual(MAP[0], 'get', '(%s)%s' % (OBJECT, OBJECT))
+    println(OBJECT)
+    main.aload_1().getstatic('Warm', 'map', MAP[1]).invokevirtual(MAP[0], 'size', '()I')
+    println('I')
+    main.aload_1().getstatic('Warm', 'list', LIST[1]).invokevirtual(LIST[0], 'size', '()I')
+    println('I')
+    main.aload_1().getstatic('Warm', 'list', LIST[1]).iconst_0().invokevirtual(LIST[0], 'get', '(I)' + OBJECT)
+    println(OBJECT)
+    main.getstatic('Warm', 'builder', BUILDER).ldc('!')
+    main.invokevirtual('java/lang/StringBuilder', 'append', '(%s)%s' % (STRING, BUILDER)).pop()
+    main.aload_1().getstatic('Warm', 'builder', BUILDER)
+    main.invokevirtual('java/lang/StringBuilder', 'toString', '()' + STRING)
+    println(STRING)
+    # Interned strings stay identical
+    main.aload_1().getstatic('Warm', 'greeting', STRING).ldc('hello').if_acmpne('different')
+    main.iconst_1().goto('same').label('different').iconst_0().label('same')
+    println('Z')
+    main.aload_1().getstatic('Warm', 'count', 'I')
+    println('I')
+    main.aload_1().getstatic('Warm', 'big', 'J')
+    println('J')
+    main.aload_1().getstatic('Warm', 'array', '[Ljava/lang/String;').iconst_1().aaload()
+    println(STRING)
+    main.aload_1().getstatic('Warm', 'node', 'LNode;').getfield('Node', 'next', 'LNode;')
+    main.getfield('Node', 'next', 'LNode;').getfield('Node', 'name', STRING)
+    println(STRING)
+    # So do cached boxes
+    main.aload_1().getstatic('Warm', 'box', 'Ljava/lang/Integer;').bipush(100).invokestatic(*INTEGER_VALUE_OF)
+    main.if_acmpne('other').iconst_1().goto('cached').label('other').iconst_0().label('cached')
+    println('Z')
+    getattr(main, 'return')()
+    return cf
+
+
+def write():
+    node().write()
+    warm().write()
@@ -1,6 +1,8 @@
 #ifndef VARIANT_H
 #define VARIANT_H
 
+#include <stdint.h>
+
 typedef struct Object Object;
 typedef struct Variant Variant;
 
@@ -9,6 +11,8 @@ typedef enum {
     VARIANT_TYPE_OBJECT,
     VARIANT_TYPE_REF,
     VARIANT_TYPE_INT,
+    /* A single Variant holds the whole long, unlike the two JVM slots */
+    VARIANT_TYPE_LONG,
 } VariantType;
 
 typedef struct Variant {
@@ -17,6 +21,7 @@ typedef struct Variant {
         Object *object;
         void *ref;
         int int_val;
+        int64_t long_val;
     } data;
 } Variant;
 